@@ -0,0 +1,279 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ArenaRotation.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/LevelStreamingKismet.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "Misc/PackageName.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Arena Switch Worst Frame (ms)"), STAT_ArenaSwitchWorstFrame, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Arena Switch Stall (ms)"), STAT_ArenaSwitchStall, STATGROUP_LocalMultiplayerDemo);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GNextArenaCommand(
+	TEXT("LocalMultiplayer.NextArena"),
+	TEXT("Switches to the next arena in the rotation as soon as it has loaded"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		class UArenaRotation* Rotation = UArenaRotation::Get(World);
+
+		if (Rotation != nullptr && Rotation->IsActive())
+			Rotation->RequestSwitch();
+		else
+			Ar.Logf(TEXT("No arena rotation on this world (it only runs on the server, with ArenaLevels set)"));
+	}));
+
+UArenaRotation::UArenaRotation()
+{
+	ArenaPlayTime = 300.f;
+	CurrentArena = INDEX_NONE;
+	NextArena = INDEX_NONE;
+	PreviousArena = INDEX_NONE;
+	TimeLeft = 0.f;
+	bSwitchRequested = false;
+	bSwitching = false;
+	bArenaShown = false;
+	bWaitingForLoad = false;
+	AverageFrameMs = 0.f;
+	WorstSwitchFrameMs = 0.f;
+	SwitchFrames = 0;
+	SwitchStartTime = 0.0;
+}
+
+UArenaRotation* UArenaRotation::Get(const UObject* WorldContextObject)
+{
+	class UWorld* const world = WorldContextObject ? WorldContextObject->GetWorld() : NULL;
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	return GameMode ? GameMode->ArenaRotation : NULL;
+}
+
+#pragma region Streaming
+ULevelStreaming* UArenaRotation::GetArenaStreaming(int32 Arena)
+{
+	class UWorld* const world = GetWorld();
+
+	if (world == nullptr || !ArenaLevels.IsValidIndex(Arena))
+		return NULL;
+
+	ArenaStreaming.SetNum(ArenaLevels.Num());
+
+	if (ArenaStreaming[Arena] != nullptr)
+		return ArenaStreaming[Arena];
+
+	// Sub-levels listed in the persistent map
+	const FName PackageName(*ArenaLevels[Arena]);
+	class ULevelStreaming* Streaming = UGameplayStatics::GetStreamingLevel(world, PackageName);
+
+	// Otherwise add one, the same way a level instance is loaded from Blueprint
+	if (Streaming == nullptr)
+	{
+		FString PackageToLoad = ArenaLevels[Arena];
+
+		if (world->IsPlayInEditor())
+			PackageToLoad = UWorld::ConvertToPIEPackageName(PackageToLoad, world->GetOutermost()->PIEInstanceID);
+
+		class ULevelStreamingKismet* AddedStreaming = NewObject<ULevelStreamingKismet>(world, NAME_None, RF_Transient);
+		AddedStreaming->SetWorldAssetByPackageName(FName(*PackageToLoad));
+		AddedStreaming->PackageNameToLoad = PackageName;
+		AddedStreaming->bShouldBeLoaded = false;
+		AddedStreaming->bShouldBeVisible = false;
+		AddedStreaming->bShouldBlockOnLoad = false;
+		world->StreamingLevels.Add(AddedStreaming);
+
+		Streaming = AddedStreaming;
+	}
+
+	ArenaStreaming[Arena] = Streaming;
+	return Streaming;
+}
+
+// Flags are read by the world's streaming update at the end of the frame. Remote players have their own copy of
+// each streaming level, so they are told too. Local players share ours.
+void UArenaRotation::SetStreamingState(ULevelStreaming* Streaming, bool bShouldBeLoaded, bool bShouldBeVisible)
+{
+	if (Streaming == nullptr)
+		return;
+
+	Streaming->bShouldBeLoaded = bShouldBeLoaded;
+	Streaming->bShouldBeVisible = bShouldBeVisible;
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		class APlayerController* PlayerController = Iterator->Get();
+
+		if (PlayerController != nullptr && !PlayerController->IsLocalController())
+			PlayerController->LevelStreamingStatusChanged(Streaming, bShouldBeLoaded, bShouldBeVisible, Streaming->bShouldBlockOnLoad, INDEX_NONE);
+	}
+}
+
+ULevel* UArenaRotation::GetCurrentArenaLevel() const
+{
+	const class ULevelStreaming* Streaming = ArenaStreaming.IsValidIndex(CurrentArena) ? ArenaStreaming[CurrentArena] : NULL;
+
+	return (Streaming && Streaming->IsLevelVisible()) ? Streaming->GetLoadedLevel() : NULL;
+}
+#pragma endregion
+
+#pragma region Rotation Logic
+void UArenaRotation::Start()
+{
+	if (!IsActive())
+		return;
+
+	CurrentArena = 0;
+	NextArena = ArenaLevels.Num() > 1 ? 1 : INDEX_NONE;
+	PreviousArena = INDEX_NONE;
+	TimeLeft = ArenaPlayTime;
+
+	// The first arena is part of starting the match, so it may block like the map load itself did
+	class ULevelStreaming* First = GetArenaStreaming(CurrentArena);
+
+	if (First == nullptr)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("Arena rotation: couldn't stream %s"), *ArenaLevels[CurrentArena]);
+		ArenaLevels.Reset();
+		return;
+	}
+
+	First->bShouldBlockOnLoad = true;
+	SetStreamingState(First, true, true);
+
+	// The second arena loads in the background while the first is played
+	SetStreamingState(GetArenaStreaming(NextArena), true, false);
+
+	bSwitching = true;
+	bArenaShown = false;
+	SwitchStartTime = FPlatformTime::Seconds();
+	WorstSwitchFrameMs = 0.f;
+	SwitchFrames = 0;
+}
+
+void UArenaRotation::RequestSwitch()
+{
+	if (NextArena != INDEX_NONE)
+		bSwitchRequested = true;
+}
+
+void UArenaRotation::Tick(float DeltaTime)
+{
+	if (!IsActive() || CurrentArena == INDEX_NONE)
+		return;
+
+	if (bSwitching)
+	{
+		UpdateSwitch();
+		return;
+	}
+
+	// Frame time to compare a switch against, from before it started
+	const float FrameMs = (float)(FApp::GetDeltaTime() * 1000.0);
+	AverageFrameMs = AverageFrameMs > 0.f ? FMath::Lerp(AverageFrameMs, FrameMs, 0.05f) : FrameMs;
+
+	if (ArenaPlayTime > 0.f && NextArena != INDEX_NONE)
+	{
+		TimeLeft -= DeltaTime;
+
+		if (TimeLeft <= 0.f)
+			bSwitchRequested = true;
+	}
+
+	if (!bSwitchRequested)
+		return;
+
+	class ULevelStreaming* Next = GetArenaStreaming(NextArena);
+
+	if (Next != nullptr && Next->IsLevelLoaded())
+	{
+		BeginSwitch();
+	}
+	else if (!bWaitingForLoad)
+	{
+		// Play on rather than stall the game waiting for it
+		bWaitingForLoad = true;
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Arena rotation: %s hasn't finished loading, %s plays on until it has"), *ArenaLevels[NextArena], *ArenaLevels[CurrentArena]);
+	}
+}
+
+// Show the preloaded arena. The old one is only let go once the new one is in, so players are never left without one.
+void UArenaRotation::BeginSwitch()
+{
+	PreviousArena = CurrentArena;
+	CurrentArena = NextArena;
+	NextArena = INDEX_NONE;
+	bSwitchRequested = false;
+	bWaitingForLoad = false;
+
+	SetStreamingState(GetArenaStreaming(CurrentArena), true, true);
+
+	bSwitching = true;
+	bArenaShown = false;
+	SwitchStartTime = FPlatformTime::Seconds();
+	WorstSwitchFrameMs = 0.f;
+	SwitchFrames = 0;
+}
+
+// Watch every frame until the new arena is in and the old one is out
+void UArenaRotation::UpdateSwitch()
+{
+	WorstSwitchFrameMs = FMath::Max(WorstSwitchFrameMs, (float)(FApp::GetDeltaTime() * 1000.0));
+	SwitchFrames++;
+
+	const class ULevelStreaming* Current = GetArenaStreaming(CurrentArena);
+	class ULevelStreaming* Previous = GetArenaStreaming(PreviousArena);
+
+	if (Current == nullptr || !Current->IsLevelVisible())
+		return;
+
+	// New arena is in with its respawn points registered, so players can be moved over and the old one dropped
+	if (!bArenaShown)
+	{
+		bArenaShown = true;
+		SetStreamingState(Previous, false, false);
+		OnArenaShown.Broadcast(FPackageName::GetShortName(ArenaLevels[CurrentArena]), Previous != nullptr);
+	}
+
+	if (Previous != nullptr && Previous->GetLoadedLevel() != nullptr)
+		return;
+
+	FinishSwitch();
+}
+
+void UArenaRotation::FinishSwitch()
+{
+	const bool bReplaced = PreviousArena != INDEX_NONE;
+	bSwitching = false;
+
+	// Only the first showing of the first arena may block, later ones come round again in the background
+	if (class ULevelStreaming* Current = GetArenaStreaming(CurrentArena))
+		Current->bShouldBlockOnLoad = false;
+
+	if (bReplaced)
+	{
+		// A stall is any time a switch frame took beyond a normal frame. Under one frame's worth means no frame was dropped.
+		const float StallMs = FMath::Max(0.f, WorstSwitchFrameMs - AverageFrameMs);
+
+		SET_FLOAT_STAT(STAT_ArenaSwitchWorstFrame, WorstSwitchFrameMs);
+		SET_FLOAT_STAT(STAT_ArenaSwitchStall, StallMs);
+
+		UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Arena rotation: switched to %s over %d frames (%.1f ms), worst frame %.1f ms, stall %.1f ms against a %.1f ms frame"),
+			*ArenaLevels[CurrentArena], SwitchFrames, (FPlatformTime::Seconds() - SwitchStartTime) * 1000.0, WorstSwitchFrameMs, StallMs, AverageFrameMs);
+
+		if (StallMs > AverageFrameMs)
+			UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Arena rotation: switching to %s stalled for more than a frame. Lower s.LevelStreamingActorsUpdateTimeLimit or split the arena up."), *ArenaLevels[CurrentArena]);
+	}
+	else
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Arena rotation: %s ready after %.1f ms"), *ArenaLevels[CurrentArena], (FPlatformTime::Seconds() - SwitchStartTime) * 1000.0);
+	}
+
+	// Start loading the one after, wrapping round. With two arenas that's the one just dropped.
+	NextArena = ArenaLevels.Num() > 1 ? (CurrentArena + 1) % ArenaLevels.Num() : INDEX_NONE;
+	PreviousArena = INDEX_NONE;
+	TimeLeft = ArenaPlayTime;
+
+	SetStreamingState(GetArenaStreaming(NextArena), true, false);
+}
+#pragma endregion
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "ArenaRotation.generated.h"
+
+// Short name of the arena that has just been shown, and whether it is replacing another one
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnArenaShown, const FString&, bool);
+
+// Plays the arenas in ArenaLevels in turn, each a streaming sub-level of the persistent map. While one arena is
+// played the next is loaded in the background and kept hidden, so a switch only has to show the new arena and then
+// drop the old one, which the engine spreads over several frames (see the streaming settings in DefaultEngine.ini).
+// A switch is never forced through a blocking load: if the next arena hasn't finished loading, the current one plays on.
+// Owned by the game mode and only active on the server. Run "LocalMultiplayer.NextArena" to switch straight away.
+UCLASS(config = Game)
+class LOCALMULTIPLAYERDEMO_API UArenaRotation : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UArenaRotation();
+
+	// Rotation of the world this object is in, NULL where there is no game mode (e.g. network clients)
+	static UArenaRotation* Get(const UObject* WorldContextObject);
+
+	// Long package names of the arena sub-levels, in the order they are played. Empty to play the persistent map alone.
+	// List them in the persistent map's Levels window too, otherwise network clients can't follow the switches.
+	UPROPERTY(Config)
+	TArray<FString> ArenaLevels;
+
+	// Seconds each arena is played before switching to the next, 0 to stay on the first
+	UPROPERTY(Config)
+	float ArenaPlayTime;
+
+	// Fired once an arena is visible and its respawn points have registered, just before the old arena is dropped
+	FOnArenaShown OnArenaShown;
+
+public:
+
+	// Show the first arena and start loading the second, called by the game mode on the server
+	void Start();
+
+	// Count the current arena down and move a switch along, called by the game mode every frame
+	void Tick(float DeltaTime);
+
+	// Switch to the next arena as soon as it has loaded
+	void RequestSwitch();
+
+	// True when there are arenas to play
+	FORCEINLINE bool IsActive() const { return ArenaLevels.Num() > 0; }
+
+	// Level of the arena being played, NULL before the first is shown or without arenas
+	class ULevel* GetCurrentArenaLevel() const;
+
+private:
+
+	// Streaming level for an arena, added to the world if the persistent map doesn't list it
+	class ULevelStreaming* GetArenaStreaming(int32 Arena);
+
+	// Change what a streaming level should be doing, and tell remote players to do the same
+	void SetStreamingState(class ULevelStreaming* Streaming, bool bShouldBeLoaded, bool bShouldBeVisible);
+
+	// Switch Methods
+	void BeginSwitch();
+	void UpdateSwitch();
+	void FinishSwitch();
+
+	UPROPERTY()
+	TArray<class ULevelStreaming*> ArenaStreaming;
+
+	// Arena being played and the one loading behind it, INDEX_NONE before Start
+	int32 CurrentArena;
+	int32 NextArena;
+
+	// Arena being switched away from, INDEX_NONE for the first arena
+	int32 PreviousArena;
+
+	// Seconds until the current arena is due to switch
+	float TimeLeft;
+
+	// Switch State Variables
+	bool bSwitchRequested;
+	bool bSwitching;
+	bool bArenaShown;
+	bool bWaitingForLoad;
+
+	// Switch Stall Variables. Frame times are real time, not dilated game time.
+	float AverageFrameMs;
+	float WorstSwitchFrameMs;
+	int32 SwitchFrames;
+	double SwitchStartTime;
+
+};
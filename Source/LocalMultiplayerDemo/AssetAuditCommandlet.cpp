@@ -0,0 +1,315 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssetAuditCommandlet.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "ArenaRotation.h"
+#include "AssetRegistryModule.h"
+#include "HAL/FileManager.h"
+#include "Internationalization/Regex.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+// Where cook settings live in DefaultGame.ini
+static const TCHAR* PackagingSettingsSection = TEXT("/Script/UnrealEd.ProjectPackagingSettings");
+
+UAssetAuditCommandlet::UAssetAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UAssetAuditCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	// Content to report on, defaults to all of the project's content
+	const FString ContentPath = ParamVals.Contains(TEXT("Path")) ? ParamVals[TEXT("Path")] : TEXT("/Game");
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	// Maps the game starts in, plus any extra ones asked for
+	TArray<FString> Maps;
+	GatherMaps(Maps);
+
+	if (ParamVals.Contains(TEXT("Map")))
+	{
+		TArray<FString> ExtraMaps;
+		ParamVals[TEXT("Map")].ParseIntoArray(ExtraMaps, TEXT("+"), true);
+
+		for (const FString& Map : ExtraMaps)
+			Maps.AddUnique(Map);
+	}
+
+	TSet<FName> Roots;
+
+	for (const FString& Map : Maps)
+	{
+		if (FPackageName::DoesPackageExist(Map))
+			Roots.Add(FName(*Map));
+		else
+			UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("AssetAudit: map %s isn't in the project, its content can't be counted"), *Map);
+	}
+
+	GatherSourceReferences(Roots);
+	GatherClassDefaultReferences(Roots);
+	GatherNamedLoads(Maps, Roots);
+
+	// Everything the roots pull in. Engine content is always cooked, so only project content is followed.
+	TSet<FName> UsedPackages;
+	TArray<FName> PendingPackages = Roots.Array();
+
+	while (PendingPackages.Num() > 0)
+	{
+		const FName PackageName = PendingPackages.Pop(false);
+
+		if (UsedPackages.Contains(PackageName))
+			continue;
+
+		UsedPackages.Add(PackageName);
+
+		TArray<FName> Dependencies;
+		AssetRegistry.GetDependencies(PackageName, Dependencies, EAssetRegistryDependencyType::Packages);
+
+		for (const FName& Dependency : Dependencies)
+		{
+			if (!UsedPackages.Contains(Dependency) && Dependency.ToString().StartsWith(TEXT("/Game/")))
+				PendingPackages.Add(Dependency);
+		}
+	}
+
+	// Every package under the content path, with the class of its main asset
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssetsByPath(FName(*ContentPath), Assets, true);
+
+	TMap<FName, FName> PackageClasses;
+
+	for (const FAssetData& Asset : Assets)
+		PackageClasses.FindOrAdd(Asset.PackageName) = Asset.AssetClass;
+
+	TArray<TPair<FName, int64>> UnreferencedPackages;
+	int64 UsedBytes = 0;
+	int64 UnreferencedBytes = 0;
+
+	for (const TPair<FName, FName>& PackageClass : PackageClasses)
+	{
+		const int64 Bytes = GetPackageSize(PackageClass.Key);
+
+		if (UsedPackages.Contains(PackageClass.Key))
+		{
+			UsedBytes += Bytes;
+		}
+		else
+		{
+			UnreferencedPackages.Add(TPair<FName, int64>(PackageClass.Key, Bytes));
+			UnreferencedBytes += Bytes;
+		}
+	}
+
+	// Biggest savings first
+	UnreferencedPackages.Sort([](const TPair<FName, int64>& A, const TPair<FName, int64>& B) { return A.Value > B.Value; });
+
+	FString UnreferencedCsv = TEXT("Package,Class,Bytes\n");
+
+	for (const TPair<FName, int64>& Package : UnreferencedPackages)
+		UnreferencedCsv += FString::Printf(TEXT("%s,%s,%lld\n"), *Package.Key.ToString(), *PackageClasses[Package.Key].ToString(), Package.Value);
+
+	TArray<FString> AllowList;
+
+	for (const FName& PackageName : UsedPackages)
+		AllowList.Add(PackageName.ToString());
+
+	AllowList.Sort();
+
+	const FString OutDir = FPaths::ProjectSavedDir() / TEXT("AssetAudit");
+	const FString AllowListFilename = OutDir / TEXT("CookAllowlist.txt");
+	const FString UnreferencedFilename = OutDir / TEXT("Unreferenced.csv");
+
+	if (!FFileHelper::SaveStringArrayToFile(AllowList, *AllowListFilename) || !FFileHelper::SaveStringToFile(UnreferencedCsv, *UnreferencedFilename))
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("AssetAudit: couldn't write to %s"), *OutDir);
+		return 1;
+	}
+
+	UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("AssetAudit: %d packages used (%.1f MB), %d unreferenced under %s (%.1f MB)"),
+		UsedPackages.Num(), UsedBytes / (1024.f * 1024.f), UnreferencedPackages.Num(), *ContentPath, UnreferencedBytes / (1024.f * 1024.f));
+	UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("AssetAudit: wrote %s and %s"), *AllowListFilename, *UnreferencedFilename);
+
+	if (Switches.Contains(TEXT("Apply")))
+	{
+		if (!ApplyMapsToCook(Maps))
+		{
+			UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("AssetAudit: couldn't update MapsToCook in DefaultGame.ini"));
+			return 1;
+		}
+
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("AssetAudit: cook limited to %d maps in DefaultGame.ini"), Maps.Num());
+	}
+
+	return 0;
+#else
+	UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("AssetAudit must be run from the editor"));
+	return 1;
+#endif
+}
+
+#pragma region Roots
+void UAssetAuditCommandlet::GatherSourceReferences(TSet<FName>& OutPackages) const
+{
+	TArray<FString> SourceFiles;
+	IFileManager::Get().FindFilesRecursive(SourceFiles, *(FPaths::ProjectDir() / TEXT("Source")), TEXT("*.cpp"), true, false);
+	IFileManager::Get().FindFilesRecursive(SourceFiles, *(FPaths::ProjectDir() / TEXT("Source")), TEXT("*.h"), true, false, false);
+
+	const FRegexPattern FinderPattern(TEXT("ConstructorHelpers::F(?:Object|Class)Finder<[^>]+>\\s*\\w+\\s*\\(\\s*TEXT\\(\\s*\"([^\"]+)\""));
+
+	for (const FString& SourceFile : SourceFiles)
+	{
+		FString Source;
+
+		if (!FFileHelper::LoadFileToString(Source, *SourceFile))
+			continue;
+
+		FRegexMatcher Matcher(FinderPattern, Source);
+
+		while (Matcher.FindNext())
+		{
+			// Finder paths may name the object inside the package
+			FString PackageName = Matcher.GetCaptureGroup(1);
+			int32 DotIndex;
+
+			if (PackageName.FindChar(TEXT('.'), DotIndex))
+				PackageName = PackageName.Left(DotIndex);
+
+			if (PackageName.StartsWith(TEXT("/Game/")))
+				OutPackages.Add(FName(*PackageName));
+		}
+	}
+}
+
+void UAssetAuditCommandlet::GatherClassDefaultReferences(TSet<FName>& OutPackages) const
+{
+	// This commandlet lives in the game module, so its package is the module's script package
+	const UPackage* ModulePackage = GetClass()->GetOutermost();
+
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		if (It->GetOutermost() != ModulePackage || It->HasAnyClassFlags(CLASS_Deprecated))
+			continue;
+
+		// Recursive, so meshes and anim classes set on default subobjects are found too
+		TArray<UObject*> References;
+		FReferenceFinder Finder(References, NULL, false, true, true, true);
+		Finder.FindReferences(It->GetDefaultObject());
+
+		for (UObject* Reference : References)
+		{
+			const FName PackageName = Reference->GetOutermost()->GetFName();
+
+			if (PackageName.ToString().StartsWith(TEXT("/Game/")))
+				OutPackages.Add(PackageName);
+		}
+	}
+}
+
+void UAssetAuditCommandlet::GatherMaps(TArray<FString>& OutMaps) const
+{
+	const TCHAR* MapsSection = TEXT("/Script/EngineSettings.GameMapsSettings");
+	const TCHAR* MapKeys[] = { TEXT("GameDefaultMap"), TEXT("ServerDefaultMap"), TEXT("TransitionMap") };
+
+	for (const TCHAR* MapKey : MapKeys)
+	{
+		FString Map;
+
+		if (GConfig->GetString(MapsSection, MapKey, Map, GEngineIni) && !Map.IsEmpty())
+			OutMaps.AddUnique(Map);
+	}
+
+	// Streamed in by the arena rotation
+	for (const FString& ArenaLevel : GetDefault<UArenaRotation>()->ArenaLevels)
+		OutMaps.AddUnique(ArenaLevel);
+
+	TArray<FString> MapsToCook;
+	GConfig->GetArray(PackagingSettingsSection, TEXT("MapsToCook"), MapsToCook, GGameIni);
+
+	for (const FString& MapToCook : MapsToCook)
+	{
+		FString Map;
+
+		if (FParse::Value(*MapToCook, TEXT("FilePath="), Map) && !Map.IsEmpty())
+			OutMaps.AddUnique(Map);
+	}
+}
+
+void UAssetAuditCommandlet::GatherNamedLoads(const TArray<FString>& Maps, TSet<FName>& OutPackages) const
+{
+	// The game mode loads a bake for the persistent map and for each arena as it is shown
+	for (const FString& Map : Maps)
+	{
+		const FString BakePackageName = ALocalMultiplayerDemoGameModeBase::GetRespawnBakePackageName(FPackageName::GetShortName(Map));
+
+		if (FPackageName::DoesPackageExist(BakePackageName))
+			OutPackages.Add(FName(*BakePackageName));
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	TArray<FString> Directories;
+	GConfig->GetArray(PackagingSettingsSection, TEXT("DirectoriesToAlwaysCook"), Directories, GGameIni);
+
+	for (const FString& Directory : Directories)
+	{
+		FString Path;
+
+		if (!FParse::Value(*Directory, TEXT("Path="), Path) || Path.IsEmpty())
+			continue;
+
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByPath(FName(*Path), Assets, true);
+
+		for (const FAssetData& Asset : Assets)
+			OutPackages.Add(Asset.PackageName);
+	}
+}
+#pragma endregion
+
+#pragma region Output
+bool UAssetAuditCommandlet::ApplyMapsToCook(const TArray<FString>& Maps) const
+{
+	const FString Filename = FPaths::ProjectConfigDir() / TEXT("DefaultGame.ini");
+
+	FConfigFile ConfigFile;
+	ConfigFile.Read(Filename);
+
+	// Without MapsToCook every map in the project is cooked, and everything they reference with it
+	FConfigSection& Section = ConfigFile.FindOrAdd(PackagingSettingsSection);
+	Section.Remove(TEXT("bCookAll"));
+	Section.Remove(TEXT("MapsToCook"));
+	Section.Remove(TEXT("+MapsToCook"));
+	Section.Add(TEXT("bCookAll"), FConfigValue(TEXT("False")));
+
+	for (const FString& Map : Maps)
+		Section.Add(TEXT("+MapsToCook"), FConfigValue(FString::Printf(TEXT("(FilePath=\"%s\")"), *Map)));
+
+	ConfigFile.Dirty = true;
+	return ConfigFile.Write(Filename);
+}
+
+int64 UAssetAuditCommandlet::GetPackageSize(FName PackageName)
+{
+	FString Filename;
+
+	if (!FPackageName::DoesPackageExist(PackageName.ToString(), NULL, &Filename))
+		return 0;
+
+	return FMath::Max<int64>(IFileManager::Get().FileSize(*Filename), 0);
+}
+#pragma endregion
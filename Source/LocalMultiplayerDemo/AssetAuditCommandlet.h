@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AssetAuditCommandlet.generated.h"
+
+// Works out which content the game actually uses, starting from the maps it cooks and the assets the C++ loads
+// (ConstructorHelpers paths in the source, objects referenced by this module's class defaults, arenas and respawn
+// bakes loaded by name and the directories that are always cooked), then following
+// asset registry dependencies through AnimBPs, meshes, materials and so on. Everything else is reported as unreferenced.
+// Writes Saved/AssetAudit/CookAllowlist.txt and Saved/AssetAudit/Unreferenced.csv. With -Apply, the cook is limited
+// to the used maps through MapsToCook in DefaultGame.ini, so unreferenced content is no longer packaged.
+// Usage: UE4Editor-Cmd LocalMultiplayerDemo.uproject -run=AssetAudit [-Map=/Game/Extra/Map+/Game/Other/Map] [-Path=/Game] [-Apply]
+UCLASS()
+class UAssetAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UAssetAuditCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	// Packages named in ConstructorHelpers finders anywhere in the project's source
+	void GatherSourceReferences(TSet<FName>& OutPackages) const;
+
+	// Content packages referenced by the defaults of this module's classes
+	void GatherClassDefaultReferences(TSet<FName>& OutPackages) const;
+
+	// Maps the game starts in, the configured arenas, plus any already listed in MapsToCook
+	void GatherMaps(TArray<FString>& OutMaps) const;
+
+	// Packages the game only loads by name: each map's respawn bake and everything in DirectoriesToAlwaysCook
+	void GatherNamedLoads(const TArray<FString>& Maps, TSet<FName>& OutPackages) const;
+
+	// Limit the cook to the given maps in DefaultGame.ini
+	bool ApplyMapsToCook(const TArray<FString>& Maps) const;
+
+	// Size of a package on disk, 0 if it can't be found
+	static int64 GetPackageSize(FName PackageName);
+
+};
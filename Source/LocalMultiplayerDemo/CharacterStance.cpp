@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterStance.h"
+#include "LocalMultiplayerDemo.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/CapsuleComponent.h"
+
+const FStanceSettings& FStanceTable::Get(ECharacterStance Stance) const
+{
+	switch (Stance)
+	{
+	case ECharacterStance::Crouch:
+		return Crouch;
+	case ECharacterStance::Prone:
+		return Prone;
+	default:
+		return Stand;
+	}
+}
+
+bool FStanceTable::HasRoomFor(const ACharacter* Character, const FStanceSettings& Settings)
+{
+	const class UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	const class UWorld* world = Character->GetWorld();
+
+	if (Capsule == nullptr || world == nullptr)
+		return false;
+
+	const float Scale = Capsule->GetShapeScale();
+	const float HeightChange = (Settings.CapsuleHalfHeight - Capsule->GetUnscaledCapsuleHalfHeight()) * Scale;
+
+	if (HeightChange <= 0.f && Settings.CapsuleRadius <= Capsule->GetUnscaledCapsuleRadius())
+		return true;
+
+	// Test the new capsule standing on the same floor, against whatever the character collides with while moving
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(StanceRoom), false, Character);
+	FCollisionResponseParams ResponseParams;
+
+	if (const class UCharacterMovementComponent* CharacterMove = Character->GetCharacterMovement())
+		CharacterMove->InitCollisionParams(QueryParams, ResponseParams);
+
+	const FVector Location = Character->GetActorLocation() + FVector(0.f, 0.f, HeightChange);
+	const FCollisionShape Shape = FCollisionShape::MakeCapsule(Settings.CapsuleRadius * Scale, Settings.CapsuleHalfHeight * Scale);
+
+	return !world->OverlapBlockingTestByChannel(Location, FQuat::Identity, Capsule->GetCollisionObjectType(), Shape, QueryParams, ResponseParams);
+}
+
+float FStanceTable::Apply(ACharacter* Character, const FStanceSettings& Settings)
+{
+	class UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+
+	if (Capsule == nullptr)
+		return 0.f;
+
+	const float HeightChange = Settings.CapsuleHalfHeight - Capsule->GetUnscaledCapsuleHalfHeight();
+
+	Capsule->SetCapsuleSize(Settings.CapsuleRadius, Settings.CapsuleHalfHeight);
+
+	// Keep the feet on the floor. Growing was checked for room by HasRoomFor, so this doesn't need to sweep.
+	if (HeightChange != 0.f)
+		Character->SetActorLocation(Character->GetActorLocation() + FVector(0.f, 0.f, HeightChange * Capsule->GetShapeScale()));
+
+	if (class UCharacterMovementComponent* CharacterMove = Character->GetCharacterMovement())
+		CharacterMove->MaxWalkSpeed = Settings.MaxWalkSpeed;
+
+	return HeightChange;
+}
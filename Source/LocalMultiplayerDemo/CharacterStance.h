@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CharacterStance.generated.h"
+
+// How the character is carrying itself. The order matches the anim graph's Blend Poses by enum.
+UENUM(BlueprintType)
+enum class ECharacterStance : uint8
+{
+	Stand,
+	Crouch,
+	Prone
+};
+
+// Capsule size and movement speed for one stance
+USTRUCT(BlueprintType)
+struct FStanceSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance", meta = (ClampMin = "1"))
+	float CapsuleRadius;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance", meta = (ClampMin = "1"))
+	float CapsuleHalfHeight;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance", meta = (ClampMin = "0"))
+	float MaxWalkSpeed;
+
+	FStanceSettings() : CapsuleRadius(42.f), CapsuleHalfHeight(96.f), MaxWalkSpeed(600.f) {}
+
+	FStanceSettings(float InCapsuleRadius, float InCapsuleHalfHeight, float InMaxWalkSpeed)
+		: CapsuleRadius(InCapsuleRadius), CapsuleHalfHeight(InCapsuleHalfHeight), MaxWalkSpeed(InMaxWalkSpeed) {}
+
+};
+
+// Settings for every stance, edited on the character
+USTRUCT(BlueprintType)
+struct FStanceTable
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance")
+	FStanceSettings Stand;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance")
+	FStanceSettings Crouch;
+
+	// A slow crawl. The AnimStarterPack has no crawl animation, so this plays the prone idle while moving.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance")
+	FStanceSettings Prone;
+
+	FStanceTable() : Stand(42.f, 96.f, 600.f), Crouch(42.f, 64.f, 250.f), Prone(42.f, 42.f, 100.f) {}
+
+	const FStanceSettings& Get(ECharacterStance Stance) const;
+
+	// Whether the character has room to take up a stance where it stands. Shrinking always fits.
+	static bool HasRoomFor(const class ACharacter* Character, const FStanceSettings& Settings);
+
+	// Resize the character's capsule and set its walk speed, keeping its feet where they were.
+	// Returns how far the capsule's centre moved up, so the caller can move the mesh down by as much.
+	static float Apply(class ACharacter* Character, const FStanceSettings& Settings);
+
+};
+
+// Everything the anim graph needs to pose the character's locomotion, worked out natively once per update.
+// The graph only reads these members, so every node bound to them stays on the fast path however many stances there are.
+USTRUCT(BlueprintType)
+struct FLocomotionAnimState
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Stance being posed, and the one before it
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	ECharacterStance Stance;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	ECharacterStance PreviousStance;
+
+	// Run input, -1..1 (forward is the Horizontal axis of the old AnimBPs, right is Vertical)
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float Forward;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float Right;
+
+	// Blend space to play for this stance, with bHasBlendSpace false when the stance only has an idle
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	class UBlendSpaceBase* BlendSpace;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	bool bHasBlendSpace;
+
+	// Idle for stances without a blend space
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* IdleAnim;
+
+	// Stand_to_Crouch and friends, played through a Sequence Evaluator at TransitionTime while bInTransition
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* TransitionAnim;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	float TransitionTime;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Locomotion")
+	bool bInTransition;
+
+	FLocomotionAnimState()
+	{
+		Stance = ECharacterStance::Stand;
+		PreviousStance = ECharacterStance::Stand;
+		Forward = 0.f;
+		Right = 0.f;
+		BlendSpace = NULL;
+		bHasBlendSpace = false;
+		IdleAnim = NULL;
+		TransitionAnim = NULL;
+		TransitionTime = 0.f;
+		bInTransition = false;
+	}
+
+};
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CharacterStateManager.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "HitchDetector.h"
+#include "P2_Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("Character State"), STAT_CharacterState, STATGROUP_LocalMultiplayerDemo);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Character State Slots"), STAT_CharacterStateSlots, STATGROUP_LocalMultiplayerDemo);
+
+static int32 GBatchCharacterState = 1;
+static FAutoConsoleVariableRef CVarBatchCharacterState(
+	TEXT("LocalMultiplayer.BatchCharacterState"),
+	GBatchCharacterState,
+	TEXT("1 updates every character's respawn state in one pass from the game mode, with no character ticks of their own. ")
+	TEXT("0 has each character tick and update itself, to compare frame times."));
+
+UCharacterStateManager::UCharacterStateManager()
+{
+	// Default Values for Variables
+	bAppliedBatched = true;
+}
+
+UCharacterStateManager* UCharacterStateManager::Get(const UObject* WorldContextObject)
+{
+	class UWorld* const world = WorldContextObject ? WorldContextObject->GetWorld() : NULL;
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	return GameMode ? GameMode->CharacterState : NULL;
+}
+
+bool UCharacterStateManager::IsBatched()
+{
+	return GBatchCharacterState != 0;
+}
+
+#pragma region Slots
+int32 UCharacterStateManager::Register(AP2_Character* Character, float InRespawnDelay)
+{
+	const int32 Slot = Characters.Add(Character);
+
+	RespawnCountdown.Add(InRespawnDelay);
+	RespawnDelay.Add(InRespawnDelay);
+	Dead.Add(0);
+	CanDisable.Add(0);
+	CanRespawn.Add(0);
+
+	SET_DWORD_STAT(STAT_CharacterStateSlots, Characters.Num());
+	return Slot;
+}
+
+void UCharacterStateManager::Unregister(AP2_Character* Character)
+{
+	const int32 Slot = Character ? Character->stateSlot : INDEX_NONE;
+
+	if (!Characters.IsValidIndex(Slot) || Characters[Slot] != Character)
+		return;
+
+	Characters.RemoveAtSwap(Slot, 1, false);
+	RespawnCountdown.RemoveAtSwap(Slot, 1, false);
+	RespawnDelay.RemoveAtSwap(Slot, 1, false);
+	Dead.RemoveAtSwap(Slot, 1, false);
+	CanDisable.RemoveAtSwap(Slot, 1, false);
+	CanRespawn.RemoveAtSwap(Slot, 1, false);
+
+	// Whoever was last now lives in the freed slot
+	if (Characters.IsValidIndex(Slot))
+		Characters[Slot]->stateSlot = Slot;
+
+	Character->stateSlot = INDEX_NONE;
+
+	// Mid-pass, so leave a gap rather than shuffle the lists being walked
+	for (class AP2_Character*& Pending : PendingDisables)
+	{
+		if (Pending == Character)
+			Pending = NULL;
+	}
+
+	for (class AP2_Character*& Pending : PendingRespawns)
+	{
+		if (Pending == Character)
+			Pending = NULL;
+	}
+
+	SET_DWORD_STAT(STAT_CharacterStateSlots, Characters.Num());
+}
+
+void UCharacterStateManager::Kill(int32 Slot)
+{
+	if (Dead.IsValidIndex(Slot))
+		Dead[Slot] = 1;
+}
+
+void UCharacterStateManager::ResetSlot(int32 Slot)
+{
+	if (!Dead.IsValidIndex(Slot))
+		return;
+
+	RespawnCountdown[Slot] = RespawnDelay[Slot];
+	Dead[Slot] = 0;
+	CanDisable[Slot] = 0;
+	CanRespawn[Slot] = 0;
+}
+#pragma endregion
+
+#pragma region Update
+void UCharacterStateManager::Tick(float DeltaTime)
+{
+	const bool bBatched = IsBatched();
+
+	if (bBatched != bAppliedBatched)
+		ApplyBatched(bBatched);
+
+	if (!bBatched)
+		return;
+
+	SCOPE_HITCH_CYCLE_COUNTER(STAT_CharacterState, EHitchSection::CharacterState);
+
+	const int32 NumSlots = Characters.Num();
+	float* const Countdowns = RespawnCountdown.GetData();
+	const uint8* const DeadFlags = Dead.GetData();
+
+	// Every dead character counts down. No branches, so the compiler can do several slots at a time.
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+		Countdowns[Slot] -= DeltaTime * (float)DeadFlags[Slot];
+
+	// The few that move on this frame
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		const EPhaseChange Change = GetPhaseChange(Slot);
+
+		if (Change == EPhaseChange::Disable)
+			PendingDisables.Add(Characters[Slot]);
+		else if (Change == EPhaseChange::Respawn)
+			PendingRespawns.Add(Characters[Slot]);
+	}
+
+	// Actor work last, so broadcasts that end up destroying a character can't shuffle slots under the passes above
+	for (class AP2_Character* Character : PendingDisables)
+		DisableCharacter(Character);
+
+	for (class AP2_Character* Character : PendingRespawns)
+		RespawnCharacter(Character);
+
+	PendingDisables.Reset();
+	PendingRespawns.Reset();
+}
+
+// Same logic as a pass, for one slot
+void UCharacterStateManager::TickSlot(int32 Slot, float DeltaTime)
+{
+	if (!Dead.IsValidIndex(Slot) || !Dead[Slot])
+		return;
+
+	RespawnCountdown[Slot] -= DeltaTime;
+
+	const EPhaseChange Change = GetPhaseChange(Slot);
+
+	if (Change == EPhaseChange::Disable)
+		DisableCharacter(Characters[Slot]);
+	else if (Change == EPhaseChange::Respawn)
+		RespawnCharacter(Characters[Slot]);
+}
+
+void UCharacterStateManager::DisableCharacter(AP2_Character* Character)
+{
+	if (Character == nullptr || Character->IsPendingKill())
+		return;
+
+	Character->DisablePlayer();
+
+	const int32 Slot = Character->stateSlot;
+
+	if (Characters.IsValidIndex(Slot))
+	{
+		CanDisable[Slot] = 1;
+		CanRespawn[Slot] = 0;
+	}
+}
+
+void UCharacterStateManager::RespawnCharacter(AP2_Character* Character)
+{
+	if (Character == nullptr || Character->IsPendingKill())
+		return;
+
+	Character->Respawn();
+
+	const int32 Slot = Character->stateSlot;
+
+	if (Characters.IsValidIndex(Slot))
+	{
+		RespawnCountdown[Slot] = RespawnDelay[Slot];
+		Dead[Slot] = 0;
+		CanRespawn[Slot] = 1;
+		CanDisable[Slot] = 0;
+	}
+}
+
+void UCharacterStateManager::ApplyBatched(bool bBatched)
+{
+	bAppliedBatched = bBatched;
+
+	for (class AP2_Character* Character : Characters)
+		Character->UpdateActorTickEnabled();
+
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Character state: %s for %d characters"), bBatched ? TEXT("one pass") : TEXT("per-character ticks"), Characters.Num());
+}
+#pragma endregion
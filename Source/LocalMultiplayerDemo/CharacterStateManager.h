@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "CharacterStateManager.generated.h"
+
+// Keeps the state every player two and bot character updates each frame (dead or alive, respawn countdown, and where
+// it is in the disable/respawn cycle) in parallel arrays indexed by a state slot, and updates all of them in one pass
+// from the game mode's tick. The countdown is one branch-free loop over contiguous floats, and only the few characters
+// that change phase that frame are touched. With it, those characters need no actor tick of their own.
+// Server only, like the rest of the respawn logic. Owned by the game mode. "LocalMultiplayer.BatchCharacterState 0"
+// goes back to each character updating its own slot from its own tick, to compare the two.
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API UCharacterStateManager : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UCharacterStateManager();
+
+	// State manager of the world this object is in, NULL where there is no game mode (e.g. network clients)
+	static UCharacterStateManager* Get(const UObject* WorldContextObject);
+
+	// True when the state manager updates every character, false when each character updates itself
+	static bool IsBatched();
+
+	// Give a character a slot, alive with a full countdown. Returns the slot.
+	int32 Register(class AP2_Character* Character, float RespawnDelay);
+
+	// Free a character's slot. The last slot moves into it, so the arrays stay packed.
+	void Unregister(class AP2_Character* Character);
+
+	// Count down and move every character on through the disable/respawn cycle. Called by the game mode every frame.
+	void Tick(float DeltaTime);
+
+	// The same for one character, from its own tick when not batched
+	void TickSlot(int32 Slot, float DeltaTime);
+
+	// Start the disable/respawn cycle
+	void Kill(int32 Slot);
+
+	// Alive with a full countdown, as after a respawn or a round reset
+	void ResetSlot(int32 Slot);
+
+	FORCEINLINE int32 GetNumCharacters() const { return Characters.Num(); }
+	FORCEINLINE bool IsDead(int32 Slot) const { return Dead[Slot] != 0; }
+	FORCEINLINE float GetRespawnCountdown(int32 Slot) const { return RespawnCountdown[Slot]; }
+
+private:
+
+	// Which way a dead character moves on this update, if at all
+	enum class EPhaseChange : uint8
+	{
+		None,
+		Disable,
+		Respawn
+	};
+
+	FORCEINLINE EPhaseChange GetPhaseChange(int32 Slot) const
+	{
+		if (!Dead[Slot])
+			return EPhaseChange::None;
+
+		if (RespawnCountdown[Slot] < 0.f)
+			return CanRespawn[Slot] ? EPhaseChange::None : EPhaseChange::Respawn;
+
+		return CanDisable[Slot] ? EPhaseChange::None : EPhaseChange::Disable;
+	}
+
+	// The actor side of a phase change
+	void DisableCharacter(class AP2_Character* Character);
+	void RespawnCharacter(class AP2_Character* Character);
+
+	// Switch every character's own tick on or off to match IsBatched
+	void ApplyBatched(bool bBatched);
+
+	// Slot Arrays, all the same length
+	UPROPERTY()
+	TArray<class AP2_Character*> Characters;
+
+	TArray<float> RespawnCountdown;
+	TArray<float> RespawnDelay;
+	TArray<uint8> Dead;
+	TArray<uint8> CanDisable;
+	TArray<uint8> CanRespawn;
+
+	// Characters changing phase this frame, kept between frames so collecting them doesn't allocate
+	TArray<class AP2_Character*> PendingDisables;
+	TArray<class AP2_Character*> PendingRespawns;
+
+	// IsBatched as the characters' ticks were last set for it
+	bool bAppliedBatched;
+
+};
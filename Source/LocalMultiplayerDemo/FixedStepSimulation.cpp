@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FixedStepSimulation.h"
+#include "LocalMultiplayerDemo.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+
+FFixedStepSimulation::FFixedStepSimulation()
+{
+	StepSeconds = 1.f / 60.f;
+	MaxSubsteps = 4;
+	Accumulator = 0.f;
+}
+
+void FFixedStepSimulation::Configure(float StepRate, int32 InMaxSubsteps)
+{
+	StepSeconds = 1.f / FMath::Max(StepRate, 1.f);
+	MaxSubsteps = FMath::Max(InMaxSubsteps, 1);
+	Accumulator = 0.f;
+}
+
+int32 FFixedStepSimulation::Advance(float DeltaTime)
+{
+	Accumulator += DeltaTime;
+
+	int32 Steps = FMath::FloorToInt(Accumulator / StepSeconds);
+
+	// Don't let a hitch snowball into ever longer frames
+	if (Steps > MaxSubsteps)
+	{
+		Steps = MaxSubsteps;
+		Accumulator = StepSeconds * MaxSubsteps;
+	}
+
+	Accumulator -= Steps * StepSeconds;
+
+	return Steps;
+}
+
+void FFixedStepSimulation::BeginStep(const AActor* Actor)
+{
+	PreviousTransform = Actor->GetActorTransform();
+}
+
+void FFixedStepSimulation::EndStep(const AActor* Actor)
+{
+	CurrentTransform = Actor->GetActorTransform();
+}
+
+void FFixedStepSimulation::Reset(const AActor* Actor)
+{
+	PreviousTransform = Actor->GetActorTransform();
+	CurrentTransform = PreviousTransform;
+}
+
+FTransform FFixedStepSimulation::GetRenderTransform() const
+{
+	FTransform RenderTransform;
+	RenderTransform.Blend(PreviousTransform, CurrentTransform, GetAlpha());
+
+	return RenderTransform;
+}
+
+void FFixedStepSimulation::ApplyRenderTransform(USceneComponent* Component, const FTransform& BaseRelativeTransform) const
+{
+	if (Component == nullptr)
+		return;
+
+	// Offset from where the actor really is to where we want to draw it, in the actor's space
+	const FTransform RenderOffset = GetRenderTransform().GetRelativeTransform(CurrentTransform);
+	Component->SetRelativeTransform(BaseRelativeTransform * RenderOffset);
+}
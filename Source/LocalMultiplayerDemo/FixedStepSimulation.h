@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Accumulates frame time into fixed size simulation steps and remembers the
+// actor's transform either side of the last step so rendering can blend between them.
+struct LOCALMULTIPLAYERDEMO_API FFixedStepSimulation
+{
+	FFixedStepSimulation();
+
+	// Step rate in Hz and the most steps a single frame may run (the rest of a long frame is dropped)
+	void Configure(float StepRate, int32 InMaxSubsteps);
+
+	// Add a frame's time and return how many whole steps to run this frame
+	int32 Advance(float DeltaTime);
+
+	// Bracket each step so the previous/current transforms are known
+	void BeginStep(const class AActor* Actor);
+	void EndStep(const class AActor* Actor);
+
+	// Forget the previous transform, e.g. after a teleport
+	void Reset(const class AActor* Actor);
+
+	// How far rendering is between the previous and current step, 0..1
+	FORCEINLINE float GetAlpha() const { return StepSeconds > 0.f ? Accumulator / StepSeconds : 1.f; }
+
+	FORCEINLINE float GetStepSeconds() const { return StepSeconds; }
+
+	// Interpolated world transform to draw the actor at
+	FTransform GetRenderTransform() const;
+
+	// Place a component attached to the actor's root where it would be if the actor were at the render transform
+	void ApplyRenderTransform(class USceneComponent* Component, const FTransform& BaseRelativeTransform) const;
+
+private:
+
+	float StepSeconds;
+	int32 MaxSubsteps;
+	float Accumulator;
+
+	FTransform PreviousTransform;
+	FTransform CurrentTransform;
+
+};
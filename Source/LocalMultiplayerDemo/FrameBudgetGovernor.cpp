@@ -0,0 +1,247 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FrameBudgetGovernor.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "LocalMultiplayerDemoBotController.h"
+#include "KillCamRecorder.h"
+#include "TriggerManager.h"
+#include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Runtime/Engine/Public/EngineUtils.h"
+#include "RenderCore.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Governor Level"), STAT_GovernorLevel, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Game Thread (ms)"), STAT_GovernorFrameTime, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Budget (ms)"), STAT_GovernorBudget, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Anim Tick Interval (s)"), STAT_GovernorAnimTickInterval, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Bot Tick Interval (s)"), STAT_GovernorBotTickInterval, STATGROUP_LocalMultiplayerDemo);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Governor Active Bots"), STAT_GovernorActiveBots, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Pickup Tick Interval (s)"), STAT_GovernorPickupTickInterval, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Governor Kill Cam Sample Rate (Hz)"), STAT_GovernorSampleRate, STATGROUP_LocalMultiplayerDemo);
+
+static int32 GGovernorForceLevel = -1;
+static FAutoConsoleVariableRef CVarGovernorForceLevel(
+	TEXT("LocalMultiplayer.Governor.ForceLevel"),
+	GGovernorForceLevel,
+	TEXT("Hold the frame budget governor at this level instead of following the frame time, -1 to let it choose"));
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GGovernorReportCommand(
+	TEXT("LocalMultiplayer.GovernorReport"),
+	TEXT("Prints the frame budget governor's level, what each lever is set to and the frame time it is reacting to"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const class UFrameBudgetGovernor* Governor = UFrameBudgetGovernor::Get(World))
+			Governor->PrintReport(Ar);
+		else
+			Ar.Logf(TEXT("No frame budget governor on this world (it only runs on the server)"));
+	}));
+
+UFrameBudgetGovernor::UFrameBudgetGovernor()
+{
+	TargetFrameRate = 0.f;
+	DegradeDelay = 0.5f;
+	RecoverDelay = 5.f;
+	RecoverBelow = 0.75f;
+	SmoothingTime = 0.25f;
+
+	// Full quality, then bots and the kill-cam first, then pickups and animation
+	Levels.Add(FFrameBudgetLevel(0.f, 0.f, -1, 0.f, 1.f));
+	Levels.Add(FFrameBudgetLevel(0.f, 0.1f, -1, 0.f, 0.5f));
+	Levels.Add(FFrameBudgetLevel(1.f / 30.f, 0.2f, 8, 1.f / 30.f, 0.5f));
+	Levels.Add(FFrameBudgetLevel(1.f / 20.f, 0.25f, 4, 1.f / 20.f, 0.25f));
+
+	// Default Values for Variables
+	bStarted = false;
+	Level = 0;
+	SmoothedFrameTime = 0.f;
+	OverBudgetTime = 0.f;
+	UnderBudgetTime = 0.f;
+	AppliedNumPawns = 0;
+	ActiveBots = 0;
+}
+
+UFrameBudgetGovernor* UFrameBudgetGovernor::Get(const UObject* WorldContextObject)
+{
+	class UWorld* const world = WorldContextObject ? WorldContextObject->GetWorld() : NULL;
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	return GameMode ? GameMode->FrameBudgetGovernor : NULL;
+}
+
+#pragma region Governor Logic
+void UFrameBudgetGovernor::Start()
+{
+	// The match simulator ticks as fast as it can, there is no frame rate to hold
+	if (GetWorld() == nullptr || IsRunningCommandlet() || bStarted)
+		return;
+
+	// Without levels there is nothing to step through
+	if (Levels.Num() == 0)
+		Levels.AddDefaulted();
+
+	bStarted = true;
+	Level = 0;
+	ApplyLevel();
+
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Frame budget governor: holding %.1f ms of game thread time with %d levels"), GetBudget(), Levels.Num());
+}
+
+void UFrameBudgetGovernor::Tick(float DeltaTime)
+{
+	if (!bStarted || DeltaTime <= 0.f)
+		return;
+
+	// Average over about SmoothingTime seconds whatever the frame rate
+	const float Alpha = FMath::Clamp(DeltaTime / FMath::Max(SmoothingTime, DeltaTime), 0.f, 1.f);
+	SmoothedFrameTime = FMath::Lerp(SmoothedFrameTime, GetGameThreadTime(DeltaTime), Alpha);
+
+	const float Budget = GetBudget();
+
+	if (GGovernorForceLevel >= 0)
+	{
+		OverBudgetTime = 0.f;
+		UnderBudgetTime = 0.f;
+
+		const int32 ForcedLevel = FMath::Min(GGovernorForceLevel, Levels.Num() - 1);
+
+		if (ForcedLevel != Level)
+			SetLevel(ForcedLevel);
+	}
+	else if (SmoothedFrameTime > Budget)
+	{
+		OverBudgetTime += DeltaTime;
+		UnderBudgetTime = 0.f;
+
+		if (OverBudgetTime >= DegradeDelay && Level < Levels.Num() - 1)
+			SetLevel(Level + 1);
+	}
+	else if (SmoothedFrameTime < Budget * RecoverBelow)
+	{
+		UnderBudgetTime += DeltaTime;
+		OverBudgetTime = 0.f;
+
+		if (UnderBudgetTime >= RecoverDelay && Level > 0)
+			SetLevel(Level - 1);
+	}
+	else
+	{
+		// Close to the budget either way, so stay where we are
+		OverBudgetTime = 0.f;
+		UnderBudgetTime = 0.f;
+	}
+
+	// Players joining and bots spawning get the current level's settings too
+	if (GetWorld()->GetNumPawns() != AppliedNumPawns)
+		ApplyLevel();
+
+	SET_FLOAT_STAT(STAT_GovernorFrameTime, SmoothedFrameTime);
+	SET_FLOAT_STAT(STAT_GovernorBudget, Budget);
+}
+
+void UFrameBudgetGovernor::SetLevel(int32 NewLevel)
+{
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Frame budget governor: level %d -> %d (game thread %.1f ms, budget %.1f ms)"), Level, NewLevel, SmoothedFrameTime, GetBudget());
+
+	// Each step has to earn the next one from scratch
+	Level = NewLevel;
+	OverBudgetTime = 0.f;
+	UnderBudgetTime = 0.f;
+
+	ApplyLevel();
+}
+
+void UFrameBudgetGovernor::ApplyLevel()
+{
+	class UWorld* const world = GetWorld();
+
+	if (world == nullptr || !Levels.IsValidIndex(Level))
+		return;
+
+	const FFrameBudgetLevel& Settings = Levels[Level];
+
+	// Character meshes, the players' and the bots'
+	for (FConstPawnIterator Iterator = world->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		class ACharacter* Character = Cast<ACharacter>(Iterator->Get());
+
+		if (Character != nullptr && Character->GetMesh() != nullptr)
+			Character->GetMesh()->SetComponentTickInterval(Settings.AnimTickInterval);
+	}
+
+	AppliedNumPawns = world->GetNumPawns();
+
+	// The first MaxActiveBots bots carry on, the rest are parked
+	ActiveBots = 0;
+
+	for (TActorIterator<ALocalMultiplayerDemoBotController> It(world); It; ++It)
+	{
+		const bool bActive = Settings.MaxActiveBots < 0 || ActiveBots < Settings.MaxActiveBots;
+
+		It->SetBotActive(bActive);
+		It->SetBotTickInterval(Settings.BotTickInterval);
+
+		if (bActive)
+			ActiveBots++;
+	}
+
+	class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetOuter());
+
+	if (GameMode && GameMode->TriggerManager)
+		GameMode->TriggerManager->SetActorTickInterval(Settings.PickupTickInterval);
+
+	if (GameMode && GameMode->KillCamRecorder)
+	{
+		GameMode->KillCamRecorder->SetSampleRate(GameMode->KillCamRecorder->RecordRate * Settings.RecordRateScale);
+		SET_FLOAT_STAT(STAT_GovernorSampleRate, GameMode->KillCamRecorder->GetSampleRate());
+	}
+
+	SET_DWORD_STAT(STAT_GovernorLevel, Level);
+	SET_FLOAT_STAT(STAT_GovernorAnimTickInterval, Settings.AnimTickInterval);
+	SET_FLOAT_STAT(STAT_GovernorBotTickInterval, Settings.BotTickInterval);
+	SET_DWORD_STAT(STAT_GovernorActiveBots, ActiveBots);
+	SET_FLOAT_STAT(STAT_GovernorPickupTickInterval, Settings.PickupTickInterval);
+}
+
+float UFrameBudgetGovernor::GetBudget() const
+{
+	float FrameRate = TargetFrameRate;
+
+	if (FrameRate <= 0.f && GEngine != nullptr)
+		FrameRate = GEngine->MinDesiredFrameRate;
+
+	return 1000.f / (FrameRate > 0.f ? FrameRate : 30.f);
+}
+
+// The "Game" time of "stat unit", which leaves out waiting for the render thread. Whole frames where that isn't kept.
+float UFrameBudgetGovernor::GetGameThreadTime(float DeltaTime)
+{
+	return GGameThreadTime > 0 ? FPlatformTime::ToMilliseconds(GGameThreadTime) : DeltaTime * 1000.f;
+}
+#pragma endregion
+
+#pragma region Report
+void UFrameBudgetGovernor::PrintReport(FOutputDevice& Ar) const
+{
+	if (!bStarted)
+	{
+		Ar.Logf(TEXT("Frame budget governor isn't running (commandlet)"));
+		return;
+	}
+
+	Ar.Logf(TEXT("Frame budget governor: level %d of %d%s, game thread %.1f ms against %.1f ms (recover below %.1f ms)"),
+		Level, Levels.Num() - 1, GGovernorForceLevel >= 0 ? TEXT(" (forced)") : TEXT(""), SmoothedFrameTime, GetBudget(), GetBudget() * RecoverBelow);
+	Ar.Logf(TEXT("  Over budget for %.1f of %.1f s, under for %.1f of %.1f s, %d bots running"),
+		OverBudgetTime, DegradeDelay, UnderBudgetTime, RecoverDelay, ActiveBots);
+
+	for (int32 Index = 0; Index < Levels.Num(); ++Index)
+	{
+		const FFrameBudgetLevel& Settings = Levels[Index];
+
+		Ar.Logf(TEXT("  %s%d: anim every %.3f s, bots every %.3f s, %s bots, pickups every %.3f s, kill-cam at %.0f%%"),
+			Index == Level ? TEXT("> ") : TEXT("  "), Index, Settings.AnimTickInterval, Settings.BotTickInterval,
+			Settings.MaxActiveBots < 0 ? TEXT("all") : *FString::FromInt(Settings.MaxActiveBots),
+			Settings.PickupTickInterval, Settings.RecordRateScale * 100.f);
+	}
+}
+#pragma endregion
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "FrameBudgetGovernor.generated.h"
+
+// Gameplay-side settings for one governor level. Level 0 is full quality, each level after it gives more time back.
+USTRUCT()
+struct FFrameBudgetLevel
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Seconds between character mesh (animation) updates, 0 for every frame
+	UPROPERTY()
+	float AnimTickInterval;
+
+	// Seconds between bot decisions and path following updates, 0 for every frame
+	UPROPERTY()
+	float BotTickInterval;
+
+	// Bots left running, the rest are parked where they stand. -1 for all of them.
+	UPROPERTY()
+	int32 MaxActiveBots;
+
+	// Seconds between pickup and kill volume tests, 0 for every frame
+	UPROPERTY()
+	float PickupTickInterval;
+
+	// Share of the kill-cam's RecordRate to sample at
+	UPROPERTY()
+	float RecordRateScale;
+
+	FFrameBudgetLevel()
+		: AnimTickInterval(0.f), BotTickInterval(0.f), MaxActiveBots(-1), PickupTickInterval(0.f), RecordRateScale(1.f) {}
+
+	FFrameBudgetLevel(float InAnimTickInterval, float InBotTickInterval, int32 InMaxActiveBots, float InPickupTickInterval, float InRecordRateScale)
+		: AnimTickInterval(InAnimTickInterval), BotTickInterval(InBotTickInterval), MaxActiveBots(InMaxActiveBots), PickupTickInterval(InPickupTickInterval), RecordRateScale(InRecordRateScale) {}
+
+};
+
+// Holds the frame rate as split-screen players join by trading gameplay detail for game thread time. It watches the
+// game thread's frame time against the budget from TargetFrameRate (MinDesiredFrameRate in DefaultEngine.ini unless
+// set), and steps through Levels: down one level once frames have been over budget for DegradeDelay seconds, and back
+// up once they have been well under it (RecoverBelow) for the longer RecoverDelay, so it doesn't flip back and forth.
+// Owned by the game mode. Its decisions are in "stat LocalMultiplayerDemo", and "LocalMultiplayer.GovernorReport"
+// prints them with the level table. "LocalMultiplayer.Governor.ForceLevel" pins a level for testing.
+UCLASS(config = Game)
+class LOCALMULTIPLAYERDEMO_API UFrameBudgetGovernor : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UFrameBudgetGovernor();
+
+	// Governor of the world this object is in, NULL where there is no game mode (e.g. network clients)
+	static UFrameBudgetGovernor* Get(const UObject* WorldContextObject);
+
+	// Frame rate to hold, 0 to use the engine's MinDesiredFrameRate
+	UPROPERTY(Config)
+	float TargetFrameRate;
+
+	// Step down a level once the game thread has been over budget for this many seconds
+	UPROPERTY(Config)
+	float DegradeDelay;
+
+	// Step back up a level once the game thread has been under RecoverBelow of the budget for this many seconds
+	UPROPERTY(Config)
+	float RecoverDelay;
+
+	// Share of the budget the game thread has to be under before a level is given back
+	UPROPERTY(Config)
+	float RecoverBelow;
+
+	// Seconds the frame time is averaged over, so single hitches don't count
+	UPROPERTY(Config)
+	float SmoothingTime;
+
+	// Lever settings from full quality down
+	UPROPERTY(Config)
+	TArray<FFrameBudgetLevel> Levels;
+
+public:
+
+	// Start at full quality, called by the game mode at BeginPlay. Does nothing in commandlets.
+	void Start();
+
+	// Measure the last frame, change level when needed and keep new pawns and bots on the current level.
+	// Called by the game mode every frame.
+	void Tick(float DeltaTime);
+
+	// Current level, 0 for full quality
+	FORCEINLINE int32 GetLevel() const { return Level; }
+
+	// Averaged game thread frame time and the budget it is held to, in ms
+	FORCEINLINE float GetFrameTime() const { return SmoothedFrameTime; }
+	float GetBudget() const;
+
+	// Level, levers and frame times
+	void PrintReport(FOutputDevice& Ar) const;
+
+private:
+
+	// Change level and apply its levers
+	void SetLevel(int32 NewLevel);
+
+	// Set every lever from the current level
+	void ApplyLevel();
+
+	// Game thread time of the last frame in ms
+	static float GetGameThreadTime(float DeltaTime);
+
+	// Governor Variables
+	bool bStarted;
+	int32 Level;
+	float SmoothedFrameTime;
+	float OverBudgetTime;
+	float UnderBudgetTime;
+
+	// Pawns there were when the levers were last applied, to catch new ones
+	int32 AppliedNumPawns;
+	int32 ActiveBots;
+
+};
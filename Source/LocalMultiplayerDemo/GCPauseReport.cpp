@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GCPauseReport.h"
+#include "LocalMultiplayerDemo.h"
+#include "UObject/UObjectArray.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last GC Pause (ms)"), STAT_LastGCPause, STATGROUP_LocalMultiplayerDemo);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("GC Pauses Over Budget"), STAT_GCPausesOverBudget, STATGROUP_LocalMultiplayerDemo);
+
+static float GGCPauseBudgetMs = 4.f;
+static FAutoConsoleVariableRef CVarGCPauseBudgetMs(
+	TEXT("LocalMultiplayer.GCPauseBudgetMs"),
+	GGCPauseBudgetMs,
+	TEXT("GC pauses longer than this many milliseconds are logged as warnings and counted as over budget"));
+
+static FAutoConsoleCommandWithOutputDevice GGCReportCommand(
+	TEXT("LocalMultiplayer.GCReport"),
+	TEXT("Prints the mean, median, 95th percentile and worst garbage collection pause, and how many went over budget"),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&FGCPauseReport::Print));
+
+// Recent pauses, oldest overwritten first
+static const int32 MaxPauseHistory = 256;
+static TArray<float> GPauseHistoryMs;
+static int32 GNextPause = 0;
+
+static int32 GNumCollections = 0;
+static int32 GNumOverBudget = 0;
+static float GWorstPauseMs = 0.f;
+static double GCollectStartTime = 0.0;
+static double GLastCollectTime = 0.0;
+static float GSecondsBetweenCollections = 0.f;
+
+static FDelegateHandle GPreGarbageCollectHandle;
+static FDelegateHandle GPostGarbageCollectHandle;
+
+void FGCPauseReport::Register()
+{
+	GPauseHistoryMs.Reserve(MaxPauseHistory);
+	GPreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddStatic(&FGCPauseReport::OnPreGarbageCollect);
+	GPostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&FGCPauseReport::OnPostGarbageCollect);
+}
+
+void FGCPauseReport::Unregister()
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(GPreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(GPostGarbageCollectHandle);
+}
+
+void FGCPauseReport::OnPreGarbageCollect()
+{
+	GCollectStartTime = FPlatformTime::Seconds();
+
+	if (GLastCollectTime > 0.0)
+		GSecondsBetweenCollections = (float)(GCollectStartTime - GLastCollectTime);
+
+	GLastCollectTime = GCollectStartTime;
+}
+
+void FGCPauseReport::OnPostGarbageCollect()
+{
+	if (GCollectStartTime <= 0.0)
+		return;
+
+	const float PauseMs = (float)((FPlatformTime::Seconds() - GCollectStartTime) * 1000.0);
+	GCollectStartTime = 0.0;
+
+	if (GPauseHistoryMs.Num() < MaxPauseHistory)
+		GPauseHistoryMs.Add(PauseMs);
+	else
+		GPauseHistoryMs[GNextPause] = PauseMs;
+
+	GNextPause = (GNextPause + 1) % MaxPauseHistory;
+	GNumCollections++;
+	GWorstPauseMs = FMath::Max(GWorstPauseMs, PauseMs);
+
+	SET_FLOAT_STAT(STAT_LastGCPause, PauseMs);
+
+	if (PauseMs > GGCPauseBudgetMs)
+	{
+		GNumOverBudget++;
+		INC_DWORD_STAT(STAT_GCPausesOverBudget);
+
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("GC pause %.2f ms over the %.2f ms budget (%d objects, %.1fs since the last collection)"),
+			PauseMs, GGCPauseBudgetMs, GUObjectArray.GetObjectArrayNumMinusAvailable(), GSecondsBetweenCollections);
+	}
+}
+
+void FGCPauseReport::Print(FOutputDevice& Ar)
+{
+	if (GPauseHistoryMs.Num() == 0)
+	{
+		Ar.Logf(TEXT("No garbage collections yet"));
+		return;
+	}
+
+	TArray<float> SortedPausesMs = GPauseHistoryMs;
+	SortedPausesMs.Sort();
+
+	float TotalMs = 0.f;
+
+	for (float PauseMs : SortedPausesMs)
+		TotalMs += PauseMs;
+
+	const int32 Last = SortedPausesMs.Num() - 1;
+
+	Ar.Logf(TEXT("GC pauses over the last %d of %d collections: mean %.2f ms, median %.2f ms, 95th %.2f ms, worst %.2f ms (worst ever %.2f ms)"),
+		SortedPausesMs.Num(), GNumCollections, TotalMs / SortedPausesMs.Num(),
+		SortedPausesMs[Last / 2], SortedPausesMs[FMath::FloorToInt(Last * 0.95f)], SortedPausesMs[Last], GWorstPauseMs);
+	Ar.Logf(TEXT("%d over the %.2f ms budget, %.1fs between the last two collections, %d objects"),
+		GNumOverBudget, GGCPauseBudgetMs, GSecondsBetweenCollections, GUObjectArray.GetObjectArrayNumMinusAvailable());
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Times every garbage collection's blocking pass (reachability analysis up to the start of the incremental purge).
+// Run "LocalMultiplayer.GCReport" in the console for the spread of pauses against "LocalMultiplayer.GCPauseBudgetMs".
+struct LOCALMULTIPLAYERDEMO_API FGCPauseReport
+{
+	// Hook and unhook the GC delegates, called by the module
+	static void Register();
+	static void Unregister();
+
+	// Pause spread over the recent collections
+	static void Print(FOutputDevice& Ar);
+
+private:
+
+	static void OnPreGarbageCollect();
+	static void OnPostGarbageCollect();
+
+};
@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HitchDetector.h"
+#include "LocalMultiplayerDemo.h"
+#include "PlayerMemoryReport.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/CoreMisc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectArray.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hitches"), STAT_Hitches, STATGROUP_LocalMultiplayerDemo);
+
+static float GHitchThresholdMs = 100.f;
+static FAutoConsoleVariableRef CVarHitchThresholdMs(
+	TEXT("LocalMultiplayer.HitchThresholdMs"),
+	GHitchThresholdMs,
+	TEXT("Frames longer than this many milliseconds write a hitch report to Saved/Profiling/Hitches, 0 to turn reports off"));
+
+static float GHitchDumpCooldown = 10.f;
+static FAutoConsoleVariableRef CVarHitchDumpCooldown(
+	TEXT("LocalMultiplayer.HitchDumpCooldown"),
+	GHitchDumpCooldown,
+	TEXT("Seconds after a hitch report before another is written, so a run of slow frames writes one report"));
+
+static FAutoConsoleCommand GHitchDumpCommand(
+	TEXT("LocalMultiplayer.HitchDump"),
+	TEXT("Writes a hitch report now, with the recent frames' timings, the current gameplay event and the memory state"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FHitchDetector::Dump(TEXT("asked for from the console"));
+	}));
+
+// One frame of the window
+struct FHitchFrame
+{
+	uint64 FrameNumber;
+	float FrameMs;
+	int32 NumObjects;
+	uint32 SectionCycles[(int32)EHitchSection::Num];
+
+	// Bit per event section entered this frame
+	uint32 Events;
+};
+
+// The last WindowFrames frames, GCurrentFrame is the one being filled
+static FHitchFrame GHitchWindow[FHitchDetector::WindowFrames];
+static int32 GCurrentFrame = 0;
+static int32 GNumFrames = 1;
+
+static double GLastEndFrameTime = 0.0;
+static double GLastDumpTime = 0.0;
+static int32 GSkippedHitches = 0;
+
+// Most recent gameplay event, for hitches that come a few frames after it
+static int32 GLastEvent = INDEX_NONE;
+static uint64 GLastEventFrame = 0;
+static double GLastEventTime = 0.0;
+
+static FDelegateHandle GEndFrameHandle;
+
+void FHitchDetector::Register()
+{
+	FMemory::Memzero(GHitchWindow);
+	GEndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&FHitchDetector::OnEndFrame);
+}
+
+void FHitchDetector::Unregister()
+{
+	FCoreDelegates::OnEndFrame.Remove(GEndFrameHandle);
+}
+
+const TCHAR* FHitchDetector::GetSectionName(EHitchSection Section)
+{
+	switch (Section)
+	{
+		case EHitchSection::TriggerUpdate: return TEXT("Trigger Update");
+		case EHitchSection::GameModeManagers: return TEXT("Game Mode Managers");
+		case EHitchSection::WorldChecksum: return TEXT("World Checksum");
+		case EHitchSection::NativeHUDDraw: return TEXT("Native HUD Draw");
+		case EHitchSection::CharacterState: return TEXT("Character State");
+		case EHitchSection::PlayerJoin: return TEXT("Player Join");
+		case EHitchSection::UICreate: return TEXT("UI Create");
+		case EHitchSection::Death: return TEXT("Death");
+		case EHitchSection::Respawn: return TEXT("Respawn");
+		case EHitchSection::RoundReset: return TEXT("Round Reset");
+		default: return TEXT("Unknown");
+	}
+}
+
+#pragma region Collection
+FHitchDetector::FScope::FScope(EHitchSection InSection)
+	: Section(InSection), StartCycles(FPlatformTime::Cycles())
+{
+	if (Section >= EHitchSection::FirstEvent && IsInGameThread())
+	{
+		GHitchWindow[GCurrentFrame].Events |= 1u << (uint32)Section;
+		GLastEvent = (int32)Section;
+		GLastEventFrame = GFrameCounter;
+		GLastEventTime = FPlatformTime::Seconds();
+	}
+}
+
+FHitchDetector::FScope::~FScope()
+{
+	AddSectionCycles(Section, FPlatformTime::Cycles() - StartCycles);
+}
+
+void FHitchDetector::AddSectionCycles(EHitchSection Section, uint32 Cycles)
+{
+	// The window isn't locked, only the game thread writes to it
+	if (IsInGameThread())
+		GHitchWindow[GCurrentFrame].SectionCycles[(int32)Section] += Cycles;
+}
+
+// The game or PIE world being played, NULL in the editor between sessions and in commandlets
+static UWorld* FindGameWorld()
+{
+	if (GEngine == nullptr)
+		return NULL;
+
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		if (Context.World() != nullptr && Context.World()->IsGameWorld())
+			return Context.World();
+	}
+
+	return NULL;
+}
+
+void FHitchDetector::OnEndFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+	FHitchFrame& Frame = GHitchWindow[GCurrentFrame];
+
+	Frame.FrameNumber = GFrameCounter;
+	Frame.FrameMs = GLastEndFrameTime > 0.0 ? (float)((Now - GLastEndFrameTime) * 1000.0) : 0.f;
+	Frame.NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	GLastEndFrameTime = Now;
+
+	// A map load or PIE start is a hitch by design, and reporting it would put the cooldown over the join that follows.
+	// Counted in frames, a load that spans a frame boundary (or a PIE world made mid-frame) is still caught.
+	const bool bLoadedMap = GFrameCounter <= FLocalMultiplayerDemoModule::GetMapLoadFrame() + 1;
+
+	// Only while playing. Editing has slow frames of its own (opening assets, compiling shaders) that aren't ours.
+	if (GHitchThresholdMs > 0.f && Frame.FrameMs > GHitchThresholdMs && !bLoadedMap && !IsRunningCommandlet() && FindGameWorld() != nullptr)
+	{
+		INC_DWORD_STAT(STAT_Hitches);
+
+		if (Now - GLastDumpTime >= GHitchDumpCooldown)
+		{
+			Dump(*FString::Printf(TEXT("frame took %.1f ms, over the %.1f ms threshold"), Frame.FrameMs, GHitchThresholdMs));
+
+			// Writing the report isn't part of the next frame
+			GLastEndFrameTime = FPlatformTime::Seconds();
+		}
+		else
+		{
+			GSkippedHitches++;
+		}
+	}
+
+	GCurrentFrame = (GCurrentFrame + 1) % WindowFrames;
+	GNumFrames = FMath::Min(GNumFrames + 1, (int32)WindowFrames);
+	FMemory::Memzero(GHitchWindow[GCurrentFrame]);
+}
+#pragma endregion
+
+#pragma region Report
+// Names of the events in a frame's bits
+static FString GetEventNames(uint32 Events, const TCHAR* Separator)
+{
+	TArray<FString> EventNames;
+
+	for (int32 Section = (int32)EHitchSection::FirstEvent; Section < (int32)EHitchSection::Num; ++Section)
+	{
+		if (Events & (1u << Section))
+			EventNames.Add(FHitchDetector::GetSectionName((EHitchSection)Section));
+	}
+
+	return FString::Join(EventNames, Separator);
+}
+
+FString FHitchDetector::Dump(const TCHAR* Reason)
+{
+	GLastDumpTime = FPlatformTime::Seconds();
+
+	class UWorld* World = FindGameWorld();
+
+	const FString MapName = World ? UGameplayStatics::GetCurrentLevelName(World, true) : TEXT("NoMap");
+	const FString Filename = FPaths::ProfilingDir() / TEXT("Hitches") / FString::Printf(TEXT("Hitch-%s-%s.txt"),
+		*MapName, *FDateTime::Now().ToString(TEXT("%Y.%m.%d-%H.%M.%S.%s")));
+
+	FStringOutputDevice Report;
+	Report.SetAutoEmitLineTerminator(true);
+
+	Report.Logf(TEXT("Hitch on %s at frame %llu: %s"), *MapName, GFrameCounter, Reason);
+
+	if (GSkippedHitches > 0)
+		Report.Logf(TEXT("%d more hitches since the last report went unreported (LocalMultiplayer.HitchDumpCooldown)"), GSkippedHitches);
+
+	GSkippedHitches = 0;
+
+	// What gameplay was doing
+	const uint32 FrameEvents = GHitchWindow[GCurrentFrame].Events;
+
+	if (FrameEvents != 0)
+	{
+		Report.Logf(TEXT("Event: %s, in this frame"), *GetEventNames(FrameEvents, TEXT(", ")));
+	}
+	else if (GLastEvent != INDEX_NONE)
+	{
+		Report.Logf(TEXT("Event: none this frame, the last was %s %llu frames (%.2f s) before"),
+			GetSectionName((EHitchSection)GLastEvent), GFrameCounter - GLastEventFrame, GLastDumpTime - GLastEventTime);
+	}
+	else
+	{
+		Report.Logf(TEXT("Event: none yet"));
+	}
+
+	// Memory state, process-wide then per local player
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+
+	Report.Logf(TEXT("Memory: %.1f MB used physical (peak %.1f MB), %.1f MB used virtual, %.1f MB physical available, %d objects"),
+		MemoryStats.UsedPhysical / 1048576.f, MemoryStats.PeakUsedPhysical / 1048576.f, MemoryStats.UsedVirtual / 1048576.f,
+		MemoryStats.AvailablePhysical / 1048576.f, GUObjectArray.GetObjectArrayNumMinusAvailable());
+
+	if (World != nullptr)
+		FPlayerMemoryReport::Print(World, Report);
+
+	// The window, oldest first, ending with this frame. Section times are game thread ms.
+	FString Header = TEXT("Frame,Frame ms");
+
+	for (int32 Section = 0; Section < (int32)EHitchSection::Num; ++Section)
+		Header += FString::Printf(TEXT(",%s"), GetSectionName((EHitchSection)Section));
+
+	Report.Logf(TEXT(""));
+	Report.Logf(TEXT("%s,Objects,Events"), *Header);
+
+	for (int32 Index = GNumFrames - 1; Index >= 0; --Index)
+	{
+		const FHitchFrame& Frame = GHitchWindow[(GCurrentFrame - Index + WindowFrames) % WindowFrames];
+
+		// This frame hasn't ended yet when the report is asked for from the console
+		FString Row = FString::Printf(TEXT("%llu,%.2f"), Index == 0 ? GFrameCounter : Frame.FrameNumber, Frame.FrameMs);
+
+		for (int32 Section = 0; Section < (int32)EHitchSection::Num; ++Section)
+			Row += FString::Printf(TEXT(",%.3f"), FPlatformTime::ToMilliseconds(Frame.SectionCycles[Section]));
+
+		Report.Logf(TEXT("%s,%d,%s"), *Row, Frame.NumObjects, *GetEventNames(Frame.Events, TEXT(" + ")));
+	}
+
+	if (!FFileHelper::SaveStringToFile(Report, *Filename))
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Hitch (%s), couldn't write %s"), Reason, *Filename);
+		return FString();
+	}
+
+	UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Hitch (%s), report in %s"), Reason, *Filename);
+	return Filename;
+}
+#pragma endregion
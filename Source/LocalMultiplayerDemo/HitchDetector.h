@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// This module's timed work, in the order the hitch detector reports it. The sections from PlayerJoin on are also
+// gameplay events, so a hitch report can say what was happening as well as how long each part took.
+enum class EHitchSection : uint8
+{
+	TriggerUpdate,
+	GameModeManagers,
+	WorldChecksum,
+	NativeHUDDraw,
+	CharacterState,
+	PlayerJoin,
+	UICreate,
+	Death,
+	Respawn,
+	RoundReset,
+
+	Num,
+	FirstEvent = PlayerJoin
+};
+
+// SCOPE_CYCLE_COUNTER that also adds its time to the hitch detector's current frame (and marks the event, if it is one)
+#define SCOPE_HITCH_CYCLE_COUNTER(Stat, Section) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	FHitchDetector::FScope PREPROCESSOR_JOIN(HitchScope_, __LINE__)(Section)
+
+// Keeps the last WindowFrames frames of this module's section timings and events, whether or not stats are running.
+// When a frame takes longer than "LocalMultiplayer.HitchThresholdMs" it writes that window, the event the frame was
+// in (or the last one before it) and the memory state to Saved/Profiling/Hitches. "LocalMultiplayer.HitchDump" writes
+// one on demand. Timing a section costs two cycle reads, and a frame without a hitch one compare.
+struct LOCALMULTIPLAYERDEMO_API FHitchDetector
+{
+	static const int32 WindowFrames = 120;
+
+	// Hook and unhook the end of frame, called by the module
+	static void Register();
+	static void Unregister();
+
+	// Add game thread time to a section of the current frame
+	static void AddSectionCycles(EHitchSection Section, uint32 Cycles);
+
+	// Write the window and memory state now. Returns the file written, empty if it couldn't be.
+	static FString Dump(const TCHAR* Reason);
+
+	// Times a section from construction to destruction
+	struct FScope
+	{
+		FScope(EHitchSection InSection);
+		~FScope();
+
+	private:
+
+		EHitchSection Section;
+		uint32 StartCycles;
+	};
+
+	// Section as shown in reports, e.g. "Player Join"
+	static const TCHAR* GetSectionName(EHitchSection Section);
+
+private:
+
+	static void OnEndFrame();
+
+};
@@ -0,0 +1,238 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InputLatencyTracker.h"
+#include "LocalMultiplayerDemo.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "RenderingThread.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 0 Input Latency Avg (ms)"), STAT_InputLatencyAvg_0, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 0 Input Latency P95 (ms)"), STAT_InputLatencyP95_0, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 1 Input Latency Avg (ms)"), STAT_InputLatencyAvg_1, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 1 Input Latency P95 (ms)"), STAT_InputLatencyP95_1, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 2 Input Latency Avg (ms)"), STAT_InputLatencyAvg_2, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 2 Input Latency P95 (ms)"), STAT_InputLatencyP95_2, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 3 Input Latency Avg (ms)"), STAT_InputLatencyAvg_3, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Player 3 Input Latency P95 (ms)"), STAT_InputLatencyP95_3, STATGROUP_LocalMultiplayerDemo);
+
+const float FInputLatencyTracker::BucketMs = 2.f;
+
+static int32 GInputLatencyEnabled = 0;
+static FAutoConsoleVariableRef CVarInputLatencyEnabled(
+	TEXT("LocalMultiplayer.InputLatency"),
+	GInputLatencyEnabled,
+	TEXT("Record input to rendered frame latency per controller (0 = off, 1 = on)"));
+
+static FAutoConsoleCommand GInputLatencyExportCommand(
+	TEXT("LocalMultiplayer.InputLatency.Export"),
+	TEXT("Writes the per controller input latency histograms to the profiling directory"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		const FString Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("InputLatency-%s.csv"), *FDateTime::Now().ToString());
+		FInputLatencyTracker::Get().ExportCSV(Filename);
+	}));
+
+static FAutoConsoleCommand GInputLatencyResetCommand(
+	TEXT("LocalMultiplayer.InputLatency.Reset"),
+	TEXT("Clears the per controller input latency histograms"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FInputLatencyTracker::Get().Reset();
+	}));
+
+FInputLatencyTracker& FInputLatencyTracker::Get()
+{
+	static FInputLatencyTracker Tracker;
+	return Tracker;
+}
+
+bool FInputLatencyTracker::IsEnabled()
+{
+	return GInputLatencyEnabled != 0;
+}
+
+FInputLatencyTracker::FInputLatencyTracker()
+{
+	FMemory::Memzero(Histograms);
+	FMemory::Memzero(PendingInputCycles);
+	FMemory::Memzero(AppliedInputCycles);
+}
+
+void FInputLatencyTracker::Register()
+{
+	FInputLatencyTracker& Tracker = Get();
+	Tracker.EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(&Tracker, &FInputLatencyTracker::OnEndFrame);
+}
+
+void FInputLatencyTracker::Unregister()
+{
+	FInputLatencyTracker& Tracker = Get();
+
+	if (!Tracker.EndFrameHandle.IsValid())
+		return;
+
+	FCoreDelegates::OnEndFrame.Remove(Tracker.EndFrameHandle);
+	Tracker.EndFrameHandle.Reset();
+
+	// Render commands already queued call back into this module
+	FlushRenderingCommands();
+}
+
+void FInputLatencyTracker::MarkInput(int32 ControllerIndex)
+{
+	// Keep the oldest unapplied input, that's the one the player has waited longest for
+	if (ControllerIndex >= 0 && ControllerIndex < MaxControllers && PendingInputCycles[ControllerIndex] == 0)
+		PendingInputCycles[ControllerIndex] = FPlatformTime::Cycles64();
+}
+
+void FInputLatencyTracker::MarkApplied(int32 ControllerIndex)
+{
+	if (ControllerIndex >= 0 && ControllerIndex < MaxControllers && PendingInputCycles[ControllerIndex] != 0)
+	{
+		if (AppliedInputCycles[ControllerIndex] == 0)
+			AppliedInputCycles[ControllerIndex] = PendingInputCycles[ControllerIndex];
+
+		PendingInputCycles[ControllerIndex] = 0;
+	}
+}
+
+void FInputLatencyTracker::OnEndFrame()
+{
+	if (!IsEnabled())
+		return;
+
+	struct FAppliedInputs
+	{
+		uint64 Cycles[MaxControllers];
+	};
+
+	FAppliedInputs Applied;
+	bool bAnyApplied = false;
+
+	for (int32 i = 0; i < MaxControllers; ++i)
+	{
+		Applied.Cycles[i] = AppliedInputCycles[i];
+		bAnyApplied |= (AppliedInputCycles[i] != 0);
+		AppliedInputCycles[i] = 0;
+	}
+
+	// The frame's motion is rendered once the render thread reaches this point in its queue
+	if (bAnyApplied)
+	{
+		ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+			RecordInputLatency,
+			FAppliedInputs, Inputs, Applied,
+			{
+				FInputLatencyTracker::Get().RecordOnRenderThread(Inputs.Cycles);
+			});
+	}
+
+#if STATS
+	SET_FLOAT_STAT(STAT_InputLatencyAvg_0, GetAverageMs(0));
+	SET_FLOAT_STAT(STAT_InputLatencyP95_0, GetPercentileMs(0, 0.95f));
+	SET_FLOAT_STAT(STAT_InputLatencyAvg_1, GetAverageMs(1));
+	SET_FLOAT_STAT(STAT_InputLatencyP95_1, GetPercentileMs(1, 0.95f));
+	SET_FLOAT_STAT(STAT_InputLatencyAvg_2, GetAverageMs(2));
+	SET_FLOAT_STAT(STAT_InputLatencyP95_2, GetPercentileMs(2, 0.95f));
+	SET_FLOAT_STAT(STAT_InputLatencyAvg_3, GetAverageMs(3));
+	SET_FLOAT_STAT(STAT_InputLatencyP95_3, GetPercentileMs(3, 0.95f));
+#endif
+}
+
+void FInputLatencyTracker::RecordOnRenderThread(const uint64* InputCycles)
+{
+	const uint64 Now = FPlatformTime::Cycles64();
+
+	FScopeLock Lock(&HistogramLock);
+
+	for (int32 i = 0; i < MaxControllers; ++i)
+	{
+		if (InputCycles[i] == 0)
+			continue;
+
+		const float LatencyMs = FPlatformTime::ToMilliseconds64(Now - InputCycles[i]);
+		const int32 Bucket = FMath::Min(FMath::FloorToInt(LatencyMs / BucketMs), (int32)NumBuckets);
+
+		FHistogram& Histogram = Histograms[i];
+		Histogram.Buckets[Bucket]++;
+		Histogram.Count++;
+		Histogram.SumMs += LatencyMs;
+		Histogram.MaxMs = FMath::Max(Histogram.MaxMs, LatencyMs);
+	}
+}
+
+void FInputLatencyTracker::Reset()
+{
+	FScopeLock Lock(&HistogramLock);
+	FMemory::Memzero(Histograms);
+}
+
+float FInputLatencyTracker::GetAverageMs(int32 ControllerIndex) const
+{
+	FScopeLock Lock(&HistogramLock);
+	const FHistogram& Histogram = Histograms[ControllerIndex];
+
+	return Histogram.Count > 0 ? (float)(Histogram.SumMs / Histogram.Count) : 0.f;
+}
+
+float FInputLatencyTracker::GetPercentileMs(int32 ControllerIndex, float Percentile) const
+{
+	FScopeLock Lock(&HistogramLock);
+	return GetPercentileMs_Locked(ControllerIndex, Percentile);
+}
+
+float FInputLatencyTracker::GetPercentileMs_Locked(int32 ControllerIndex, float Percentile) const
+{
+	const FHistogram& Histogram = Histograms[ControllerIndex];
+
+	if (Histogram.Count == 0)
+		return 0.f;
+
+	// Upper edge of the bucket the percentile falls in
+	const uint32 Target = FMath::CeilToInt(Histogram.Count * Percentile);
+	uint32 Running = 0;
+
+	for (int32 Bucket = 0; Bucket <= NumBuckets; ++Bucket)
+	{
+		Running += Histogram.Buckets[Bucket];
+
+		if (Running >= Target)
+			return Bucket < NumBuckets ? (Bucket + 1) * BucketMs : Histogram.MaxMs;
+	}
+
+	return Histogram.MaxMs;
+}
+
+bool FInputLatencyTracker::ExportCSV(const FString& Filename) const
+{
+	FString Csv = TEXT("Controller,Samples,AvgMs,P50Ms,P95Ms,P99Ms,MaxMs");
+
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		Csv += FString::Printf(TEXT(",<%gms"), (Bucket + 1) * BucketMs);
+
+	Csv += FString::Printf(TEXT(",>=%gms\n"), NumBuckets * BucketMs);
+
+	{
+		FScopeLock Lock(&HistogramLock);
+
+		for (int32 i = 0; i < MaxControllers; ++i)
+		{
+			const FHistogram& Histogram = Histograms[i];
+
+			Csv += FString::Printf(TEXT("%d,%u,%.3f,%.3f,%.3f,%.3f,%.3f"), i, Histogram.Count,
+				Histogram.Count > 0 ? Histogram.SumMs / Histogram.Count : 0.0,
+				GetPercentileMs_Locked(i, 0.5f), GetPercentileMs_Locked(i, 0.95f), GetPercentileMs_Locked(i, 0.99f), Histogram.MaxMs);
+
+			for (int32 Bucket = 0; Bucket <= NumBuckets; ++Bucket)
+				Csv += FString::Printf(TEXT(",%u"), Histogram.Buckets[Bucket]);
+
+			Csv += TEXT("\n");
+		}
+	}
+
+	const bool bSaved = FFileHelper::SaveStringToFile(Csv, *Filename);
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Input latency %s %s"), bSaved ? TEXT("written to") : TEXT("could not be written to"), *Filename);
+
+	return bSaved;
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+// Measures the time from an axis input being processed to the render thread picking up the frame it moved the
+// character in, as a histogram per controller. Enable with "LocalMultiplayer.InputLatency 1".
+// Stats are in STATGROUP_LocalMultiplayerDemo, "LocalMultiplayer.InputLatency.Export" writes a CSV to the profiling dir.
+class LOCALMULTIPLAYERDEMO_API FInputLatencyTracker
+{
+public:
+
+	static const int32 MaxControllers = 4;
+	static const int32 NumBuckets = 100;
+
+	// Width of one histogram bucket in ms. The last bucket collects everything above NumBuckets * BucketMs.
+	static const float BucketMs;
+
+	static FInputLatencyTracker& Get();
+
+	// Hook and unhook the end of frame, called by the module
+	static void Register();
+	static void Unregister();
+
+	static bool IsEnabled();
+
+	// An axis event with a non-zero value arrived for this controller
+	void MarkInput(int32 ControllerIndex);
+
+	// The input from MarkInput has been handed to movement/rotation and will be in this frame
+	void MarkApplied(int32 ControllerIndex);
+
+	void Reset();
+
+	// Summary and histogram for each controller as one CSV row each
+	bool ExportCSV(const FString& Filename) const;
+
+	float GetAverageMs(int32 ControllerIndex) const;
+	float GetPercentileMs(int32 ControllerIndex, float Percentile) const;
+
+private:
+
+	FInputLatencyTracker();
+
+	void OnEndFrame();
+
+	FDelegateHandle EndFrameHandle;
+
+public:
+
+	// Called from the render command enqueued at the end of each frame
+	void RecordOnRenderThread(const uint64* InputCycles);
+
+private:
+
+	struct FHistogram
+	{
+		uint32 Buckets[NumBuckets + 1];
+		uint32 Count;
+		double SumMs;
+		float MaxMs;
+	};
+
+	// Written by the render thread, read by the game thread
+	FHistogram Histograms[MaxControllers];
+	mutable FCriticalSection HistogramLock;
+
+	// Game thread only. Cycle count of the oldest input not yet applied/rendered, 0 if none.
+	uint64 PendingInputCycles[MaxControllers];
+	uint64 AppliedInputCycles[MaxControllers];
+
+	float GetPercentileMs_Locked(int32 ControllerIndex, float Percentile) const;
+
+};
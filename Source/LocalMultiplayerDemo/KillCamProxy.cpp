@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "KillCamProxy.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocomotionAnimInstance.h"
+#include "GameFramework/Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Camera/CameraTypes.h"
+
+// Run variables of the characters' AnimBPs, as AP1_Character and AP2_Character set them
+static const FName HorizontalAnimName("Horizontal");
+static const FName VerticalAnimName("Vertical");
+
+// Sets default values
+AKillCamProxy::AKillCamProxy()
+{
+	// Placed from the recorder's tick, so the actor itself never ticks
+	PrimaryActorTick.bCanEverTick = false;
+
+	ProxyRoot = CreateDefaultSubobject<USceneComponent>(TEXT("ProxyRoot"));
+	RootComponent = ProxyRoot;
+
+	ProxyMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ProxyMesh"));
+	ProxyMesh->SetupAttachment(ProxyRoot);
+	ProxyMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ProxyMesh->bGenerateOverlapEvents = false;
+	ProxyMesh->CastShadow = false;
+	ProxyMesh->SetOnlyOwnerSee(true); // Owned by the proxy being watched, see UKillCamRecorder::StartPlayback
+	ProxyMesh->MeshComponentUpdateFlag = EMeshComponentUpdateFlag::OnlyTickPoseWhenRendered;
+	ProxyMesh->PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	bReplicates = false;
+	bCanBeInCluster = true;
+
+	// Default Values for Variables
+	CameraDistance = 350.f;
+	CameraHeight = 150.f;
+	ForwardAnimProp = NULL;
+	RightAnimProp = NULL;
+
+	// Shown by the recorder while a kill-cam plays
+	bHidden = true;
+}
+
+void AKillCamProxy::CopyAppearance(const ACharacter* Character)
+{
+	const class USkeletalMeshComponent* SourceMesh = Character ? Character->GetMesh() : NULL;
+
+	if (SourceMesh == nullptr)
+		return;
+
+	// Only reinitialise the anim instance when the character is different from last time
+	if (ProxyMesh->SkeletalMesh != SourceMesh->SkeletalMesh)
+		ProxyMesh->SetSkeletalMesh(SourceMesh->SkeletalMesh);
+
+	if (ProxyMesh->AnimClass != SourceMesh->AnimClass)
+	{
+		ProxyMesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
+		ProxyMesh->SetAnimInstanceClass(SourceMesh->AnimClass);
+
+		// Like the characters, an AnimBP without the native parent is driven through its own variables
+		const bool bLocomotionAnim = SourceMesh->AnimClass && SourceMesh->AnimClass->IsChildOf(ULocomotionAnimInstance::StaticClass());
+		ForwardAnimProp = (SourceMesh->AnimClass && !bLocomotionAnim) ? FindField<UFloatProperty>(SourceMesh->AnimClass, HorizontalAnimName) : NULL;
+		RightAnimProp = (SourceMesh->AnimClass && !bLocomotionAnim) ? FindField<UFloatProperty>(SourceMesh->AnimClass, VerticalAnimName) : NULL;
+	}
+
+	// The recorded location is the capsule's, so sit the mesh where the character's does
+	ProxyMesh->SetRelativeTransform(SourceMesh->GetRelativeTransform());
+}
+
+void AKillCamProxy::ApplySample(const FVector& Location, float Yaw, float Forward, float Right, ECharacterStance Stance)
+{
+	SetActorLocationAndRotation(Location, FRotator(0.f, Yaw, 0.f));
+
+	class UAnimInstance* AnimInstance = ProxyMesh->GetAnimInstance();
+
+	if (class ULocomotionAnimInstance* LocomotionAnim = Cast<ULocomotionAnimInstance>(AnimInstance))
+	{
+		LocomotionAnim->SetLocomotionInput(Stance, Forward, Right);
+	}
+	else if (AnimInstance != nullptr)
+	{
+		// The old AnimBPs only stand, so the stance has nowhere to go
+		if (ForwardAnimProp)
+			ForwardAnimProp->SetPropertyValue_InContainer(AnimInstance, Forward);
+
+		if (RightAnimProp)
+			RightAnimProp->SetPropertyValue_InContainer(AnimInstance, Right);
+	}
+}
+
+void AKillCamProxy::SetShown(bool bShown)
+{
+	SetActorHiddenInGame(!bShown);
+	ProxyMesh->SetComponentTickEnabled(bShown);
+}
+
+// Behind and above the proxy, looking down at it
+void AKillCamProxy::CalcCamera(float DeltaTime, FMinimalViewInfo& OutResult)
+{
+	const FVector Target = GetActorLocation();
+
+	OutResult.Location = Target - GetActorForwardVector() * CameraDistance + FVector(0.f, 0.f, CameraHeight);
+	OutResult.Rotation = (Target - OutResult.Location).Rotation();
+	OutResult.FOV = 90.f;
+}
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CharacterStance.h"
+#include "KillCamProxy.generated.h"
+
+// Stand-in for a character during a kill-cam. Just a skeletal mesh placed from recorded samples: no collision,
+// movement or input, and only seen by the player watching the kill-cam. Pooled and reused by UKillCamRecorder.
+UCLASS(NotPlaceable, Transient)
+class LOCALMULTIPLAYERDEMO_API AKillCamProxy : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values for this actor's properties
+	AKillCamProxy();
+
+	// Look like this character: same mesh, AnimBP and mesh offset
+	void CopyAppearance(const class ACharacter* Character);
+
+	// Move to a recorded pose and pass its run input and stance to the anim instance
+	void ApplySample(const FVector& Location, float Yaw, float Forward, float Right, ECharacterStance Stance);
+
+	// Show or hide the proxy. Hidden proxies don't tick or animate.
+	void SetShown(bool bShown);
+
+	// Chase camera for the player watching, when the proxy is the view target
+	virtual void CalcCamera(float DeltaTime, struct FMinimalViewInfo& OutResult) override;
+
+	// Root at the recorded capsule location, with the mesh offset from it like the character's
+	UPROPERTY(VisibleAnywhere, Category = "Kill Cam")
+	class USceneComponent* ProxyRoot;
+
+	UPROPERTY(VisibleAnywhere, Category = "Kill Cam")
+	class USkeletalMeshComponent* ProxyMesh;
+
+	// Chase Camera Variables
+	UPROPERTY(EditAnywhere, Category = "Kill Cam")
+	float CameraDistance;
+
+	UPROPERTY(EditAnywhere, Category = "Kill Cam")
+	float CameraHeight;
+
+private:
+
+	// Run variables of an AnimBP that isn't parented to ULocomotionAnimInstance, found once per anim class
+	class UFloatProperty* ForwardAnimProp;
+	class UFloatProperty* RightAnimProp;
+
+};
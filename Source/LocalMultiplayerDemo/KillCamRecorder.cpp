@@ -0,0 +1,444 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "KillCamRecorder.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "KillCamProxy.h"
+#include "P1_Character.h"
+#include "P2_Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_MEMORY_STAT(TEXT("Kill Cam Buffers"), STAT_KillCamMemory, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Kill Cam Record Cost (us per character per second)"), STAT_KillCamRecordCost, STATGROUP_LocalMultiplayerDemo);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GKillCamReportCommand(
+	TEXT("LocalMultiplayer.KillCamReport"),
+	TEXT("Prints the kill-cam recorder's buffer sizes, memory per character per second and recording cost"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (const class UKillCamRecorder* Recorder = UKillCamRecorder::Get(World))
+			Recorder->PrintReport(Ar);
+		else
+			Ar.Logf(TEXT("No kill-cam recorder on this world (it only runs on the server)"));
+	}));
+
+static_assert(sizeof(FKillCamSample) == 12, "Kill-cam samples are sized for the memory cap, keep them packed");
+
+const float FKillCamSample::LocationStep = 2.f;
+
+UKillCamRecorder::UKillCamRecorder()
+{
+	KillCamSeconds = 5.f;
+	RecordRate = 30.f;
+	MaxCharacters = 8;
+	MaxMemoryKB = 64;
+
+	// Default Values for Variables
+	FrameCapacity = 0;
+	SampleRate = RecordRate;
+	NextFrame = 0;
+	NumFrames = 0;
+	TimeToNextFrame = 0.f;
+	ClipFrames = 0;
+	ClipFrame = 0;
+	ClipTime = 0.f;
+	ClipEndTime = 0.f;
+	VictimChannel = INDEX_NONE;
+	RecordCycles = 0;
+	RecordedSamples = 0;
+	bWarnedChannelsFull = false;
+}
+
+UKillCamRecorder* UKillCamRecorder::Get(const UObject* WorldContextObject)
+{
+	class UWorld* const world = WorldContextObject ? WorldContextObject->GetWorld() : NULL;
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	return GameMode ? GameMode->KillCamRecorder : NULL;
+}
+
+#pragma region Recording
+void UKillCamRecorder::Start()
+{
+	if (GetWorld() == nullptr || IsRunningDedicatedServer() || IsRunningCommandlet() || IsRecording())
+		return;
+
+	MaxCharacters = FMath::Clamp(MaxCharacters, 1, 64);
+	RecordRate = FMath::Max(RecordRate, 1.f);
+	SampleRate = FMath::Min(SampleRate, RecordRate);
+
+	// The playback clip is a copy of the ring, so the cap covers two of everything
+	const int32 BytesPerFrame = MaxCharacters * sizeof(FKillCamSample) + sizeof(float);
+	const int32 FramesInCap = (FMath::Max(MaxMemoryKB, 0) * 1024) / (2 * BytesPerFrame);
+	const int32 FramesWanted = FMath::CeilToInt(KillCamSeconds * RecordRate) + 1;
+
+	FrameCapacity = FMath::Min(FramesWanted, FramesInCap);
+
+	if (FrameCapacity < 2)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Kill cam: MaxMemoryKB=%d is too small to record %d characters, kill-cams are off"), MaxMemoryKB, MaxCharacters);
+		FrameCapacity = 0;
+		return;
+	}
+
+	// Everything recording and playback touch is allocated here and never resized
+	Samples.SetNumZeroed(FrameCapacity * MaxCharacters);
+	FrameTimes.SetNumZeroed(FrameCapacity);
+	Channels.SetNum(MaxCharacters);
+	ClipSamples.SetNumZeroed(FrameCapacity * MaxCharacters);
+	ClipTimes.SetNumZeroed(FrameCapacity);
+	ClipChannels.SetNum(MaxCharacters);
+	HiddenFromViewer.Reserve(MaxCharacters);
+	Proxies.SetNumZeroed(MaxCharacters);
+
+	const SIZE_T BufferBytes = Samples.GetAllocatedSize() + FrameTimes.GetAllocatedSize() + ClipSamples.GetAllocatedSize() + ClipTimes.GetAllocatedSize();
+	SET_MEMORY_STAT(STAT_KillCamMemory, BufferBytes);
+
+	if (FrameCapacity < FramesWanted)
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Kill cam: MaxMemoryKB=%d only fits %.1f of the %.1f seconds asked for"), MaxMemoryKB, (FrameCapacity - 1) / RecordRate, KillCamSeconds);
+
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Kill cam: %d frames (%.1f s at %.0f Hz) for up to %d characters in %.1f KB, %.0f bytes per character per second"),
+		FrameCapacity, (FrameCapacity - 1) / RecordRate, RecordRate, MaxCharacters, BufferBytes / 1024.f, GetBytesPerCharacterSecond());
+}
+
+void UKillCamRecorder::Tick(float DeltaTime)
+{
+	if (!IsRecording())
+		return;
+
+	TimeToNextFrame -= DeltaTime;
+
+	if (TimeToNextFrame <= 0.f)
+	{
+		RecordFrame(GetWorld()->GetTimeSeconds());
+
+		// Don't try to catch up after a hitch, just record the next frame on time
+		TimeToNextFrame = FMath::Max(TimeToNextFrame + 1.f / SampleRate, 0.f);
+	}
+
+	if (PlaybackViewer.IsValid() || PlaybackVictim.IsValid())
+		UpdatePlayback(DeltaTime);
+}
+
+void UKillCamRecorder::SetSampleRate(float Rate)
+{
+	SampleRate = FMath::Clamp(Rate, 1.f, RecordRate);
+}
+
+void UKillCamRecorder::ClearHistory()
+{
+	NextFrame = 0;
+	NumFrames = 0;
+	TimeToNextFrame = 0.f;
+}
+
+void UKillCamRecorder::RecordFrame(float Time)
+{
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	FKillCamSample* Frame = &Samples[NextFrame * MaxCharacters];
+	int32 Recorded = 0;
+
+	// Channels nobody fills this frame aren't drawn at this point of a replay
+	for (int32 Channel = 0; Channel < MaxCharacters; ++Channel)
+		Frame[Channel].Flags = 0;
+
+	for (FConstPawnIterator Iterator = GetWorld()->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		class APawn* Pawn = Iterator->Get();
+
+		if (Pawn == nullptr || !Pawn->IsA<ACharacter>())
+			continue;
+
+		const int32 Channel = FindChannel(Pawn);
+
+		if (Channel == INDEX_NONE)
+			continue;
+
+		Quantize(Pawn, Frame[Channel]);
+		Recorded++;
+	}
+
+	FrameTimes[NextFrame] = Time;
+	NextFrame = (NextFrame + 1) % FrameCapacity;
+	NumFrames = FMath::Min(NumFrames + 1, FrameCapacity);
+
+	RecordCycles += FPlatformTime::Cycles() - StartCycles;
+	RecordedSamples += Recorded;
+
+	if (RecordedSamples > 0)
+		SET_FLOAT_STAT(STAT_KillCamRecordCost, (float)(RecordCycles * FPlatformTime::GetSecondsPerCycle() * 1000000.0 / RecordedSamples * SampleRate));
+}
+
+int32 UKillCamRecorder::FindChannel(APawn* Pawn)
+{
+	int32 FreeChannel = INDEX_NONE;
+
+	for (int32 Channel = 0; Channel < MaxCharacters; ++Channel)
+	{
+		if (Channels[Channel].Get() == Pawn)
+			return Channel;
+
+		if (FreeChannel == INDEX_NONE && !Channels[Channel].IsValid())
+			FreeChannel = Channel;
+	}
+
+	if (FreeChannel == INDEX_NONE)
+	{
+		if (!bWarnedChannelsFull)
+		{
+			bWarnedChannelsFull = true;
+			UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Kill cam: more than MaxCharacters=%d characters, the rest aren't recorded"), MaxCharacters);
+		}
+
+		return INDEX_NONE;
+	}
+
+	// The channel's history belongs to a character that has gone, so don't replay it as this one
+	for (int32 FrameIndex = 0; FrameIndex < FrameCapacity; ++FrameIndex)
+		Samples[FrameIndex * MaxCharacters + FreeChannel].Flags = 0;
+
+	Channels[FreeChannel] = Pawn;
+	return FreeChannel;
+}
+
+void UKillCamRecorder::Quantize(const APawn* Pawn, FKillCamSample& OutSample)
+{
+	const FVector Location = Pawn->GetActorLocation() / FKillCamSample::LocationStep;
+	const FRotator Rotation = Pawn->GetActorRotation();
+
+	OutSample.X = (int16)FMath::Clamp(FMath::RoundToInt(Location.X), -MAX_int16, (int32)MAX_int16);
+	OutSample.Y = (int16)FMath::Clamp(FMath::RoundToInt(Location.Y), -MAX_int16, (int32)MAX_int16);
+	OutSample.Z = (int16)FMath::Clamp(FMath::RoundToInt(Location.Z), -MAX_int16, (int32)MAX_int16);
+	OutSample.Yaw = FRotator::CompressAxisToShort(Rotation.Yaw);
+
+	// What the run blend space shows, taken from movement so bots and remote players are recorded the same as local ones
+	const class ACharacter* Character = CastChecked<ACharacter>(Pawn);
+	const class UCharacterMovementComponent* CharacterMove = Character->GetCharacterMovement();
+	const float MaxSpeed = CharacterMove ? CharacterMove->GetMaxSpeed() : 0.f;
+	const FVector Velocity = MaxSpeed > 0.f ? Character->GetVelocity() / MaxSpeed : FVector::ZeroVector;
+
+	OutSample.Forward = FReplicatedRunInput::Quantize(FVector::DotProduct(Velocity, Rotation.Vector()));
+	OutSample.Right = FReplicatedRunInput::Quantize(FVector::DotProduct(Velocity, FRotationMatrix(Rotation).GetUnitAxis(EAxis::Y)));
+	OutSample.Stance = (uint8)ECharacterStance::Stand;
+	OutSample.Flags = EKillCamSampleFlags::Recorded;
+
+	if (const class AP1_Character* PlayerOne = Cast<AP1_Character>(Pawn))
+	{
+		OutSample.Stance = (uint8)PlayerOne->Stance;
+	}
+	else if (const class AP2_Character* PlayerTwo = Cast<AP2_Character>(Pawn))
+	{
+		OutSample.Stance = (uint8)PlayerTwo->Stance;
+
+		if (PlayerTwo->isDead)
+			OutSample.Flags |= EKillCamSampleFlags::Dead;
+	}
+}
+
+FVector UKillCamRecorder::GetLocation(const FKillCamSample& Sample)
+{
+	return FVector(Sample.X, Sample.Y, Sample.Z) * FKillCamSample::LocationStep;
+}
+#pragma endregion
+
+#pragma region Playback
+void UKillCamRecorder::StartPlayback(APawn* Victim, APlayerController* Viewer, float Duration)
+{
+	if (!IsRecording() || Victim == nullptr || Viewer == nullptr || !Viewer->IsLocalController() || NumFrames < 2)
+		return;
+
+	// One kill-cam at a time, the newest takes over
+	EndPlayback();
+
+	VictimChannel = Channels.IndexOfByPredicate([Victim](const TWeakObjectPtr<APawn>& Channel) { return Channel.Get() == Victim; });
+
+	if (VictimChannel == INDEX_NONE)
+		return;
+
+	// Copy the ring out oldest frame first, so recording can carry on over it while the clip plays
+	const int32 OldestFrame = (NextFrame - NumFrames + FrameCapacity) % FrameCapacity;
+
+	for (int32 FrameIndex = 0; FrameIndex < NumFrames; ++FrameIndex)
+	{
+		const int32 SourceFrame = (OldestFrame + FrameIndex) % FrameCapacity;
+
+		FMemory::Memcpy(&ClipSamples[FrameIndex * MaxCharacters], &Samples[SourceFrame * MaxCharacters], MaxCharacters * sizeof(FKillCamSample));
+		ClipTimes[FrameIndex] = FrameTimes[SourceFrame];
+	}
+
+	for (int32 Channel = 0; Channel < MaxCharacters; ++Channel)
+		ClipChannels[Channel] = Channels[Channel];
+
+	ClipFrames = NumFrames;
+	ClipFrame = 0;
+	ClipEndTime = ClipTimes[ClipFrames - 1];
+
+	// Play up to the moment of death, starting as far back as there is time for before respawning
+	ClipTime = FMath::Max(ClipTimes[0], ClipEndTime - FMath::Min(Duration, KillCamSeconds));
+
+	class AKillCamProxy* VictimProxy = GetProxy(VictimChannel);
+
+	if (VictimProxy == nullptr)
+		return;
+
+	// Every proxy is owned by the victim's, which the viewer looks at, so only the viewer's split-screen view draws them
+	for (int32 Channel = 0; Channel < MaxCharacters; ++Channel)
+	{
+		class AKillCamProxy* Proxy = ClipChannels[Channel].IsValid() ? GetProxy(Channel) : NULL;
+
+		if (Proxy == nullptr)
+			continue;
+
+		Proxy->CopyAppearance(Cast<ACharacter>(ClipChannels[Channel].Get()));
+		Proxy->SetOwner(Proxy == VictimProxy ? NULL : VictimProxy);
+		Proxy->ProxyMesh->MarkRenderStateDirty();
+	}
+
+	// And the live characters are hidden from that view while it plays
+	for (FConstPawnIterator Iterator = GetWorld()->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		class APawn* Pawn = Iterator->Get();
+
+		if (Pawn != nullptr && Pawn->IsA<ACharacter>())
+		{
+			Viewer->HiddenActors.AddUnique(Pawn);
+			HiddenFromViewer.Add(Pawn);
+		}
+	}
+
+	PlaybackVictim = Victim;
+	PlaybackViewer = Viewer;
+
+	UpdatePlayback(0.f);
+	Viewer->SetViewTarget(VictimProxy);
+}
+
+void UKillCamRecorder::StopPlayback(APawn* Victim)
+{
+	if (Victim != nullptr && PlaybackVictim.Get() == Victim)
+		EndPlayback();
+}
+
+void UKillCamRecorder::EndPlayback()
+{
+	if (class APlayerController* Viewer = PlaybackViewer.Get())
+	{
+		for (const TWeakObjectPtr<AActor>& Hidden : HiddenFromViewer)
+		{
+			if (Hidden.IsValid())
+				Viewer->HiddenActors.Remove(Hidden.Get());
+		}
+
+		if (Viewer->GetPawn() != nullptr)
+			Viewer->SetViewTarget(Viewer->GetPawn());
+	}
+
+	for (class AKillCamProxy* Proxy : Proxies)
+	{
+		if (Proxy != nullptr)
+			Proxy->SetShown(false);
+	}
+
+	HiddenFromViewer.Reset();
+	PlaybackVictim = nullptr;
+	PlaybackViewer = nullptr;
+	VictimChannel = INDEX_NONE;
+}
+
+void UKillCamRecorder::UpdatePlayback(float DeltaTime)
+{
+	if (!PlaybackViewer.IsValid() || !PlaybackVictim.IsValid())
+	{
+		EndPlayback();
+		return;
+	}
+
+	// Hold the moment of death once the clip runs out, until the respawn stops playback
+	ClipTime = FMath::Min(ClipTime + DeltaTime, ClipEndTime);
+
+	while (ClipFrame < ClipFrames - 2 && ClipTimes[ClipFrame + 1] <= ClipTime)
+		ClipFrame++;
+
+	const float FrameStart = ClipTimes[ClipFrame];
+	const float FrameEnd = ClipTimes[ClipFrame + 1];
+	const float Alpha = FrameEnd > FrameStart ? FMath::Clamp((ClipTime - FrameStart) / (FrameEnd - FrameStart), 0.f, 1.f) : 1.f;
+
+	for (int32 Channel = 0; Channel < MaxCharacters; ++Channel)
+	{
+		class AKillCamProxy* Proxy = Proxies[Channel];
+
+		if (Proxy == nullptr)
+			continue;
+
+		const FKillCamSample& From = ClipSamples[ClipFrame * MaxCharacters + Channel];
+		const FKillCamSample& NextSample = ClipSamples[(ClipFrame + 1) * MaxCharacters + Channel];
+		const bool bShown = ClipChannels[Channel].IsValid() && (From.Flags & EKillCamSampleFlags::Recorded) && !(From.Flags & EKillCamSampleFlags::Dead);
+
+		if (bShown == Proxy->bHidden)
+			Proxy->SetShown(bShown);
+
+		if (!bShown)
+			continue;
+
+		// Blend towards the next sample, unless the character wasn't there for it
+		const FKillCamSample& To = (NextSample.Flags & EKillCamSampleFlags::Recorded) ? NextSample : From;
+		const FRotator FromYaw(0.f, FRotator::DecompressAxisFromShort(From.Yaw), 0.f);
+		const FRotator ToYaw(0.f, FRotator::DecompressAxisFromShort(To.Yaw), 0.f);
+
+		Proxy->ApplySample(
+			FMath::Lerp(GetLocation(From), GetLocation(To), Alpha),
+			FMath::Lerp(FromYaw, ToYaw, Alpha).Yaw,
+			FMath::Lerp((float)From.Forward, (float)To.Forward, Alpha) / 127.f,
+			FMath::Lerp((float)From.Right, (float)To.Right, Alpha) / 127.f,
+			(ECharacterStance)From.Stance);
+	}
+}
+
+AKillCamProxy* UKillCamRecorder::GetProxy(int32 Channel)
+{
+	if (Proxies[Channel] == nullptr)
+	{
+		FActorSpawnParameters spawnParams;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		spawnParams.ObjectFlags |= RF_Transient;
+
+		Proxies[Channel] = GetWorld()->SpawnActor<AKillCamProxy>(AKillCamProxy::StaticClass(), FTransform::Identity, spawnParams);
+	}
+
+	return Proxies[Channel];
+}
+#pragma endregion
+
+#pragma region Report
+float UKillCamRecorder::GetBytesPerCharacterSecond() const
+{
+	// Frame times are shared by every character in the frame
+	return (sizeof(FKillCamSample) + (float)sizeof(float) / MaxCharacters) * RecordRate;
+}
+
+void UKillCamRecorder::PrintReport(FOutputDevice& Ar) const
+{
+	if (!IsRecording())
+	{
+		Ar.Logf(TEXT("Kill cam isn't recording (dedicated server, commandlet, or MaxMemoryKB too small)"));
+		return;
+	}
+
+	const SIZE_T RingBytes = Samples.GetAllocatedSize() + FrameTimes.GetAllocatedSize();
+	const SIZE_T ClipBytes = ClipSamples.GetAllocatedSize() + ClipTimes.GetAllocatedSize();
+	const double MicrosecondsPerSample = RecordedSamples > 0 ? RecordCycles * FPlatformTime::GetSecondsPerCycle() * 1000000.0 / RecordedSamples : 0.0;
+
+	Ar.Logf(TEXT("Kill cam: %d of %d frames recorded, %.1f s at %.0f Hz for up to %d characters"),
+		NumFrames, FrameCapacity, (FrameCapacity - 1) / RecordRate, RecordRate, MaxCharacters);
+
+	if (SampleRate < RecordRate)
+		Ar.Logf(TEXT("  Sampling at %.0f Hz for the frame budget governor, %.1f s of history"), SampleRate, (FrameCapacity - 1) / SampleRate);
+
+	Ar.Logf(TEXT("  Memory: %.1f KB of %d KB (ring %.1f KB, playback clip %.1f KB), %d bytes per sample, %.0f bytes per character per second"),
+		(RingBytes + ClipBytes) / 1024.f, MaxMemoryKB, RingBytes / 1024.f, ClipBytes / 1024.f, (int32)sizeof(FKillCamSample), GetBytesPerCharacterSecond());
+	Ar.Logf(TEXT("  Record cost: %.2f us per sample, %.1f us per character per second, over %lld samples"),
+		MicrosecondsPerSample, MicrosecondsPerSample * RecordRate, RecordedSamples);
+}
+#pragma endregion
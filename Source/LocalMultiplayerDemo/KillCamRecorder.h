@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "KillCamRecorder.generated.h"
+
+namespace EKillCamSampleFlags
+{
+	enum Type : uint8
+	{
+		// The channel had a character this frame
+		Recorded = 1,
+
+		// The character was dead and isn't drawn
+		Dead = 2
+	};
+}
+
+// One character in one recorded frame, quantised to 12 bytes
+struct FKillCamSample
+{
+	// Capsule location in 2 cm steps, which covers +-655 m from the world origin
+	int16 X;
+	int16 Y;
+	int16 Z;
+
+	// FRotator::CompressAxisToShort
+	uint16 Yaw;
+
+	// Velocity along and across the facing, -127..127 of the walk speed
+	int8 Forward;
+	int8 Right;
+
+	// ECharacterStance
+	uint8 Stance;
+
+	// EKillCamSampleFlags
+	uint8 Flags;
+
+	static const float LocationStep;
+
+};
+
+// Keeps the last few seconds of every character's transform, run input and stance in a fixed ring buffer, so a player
+// who dies can watch them again while they wait to respawn. The buffers are allocated once in Start, sized from
+// MaxMemoryKB, and recording never allocates. Playback places pooled AKillCamProxy actors from the samples, only seen
+// by the watching player, rather than simulating anything again. Run "LocalMultiplayer.KillCamReport" for its costs.
+// Owned by the game mode, so kill-cams are shown to the server's own local players.
+UCLASS(config = Game)
+class LOCALMULTIPLAYERDEMO_API UKillCamRecorder : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UKillCamRecorder();
+
+	// Recorder of the world this object is in, NULL where there is no game mode (e.g. network clients)
+	static UKillCamRecorder* Get(const UObject* WorldContextObject);
+
+	// Seconds of history to keep and replay
+	UPROPERTY(Config)
+	float KillCamSeconds;
+
+	// Samples per second for each character
+	UPROPERTY(Config)
+	float RecordRate;
+
+	// Most characters recorded at once. Any more aren't shown in kill-cams.
+	UPROPERTY(Config)
+	int32 MaxCharacters;
+
+	// Cap on the recording and playback buffers together. KillCamSeconds is shortened to fit.
+	UPROPERTY(Config)
+	int32 MaxMemoryKB;
+
+public:
+
+	// Allocate the buffers, called by the game mode at BeginPlay. Does nothing on a dedicated server, nobody watches there.
+	void Start();
+
+	// Record a frame when one is due, and move any playback along. Called by the game mode every frame.
+	void Tick(float DeltaTime);
+
+	// Replay the last seconds up to now in the viewer's split-screen view, for at most Duration seconds
+	void StartPlayback(class APawn* Victim, class APlayerController* Viewer, float Duration);
+
+	// Give the viewer its own view back, if it is watching Victim's kill-cam
+	void StopPlayback(class APawn* Victim);
+
+	// Forget what has been recorded, so the next kill-cam doesn't go back into the previous round. Keeps the buffers.
+	void ClearHistory();
+
+	// Record fewer samples a second than RecordRate, e.g. when the frame budget governor needs the time back.
+	// Kill-cams get choppier but go further back, the buffers stay the same size.
+	void SetSampleRate(float Rate);
+
+	// Samples per second being recorded
+	FORCEINLINE float GetSampleRate() const { return SampleRate; }
+
+	// True once Start has allocated the buffers
+	FORCEINLINE bool IsRecording() const { return FrameCapacity > 0; }
+
+	// Memory and cost report
+	void PrintReport(FOutputDevice& Ar) const;
+
+	// Bytes recorded for each character each second
+	float GetBytesPerCharacterSecond() const;
+
+private:
+
+	// Record every character's sample for this frame
+	void RecordFrame(float Time);
+
+	// Channel a pawn is recorded in, assigning a free one if it is new. INDEX_NONE when all are taken.
+	int32 FindChannel(class APawn* Pawn);
+
+	// Place the proxies for the current playback time
+	void UpdatePlayback(float DeltaTime);
+
+	// Put the viewer's view back and hide the proxies
+	void EndPlayback();
+
+	// Proxy for a playback channel, spawned the first time it's needed and then reused
+	class AKillCamProxy* GetProxy(int32 Channel);
+
+	// Quantise and restore a sample
+	static void Quantize(const class APawn* Pawn, FKillCamSample& OutSample);
+	static FVector GetLocation(const FKillCamSample& Sample);
+
+	// Frames that fit, the rest of the buffers are sized from it
+	int32 FrameCapacity;
+
+	// RecordRate, or less while the frame budget governor has it lowered
+	float SampleRate;
+
+	// Ring Buffer Variables. Frame F's samples are Samples[F * MaxCharacters + Channel].
+	TArray<FKillCamSample> Samples;
+	TArray<float> FrameTimes;
+	int32 NextFrame;
+	int32 NumFrames;
+	float TimeToNextFrame;
+	TArray<TWeakObjectPtr<class APawn>> Channels;
+
+	// Playback Variables. The clip is the ring buffer copied out oldest frame first when a kill-cam starts.
+	TArray<FKillCamSample> ClipSamples;
+	TArray<float> ClipTimes;
+	TArray<TWeakObjectPtr<class APawn>> ClipChannels;
+	int32 ClipFrames;
+	int32 ClipFrame;
+	float ClipTime;
+	float ClipEndTime;
+	int32 VictimChannel;
+	TWeakObjectPtr<class APawn> PlaybackVictim;
+	TWeakObjectPtr<class APlayerController> PlaybackViewer;
+
+	// Live pawns hidden from the viewer while it watches
+	TArray<TWeakObjectPtr<class AActor>> HiddenFromViewer;
+
+	UPROPERTY(Transient)
+	TArray<class AKillCamProxy*> Proxies;
+
+	// Record Cost Variables
+	uint64 RecordCycles;
+	int64 RecordedSamples;
+	bool bWarnedChannelsFull;
+
+};
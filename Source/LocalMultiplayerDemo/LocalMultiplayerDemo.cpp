@@ -1,6 +1,99 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "LocalMultiplayerDemo.h"
-#include "Modules/ModuleManager.h"
-
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, LocalMultiplayerDemo, "LocalMultiplayerDemo" );
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocalMultiplayerDemo.h"
+#include "GCPauseReport.h"
+#include "HitchDetector.h"
+#include "InputLatencyTracker.h"
+#include "ArenaRotation.h"
+#include "GameDelegates.h"
+#include "Misc/PackageName.h"
+#include "Engine/World.h"
+#include "Modules/ModuleManager.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY(LogLocalMultiplayerDemo);
+
+// The first map loads before our delegate can fire, so count from process start until then
+double FLocalMultiplayerDemoModule::MapLoadStartTime = 0.0;
+uint64 FLocalMultiplayerDemoModule::MapLoadFrame = 0;
+bool FLocalMultiplayerDemoModule::bMapLoading = false;
+
+static int32 GGameplayDuringPhysics = 1;
+static FAutoConsoleVariableRef CVarGameplayDuringPhysics(
+	TEXT("LocalMultiplayer.GameplayDuringPhysics"),
+	GGameplayDuringPhysics,
+	TEXT("1 runs triggers, scoring, kill-cam recording, arena rotation and the frame budget governor while physics simulates. ")
+	TEXT("0 runs them on the game thread's critical path as before, to compare frame times. Read as a map starts."));
+
+void FLocalMultiplayerDemoModule::StartupModule()
+{
+	MapLoadStartTime = GStartTime;
+	bMapLoading = !GIsEditor;
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddStatic(&FLocalMultiplayerDemoModule::OnPreLoadMap);
+	PostWorldInitializationHandle = FWorldDelegates::OnPostWorldInitialization.AddStatic(&FLocalMultiplayerDemoModule::OnPostWorldInitialization);
+	FGCPauseReport::Register();
+	FHitchDetector::Register();
+	FInputLatencyTracker::Register();
+
+#if WITH_EDITOR
+	FGameDelegates::Get().GetCookModificationDelegate().BindStatic(&FLocalMultiplayerDemoModule::OnCookModification);
+#endif
+}
+
+void FLocalMultiplayerDemoModule::ShutdownModule()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapHandle);
+	FWorldDelegates::OnPostWorldInitialization.Remove(PostWorldInitializationHandle);
+	FGCPauseReport::Unregister();
+	FHitchDetector::Unregister();
+	FInputLatencyTracker::Unregister();
+
+#if WITH_EDITOR
+	FGameDelegates::Get().GetCookModificationDelegate().Unbind();
+#endif
+}
+
+ETickingGroup FLocalMultiplayerDemoModule::GetGameplayTickGroup(ETickingGroup SerialGroup)
+{
+	return GGameplayDuringPhysics ? TG_DuringPhysics : SerialGroup;
+}
+
+void FLocalMultiplayerDemoModule::OnPreLoadMap(const FString& MapName)
+{
+	MapLoadStartTime = FPlatformTime::Seconds();
+	MapLoadFrame = GFrameCounter;
+	bMapLoading = true;
+}
+
+// A loaded map's world keeps the time its load started, so PIE and standalone measure the same span.
+// Any world ends the load, an editor map loaded in the editor mustn't hold the clock for the next PIE.
+void FLocalMultiplayerDemoModule::OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS)
+{
+	if (World == nullptr)
+		return;
+
+	if (World->IsGameWorld() && !bMapLoading)
+	{
+		MapLoadStartTime = FPlatformTime::Seconds();
+		MapLoadFrame = GFrameCounter;
+	}
+
+	bMapLoading = false;
+}
+
+#if WITH_EDITOR
+void FLocalMultiplayerDemoModule::OnCookModification(TArray<FString>& ExtraPackagesToCook)
+{
+	for (const FString& ArenaLevel : GetDefault<UArenaRotation>()->ArenaLevels)
+	{
+		FString Filename;
+
+		if (FPackageName::DoesPackageExist(ArenaLevel, NULL, &Filename))
+			ExtraPackagesToCook.AddUnique(Filename);
+		else
+			UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Arena %s isn't in the project, it won't be cooked"), *ArenaLevel);
+	}
+}
+#endif
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FLocalMultiplayerDemoModule, LocalMultiplayerDemo, "LocalMultiplayerDemo" );
@@ -1,7 +1,54 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "EngineMinimal.h"
-#include "Kismet/GameplayStatics.h"
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EngineMinimal.h"
+#include "Kismet/GameplayStatics.h"
+#include "Modules/ModuleManager.h"
+
+// Log Category
+DECLARE_LOG_CATEGORY_EXTERN(LogLocalMultiplayerDemo, Log, All);
+
+// Stat Group ("stat LocalMultiplayerDemo")
+DECLARE_STATS_GROUP(TEXT("LocalMultiplayerDemo"), STATGROUP_LocalMultiplayerDemo, STATCAT_Advanced);
+
+class FLocalMultiplayerDemoModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+	// FPlatformTime::Seconds() when the current map started loading, or when a PIE world was created
+	static double GetMapLoadStartTime() { return MapLoadStartTime; }
+
+	// GFrameCounter of the last frame that started a map load or a PIE world
+	static uint64 GetMapLoadFrame() { return MapLoadFrame; }
+
+	// Tick group for gameplay that doesn't touch physics: during physics, or SerialGroup when
+	// "LocalMultiplayer.GameplayDuringPhysics 0" puts it back on the critical path to compare against
+	static ETickingGroup GetGameplayTickGroup(ETickingGroup SerialGroup);
+
+private:
+
+	static void OnPreLoadMap(const FString& MapName);
+
+	// PIE worlds are duplicated from the editor's without loading a map, so they start the clock here
+	static void OnPostWorldInitialization(UWorld* World, const UWorld::InitializationValues IVS);
+
+#if WITH_EDITOR
+	// Arenas are only streamed in by name, so nothing else tells the cook about them
+	static void OnCookModification(TArray<FString>& ExtraPackagesToCook);
+#endif
+
+	static double MapLoadStartTime;
+	static uint64 MapLoadFrame;
+
+	// True from PreLoadMap until the loaded map's world is initialised
+	static bool bMapLoading;
+
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle PostWorldInitializationHandle;
+
+};
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocalMultiplayerDemoBotController.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+
+// Sets default values
+ALocalMultiplayerDemoBotController::ALocalMultiplayerDemoBotController()
+{
+	// Decides where to move before the pawn it possesses moves
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	WanderRadius = 1000.f;
+
+	// Default Values for Variables
+	bBotActive = true;
+	bParkedMovementTick = false;
+	bParkedMeshTick = false;
+}
+
+// Called every frame
+void ALocalMultiplayerDemoBotController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Pick somewhere new once the last move finished or failed (a dead pawn can't move)
+	if (GetPawn() != nullptr && GetMoveStatus() == EPathFollowingStatus::Idle)
+		MoveToRandomPoint();
+}
+
+// The point always comes from the game mode's GameplayRandom, so seeded runs wander the same way
+void ALocalMultiplayerDemoBotController::MoveToRandomPoint()
+{
+	const FVector Origin = GetPawn()->GetActorLocation();
+	UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(GetWorld());
+
+	FRandomStream& Random = ALocalMultiplayerDemoGameModeBase::GetGameplayRandom(this);
+	const float Angle = Random.FRandRange(0.f, 2.f * PI);
+	const float Distance = WanderRadius * FMath::Sqrt(Random.FRand());
+	const FVector Destination = Origin + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * Distance;
+
+	if (NavSys != nullptr && NavSys->GetMainNavData() != nullptr)
+	{
+		// Off the navmesh or unreachable, we stay idle and pick again next tick
+		FNavLocation NavLocation;
+
+		if (NavSys->ProjectPointToNavigation(Destination, NavLocation, FVector(WanderRadius * 0.25f, WanderRadius * 0.25f, 500.f)))
+			MoveToLocation(NavLocation.Location);
+	}
+	else
+	{
+		// No navmesh, so walk straight at it and let collision stop us
+		MoveToLocation(Destination, -1.f, false, false);
+	}
+}
+
+void ALocalMultiplayerDemoBotController::SetBotActive(bool bActive)
+{
+	if (bActive == bBotActive)
+		return;
+
+	bBotActive = bActive;
+
+	if (!bActive)
+		StopMovement();
+
+	SetActorTickEnabled(bActive);
+
+	if (class UPathFollowingComponent* PathFollowing = GetPathFollowingComponent())
+		PathFollowing->SetComponentTickEnabled(bActive);
+
+	if (!bActive)
+	{
+		bParkedMovementTick = false;
+		bParkedMeshTick = false;
+		ParkPawnTicks();
+		return;
+	}
+
+	class ACharacter* Character = Cast<ACharacter>(GetPawn());
+
+	if (Character == nullptr)
+		return;
+
+	class UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+	class USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	if (Movement && bParkedMovementTick)
+		Movement->SetComponentTickEnabled(true);
+
+	if (Mesh && bParkedMeshTick)
+		Mesh->SetComponentTickEnabled(true);
+}
+
+void ALocalMultiplayerDemoBotController::ReapplyParking()
+{
+	if (!bBotActive)
+		ParkPawnTicks();
+}
+
+void ALocalMultiplayerDemoBotController::ParkPawnTicks()
+{
+	class ACharacter* Character = Cast<ACharacter>(GetPawn());
+
+	if (Character == nullptr)
+		return;
+
+	class UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+	class USkeletalMeshComponent* Mesh = Character->GetMesh();
+
+	// Fixed timestep characters, dead ones and dedicated servers already have some of these off
+	if (Movement && Movement->IsComponentTickEnabled())
+	{
+		bParkedMovementTick = true;
+		Movement->SetComponentTickEnabled(false);
+	}
+
+	if (Mesh && Mesh->IsComponentTickEnabled())
+	{
+		bParkedMeshTick = true;
+		Mesh->SetComponentTickEnabled(false);
+	}
+}
+
+void ALocalMultiplayerDemoBotController::SetBotTickInterval(float Interval)
+{
+	SetActorTickInterval(Interval);
+
+	if (class UPathFollowingComponent* PathFollowing = GetPathFollowingComponent())
+		PathFollowing->SetComponentTickInterval(Interval);
+}
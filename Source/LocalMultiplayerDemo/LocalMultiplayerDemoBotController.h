@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AIController.h"
+#include "LocalMultiplayerDemoBotController.generated.h"
+
+// Bot that wanders the arena, moving to random reachable points one after another.
+// Used by the match simulator to stand in for players.
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API ALocalMultiplayerDemoBotController : public AAIController
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values for this controller's properties
+	ALocalMultiplayerDemoBotController();
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// How far away each wander target may be, in cm
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Bot")
+	float WanderRadius;
+
+	// Park the bot where it stands, or let it carry on. A parked bot doesn't think, follow its path, move or animate.
+	void SetBotActive(bool bActive);
+
+	// True unless parked
+	FORCEINLINE bool IsBotActive() const { return bBotActive; }
+
+	// Park the pawn's movement and animation again if the bot is parked, after something turned them back on
+	// (a respawn activates both)
+	void ReapplyParking();
+
+	// Seconds between the bot's decisions and path following updates, 0 for every frame
+	void SetBotTickInterval(float Interval);
+
+private:
+
+	// Head for a new random point near the pawn
+	void MoveToRandomPoint();
+
+	// Turn off the pawn's movement and mesh ticks, remembering which were on
+	void ParkPawnTicks();
+
+	// Parking Variables. Only what was ticking when the bot was parked is turned back on.
+	bool bBotActive;
+	bool bParkedMovementTick;
+	bool bParkedMeshTick;
+
+};
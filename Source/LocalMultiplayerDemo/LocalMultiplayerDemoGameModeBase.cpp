@@ -1,256 +1,752 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "LocalMultiplayerDemoGameModeBase.h"
-#include "LocalMultiplayerDemo.h"
-#include "GameFramework/Controller.h"
-#include "GameFramework/PlayerController.h"
-#include "GameFramework/HUD.h"
-#include "LocalMultiplayerDemoHUD.h"
-#include "GameFramework/PlayerState.h"
-#include "LocalMultiplayerDemoPlayerState.h"
-#include "Runtime/Engine/Classes/Engine/LevelScriptActor.h"
-#include "Runtime/Engine/Public/EngineUtils.h"
-#include "Runtime/Engine/Classes/Engine/TargetPoint.h"
-#include "UObject/ConstructorHelpers.h"
-#include "P1_Character.h"
-#include "P2_Character.h"
-
-const FString ALocalMultiplayerDemoGameModeBase::MyLevelName("Minimal_Default");
-
-// Sets default values
-ALocalMultiplayerDemoGameModeBase::ALocalMultiplayerDemoGameModeBase()
-{
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-	PrimaryActorTick.bStartWithTickEnabled = true;
-
-	// Default Spawn Points Settings
-	RespawnSetup.RespawnPosition_1 = FVector(480.f, 430.f, 45.f);
-	RespawnSetup.RespawnPosition_2 = FVector(-130.f, 350.f, 45.f);
-	RespawnSetup.RespawnPosition_3 = FVector(-130.f, -380.f, 45.f);
-	RespawnSetup.RespawnPosition_4 = FVector(450.f, -380.f, 45.f);
-
-	// DefaultPawnClass assumes APlayerController at index 0 automatically
-	DefaultPawnClass = AP1_Character::StaticClass();
-	PlayerStateClass = ALocalMultiplayerDemoPlayerState::StaticClass();
-	HUDClass = ALocalMultiplayerDemoHUD::StaticClass();
-
-	// Default Variable Settings
-	hasSetSecondPlayer = false;
-	canFinishSetup = false;
-	canSetWidget = false;
-	delayWidgetSetupTimer = 0.f;
-	PlayerOneInWorld = NULL;
-	LevelActorInstance = NULL;
-	isTwoPlayerMode = false;
-
-}
-
-#pragma region Setup Logic
-// Called when the game starts or when spawned
-void ALocalMultiplayerDemoGameModeBase::BeginPlay()
-{
-	Super::BeginPlay();
-
-	// Find player one
-	class UWorld* const world = GetWorld();
-
-	if (world != nullptr)
-	{
-		for (TActorIterator<AP1_Character> ObstacleItr(world); ObstacleItr; ++ObstacleItr)
-		{
-			class AP1_Character* FoundPlayer = *ObstacleItr;
-
-			if (FoundPlayer != nullptr)
-			{
-				if (PlayerOneInWorld != FoundPlayer)
-				{
-					PlayerOneInWorld = FoundPlayer;
-
-					// Once player one is found, spawn our respawn locations in the world
-					CreateRespawnPoints();
-				}
-			}
-		}
-
-		if (PlayerOneInWorld != nullptr)
-		{
-			// To make sure everything has loaded on BeginPlay, we will do a level check
-			LevelActorInstance = Cast<ALevelScriptActor>(world->GetLevelScriptActor());
-
-			if (LevelActorInstance != nullptr)
-			{
-				if (LevelActorInstance->GetName().Contains(MyLevelName))
-				{
-					// Set two player variable to true for GameModeBase class
-					isTwoPlayerMode = true;
-
-					// Two player game variable for player one. This should be loaded and set from a save game file.
-					PlayerOneInWorld->isTwoPlayerGame = isTwoPlayerMode;
-				}
-			}
-		}
-	}
-}
-
-// Once player one is found and each respawn position has been set,
-// spawn as many ATargetPoint classes as you want, giving them a unique tag, so that you can find them later in other actors
-void ALocalMultiplayerDemoGameModeBase::CreateRespawnPoints()
-{
-	class UWorld* const world = GetWorld();
-
-	if (world != nullptr)
-	{
-		FRotator StartRot = FRotator(0, 0, 0);
-
-		FActorSpawnParameters spawnParams;
-		spawnParams.Owner = this;
-		spawnParams.Instigator = Instigator;
-
-		class ATargetPoint* FirstTargetPoint = world->SpawnActor<ATargetPoint>(ATargetPoint::StaticClass(), RespawnSetup.RespawnPosition_1, StartRot, spawnParams);
-
-		if (FirstTargetPoint != nullptr)
-			FirstTargetPoint->Tags.Add(FName(TEXT("RespawnOne")));
-
-		class ATargetPoint* SecondTargetPoint = world->SpawnActor<ATargetPoint>(ATargetPoint::StaticClass(), RespawnSetup.RespawnPosition_2, StartRot, spawnParams);
-
-		if (SecondTargetPoint != nullptr)
-			SecondTargetPoint->Tags.Add(FName(TEXT("RespawnTwo")));
-
-		class ATargetPoint* ThirdTargetPoint = world->SpawnActor<ATargetPoint>(ATargetPoint::StaticClass(), RespawnSetup.RespawnPosition_3, StartRot, spawnParams);
-
-		if (ThirdTargetPoint != nullptr)
-			ThirdTargetPoint->Tags.Add(FName(TEXT("RespawnThree")));
-
-		class ATargetPoint* FourthTargetPoint = world->SpawnActor<ATargetPoint>(ATargetPoint::StaticClass(), RespawnSetup.RespawnPosition_4, StartRot, spawnParams);
-
-		if (FourthTargetPoint != nullptr)
-			FourthTargetPoint->Tags.Add(FName(TEXT("RespawnFour")));
-	}
-}
-#pragma endregion
-
-// Called every frame
-void ALocalMultiplayerDemoGameModeBase::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-	// Again, to make sure everything has loaded correctly, we will do another level check
-	if (LevelActorInstance != nullptr)
-	{
-		if (LevelActorInstance->GetName().Contains(MyLevelName))
-		{
-			if (isTwoPlayerMode)
-			{
-				SetupTwoPlayers();
-
-				// Once players have spawned, load player UI
-				LoadTwoPlayerWidget(DeltaTime);
-			}
-		}
-	}
-}
-
-#pragma region Player/UI Logic
-// Create a new APlayerController, unpossess it, spawn player two, and then have player two possess the created APlayerController
-void ALocalMultiplayerDemoGameModeBase::SetupTwoPlayers()
-{
-	class UWorld* const world = GetWorld();
-
-	if (world != nullptr)
-	{
-		if (PlayerOneInWorld != nullptr)
-		{
-			if (!canFinishSetup) 
-			{
-				// Find location of player one
-				FVector PlayerOnePos = PlayerOneInWorld->GetActorLocation();
-				PlayerOnePos.X = PlayerOneInWorld->GetActorLocation().X;
-				PlayerOnePos.Y = PlayerOneInWorld->GetActorLocation().Y;
-				PlayerOnePos.Z = PlayerOneInWorld->GetActorLocation().Z;
-
-				// Create offset for player two spawn, so that it doesn't spawn on top of player one
-				FVector PlayerTwoSpawnLocationOffset = FVector(PlayerOnePos.X, -150.f, 40.f);
-				FVector FinalSpawnPos = PlayerOnePos + PlayerTwoSpawnLocationOffset;
-				FRotator SpawnRot = FRotator(0.f, 0.f, 0.f);
-
-				FActorSpawnParameters spawnParams;
-				spawnParams.Owner = this;
-				spawnParams.Instigator = Instigator;
-
-				// Create new APlayerController at index 1
-				class APlayerController* NewPlayerController = Cast<APlayerController>(UGameplayStatics::CreatePlayer(world, 1));
-
-				if (NewPlayerController != nullptr)
-				{
-					// Another player one will spawn with the new APlayerController, because it is set as this GameModeBase's DefaultPawnClass
-					class AP1_Character* CreatedPlayer = Cast<AP1_Character>(NewPlayerController->GetCharacter());
-					class AHUD* CreatedHud = Cast<AHUD>(NewPlayerController->GetHUD());
-					class APlayerCameraManager* CreatedCamManager = Cast<APlayerCameraManager>(NewPlayerController->PlayerCameraManager);
-					class ALocalMultiplayerDemoPlayerState* CreatedPlayerState = Cast<ALocalMultiplayerDemoPlayerState>(NewPlayerController->PlayerState);
-
-					if (CreatedPlayer && CreatedHud && CreatedCamManager && CreatedPlayerState)
-					{
-						// DESTROY NEW PLAYER ONE and any new classes you aren't going to use
-						// Keep APlayerState classes, because we use them for scoring. Keep APlayerCameraManager, too.
-						CreatedPlayer->Destroy();
-						CreatedHud->Destroy();
-						
-						// UnPossess the newly created APlayerController
-						NewPlayerController->UnPossess();
-
-						// Spawn player two
-						class AP2_Character* PlayerTwoInWorld = world->SpawnActor<AP2_Character>(AP2_Character::StaticClass(), FinalSpawnPos, SpawnRot, spawnParams);
-
-						if (PlayerTwoInWorld != nullptr)
-						{
-							// Have player two possess APlayerController at index 1
-							NewPlayerController->Possess(PlayerTwoInWorld);
-							hasSetSecondPlayer = true;
-														
-							// End method
-							canFinishSetup = true;
-						}
-					}
-				}
-			}
-		}
-	}
-}
-
-// Load widget method
-void ALocalMultiplayerDemoGameModeBase::LoadTwoPlayerWidget(float dTime)
-{
-	if (hasSetSecondPlayer)
-	{
-		if (!canSetWidget)
-		{
-			// Run short delay to make sure that player two has already been spawned and possessed
-			delayWidgetSetupTimer += 1 * dTime;
-
-			if (delayWidgetSetupTimer > 0.2f)
-			{
-				class UWorld* const world = GetWorld();
-
-				if (world != nullptr)
-				{
-					// Check for Player Controller, Level, and HUD classes
-					class ALevelScriptActor* LevelActorInst = Cast<ALevelScriptActor>(world->GetLevelScriptActor());
-					class APlayerController* PlConZero = Cast<APlayerController>(UGameplayStatics::GetPlayerController(world, 0));
-					class ALocalMultiplayerDemoHUD* HudFromPlConZero = Cast<ALocalMultiplayerDemoHUD>(PlConZero->GetHUD());
-
-					if (PlConZero && HudFromPlConZero && LevelActorInst)
-					{
-						// Create widget
-						HudFromPlConZero->CreateTwoPlayerUI();
-						canSetWidget = true;
-					}
-				}
-			}
-		}
-	}
-}
-#pragma endregion
-
-
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "LocalMultiplayerDemo.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/HUD.h"
+#include "LocalMultiplayerDemoHUD.h"
+#include "GameFramework/PlayerState.h"
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "Runtime/Engine/Classes/Engine/LevelScriptActor.h"
+#include "Runtime/Engine/Public/EngineUtils.h"
+#include "Engine/LevelBounds.h"
+#include "UObject/ConstructorHelpers.h"
+#include "Misc/PackageName.h"
+#include "RespawnBakeData.h"
+#include "PlayerMemoryReport.h"
+#include "InputLatencyTracker.h"
+#include "PlayerRegistry.h"
+#include "TriggerManager.h"
+#include "ArenaRotation.h"
+#include "KillCamRecorder.h"
+#include "FrameBudgetGovernor.h"
+#include "WorldStateChecksum.h"
+#include "CharacterStateManager.h"
+#include "HitchDetector.h"
+#include "RespawnPoint.h"
+#include "Misc/Paths.h"
+#include "P1_Character.h"
+#include "P2_Character.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Time To Interactive (ms)"), STAT_TimeToInteractive, STATGROUP_LocalMultiplayerDemo);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Round Reset (ms)"), STAT_RoundResetTime, STATGROUP_LocalMultiplayerDemo);
+DECLARE_CYCLE_STAT(TEXT("Game Mode Managers"), STAT_GameModeManagers, STATGROUP_LocalMultiplayerDemo);
+DECLARE_CYCLE_STAT(TEXT("Player Join"), STAT_PlayerJoin, STATGROUP_LocalMultiplayerDemo);
+DECLARE_CYCLE_STAT(TEXT("Round Reset"), STAT_RoundReset, STATGROUP_LocalMultiplayerDemo);
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GResetRoundCommand(
+	TEXT("LocalMultiplayer.ResetRound"),
+	TEXT("Starts a new round on the server without reloading the map, and prints how long it took"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		class ALocalMultiplayerDemoGameModeBase* GameMode = World ? Cast<ALocalMultiplayerDemoGameModeBase>(World->GetAuthGameMode()) : NULL;
+
+		if (GameMode == nullptr)
+		{
+			Ar.Logf(TEXT("No game mode on this world (rounds are reset by the server)"));
+			return;
+		}
+
+		GameMode->ResetRound();
+		Ar.Logf(TEXT("Round reset in %.2f ms"), GameMode->GetLastRoundResetTime());
+	}));
+
+// Sets default values
+ALocalMultiplayerDemoGameModeBase::ALocalMultiplayerDemoGameModeBase()
+{
+	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	// The managers tick every frame, in the group GetGameplayTickGroup picks as they are registered
+	ManagersTick.bCanEverTick = true;
+	ManagersTick.bStartWithTickEnabled = true;
+	ManagersTick.TickGroup = TG_PrePhysics;
+
+	// Default Spawn Points Settings
+	RespawnSetup.RespawnPosition_1 = FVector(480.f, 430.f, 45.f);
+	RespawnSetup.RespawnPosition_2 = FVector(-130.f, 350.f, 45.f);
+	RespawnSetup.RespawnPosition_3 = FVector(-130.f, -380.f, 45.f);
+	RespawnSetup.RespawnPosition_4 = FVector(450.f, -380.f, 45.f);
+
+	// DefaultPawnClass assumes APlayerController at index 0 automatically
+	DefaultPawnClass = AP1_Character::StaticClass();
+	PlayerStateClass = ALocalMultiplayerDemoPlayerState::StaticClass();
+	HUDClass = ALocalMultiplayerDemoHUD::StaticClass();
+
+	// Local player lookups
+	PlayerRegistry = CreateDefaultSubobject<UPlayerRegistry>(TEXT("PlayerRegistry"));
+
+	// Arena sub-levels, if any are configured
+	ArenaRotation = CreateDefaultSubobject<UArenaRotation>(TEXT("ArenaRotation"));
+
+	// Kill-cam history, its buffers are allocated at BeginPlay
+	KillCamRecorder = CreateDefaultSubobject<UKillCamRecorder>(TEXT("KillCamRecorder"));
+
+	// Frame budget levers, starting at full quality
+	FrameBudgetGovernor = CreateDefaultSubobject<UFrameBudgetGovernor>(TEXT("FrameBudgetGovernor"));
+
+	// Off unless DefaultGame.ini or -WorldChecksum turns it on
+	WorldChecksum = CreateDefaultSubobject<UWorldStateChecksum>(TEXT("WorldChecksum"));
+
+	// Respawn state of every player two and bot, updated in one pass from Tick
+	CharacterState = CreateDefaultSubobject<UCharacterStateManager>(TEXT("CharacterState"));
+
+	// Default Variable Settings
+	hasSetSecondPlayer = false;
+	canFinishSetup = false;
+	canSetWidget = false;
+	BeginPlayTime = 0.0;
+	BeginPlayFrame = 0;
+	PlayerOneInWorld = NULL;
+	LevelActorInstance = nullptr;
+	RespawnBakeData = NULL;
+	TriggerManager = NULL;
+	isTwoPlayerMode = false;
+	TwoPlayerLevelName = TEXT("Minimal_Default");
+	bUseFixedTimestep = false;
+	FixedTimestepRate = 60.f;
+	MaxFixedSubsteps = 4;
+	MaxNetCullDistance = 15000.f;
+	RespawnDelay = 3.f;
+	ArenaNetCullDistanceSquared = 0.f;
+	RoundResetBudget = 4.f;
+	RandomSeed = 0;
+	LastRoundResetTime = 0.f;
+
+}
+
+#pragma region Setup Logic
+// Called when the game starts or when spawned
+void ALocalMultiplayerDemoGameModeBase::BeginPlay()
+{
+	Super::BeginPlay();
+
+	BeginPlayTime = FPlatformTime::Seconds();
+	BeginPlayFrame = GFrameCounter;
+
+	// Before anything makes a random choice
+	SetRandomSeed(RandomSeed != 0 ? RandomSeed : (int32)FPlatformTime::Cycles());
+
+	// Report how long the server took to come up and how much it is holding, so the server build's footprint can be tracked
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		const double Now = FPlatformTime::Seconds();
+
+		UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Dedicated server ready %.2f s after launch (map load %.1f ms), %.1f MB used, %.1f MB peak"),
+			Now - GStartTime, (Now - FLocalMultiplayerDemoModule::GetMapLoadStartTime()) * 1000.0,
+			MemoryStats.UsedPhysical / (1024.f * 1024.f), MemoryStats.PeakUsedPhysical / (1024.f * 1024.f));
+	}
+
+	SetupTriggerManager();
+
+	// Arenas bring their own respawn points, which register as each arena is shown
+	ArenaRotation->OnArenaShown.AddUObject(this, &ALocalMultiplayerDemoGameModeBase::HandleArenaShown);
+	ArenaRotation->Start();
+
+	KillCamRecorder->Start();
+
+	// After the trigger manager and kill-cam it turns down
+	FrameBudgetGovernor->Start();
+
+	WorldChecksum->Start();
+
+	// Find player one, the first local player has already possessed its default pawn by now
+	class UWorld* const world = GetWorld();
+
+	if (world != nullptr)
+	{
+		class AP1_Character* FoundPlayer = Cast<AP1_Character>(PlayerRegistry->GetPawn(PlayerRegistry->GetPrimarySlot()));
+
+		if (FoundPlayer != nullptr)
+		{
+			if (PlayerOneInWorld != FoundPlayer)
+			{
+				PlayerOneInWorld = FoundPlayer;
+
+				// Once player one is found, spawn our respawn locations in the world, unless the map or its arenas place their own
+				if (!ArenaRotation->IsActive() && !TActorIterator<ARespawnPoint>(world))
+					CreateRespawnPoints();
+			}
+		}
+
+		// Respawn table baked for this map. An arena's is loaded when the arena is shown instead.
+		if (!ArenaRotation->IsActive())
+		{
+			TArray<FVector> RespawnPositions;
+			RespawnSetup.GetRespawnPositions(RespawnPositions);
+			LoadRespawnBake(UGameplayStatics::GetCurrentLevelName(this, true), RespawnPositions);
+		}
+
+		if (PlayerOneInWorld != nullptr)
+		{
+			// To make sure everything has loaded on BeginPlay, we will do a level check
+			LevelActorInstance = Cast<ALevelScriptActor>(world->GetLevelScriptActor());
+
+			if (LevelActorInstance.IsValid())
+			{
+				if (IsTwoPlayerLevel(world))
+				{
+					// Set two player variable to true for GameModeBase class
+					isTwoPlayerMode = true;
+
+					// Two player game variable for player one. This should be loaded and set from a save game file.
+					PlayerOneInWorld->isTwoPlayerGame = isTwoPlayerMode;
+				}
+			}
+		}
+	}
+
+}
+
+// Use the trigger manager placed in the level, or spawn one so pickups and kill volumes can be added at runtime
+void ALocalMultiplayerDemoGameModeBase::SetupTriggerManager()
+{
+	class UWorld* const world = GetWorld();
+
+	if (world == nullptr)
+		return;
+
+	for (TActorIterator<ATriggerManager> It(world); It; ++It)
+	{
+		TriggerManager = *It;
+		break;
+	}
+
+	if (TriggerManager == nullptr)
+	{
+		FActorSpawnParameters spawnParams;
+		spawnParams.Owner = this;
+		TriggerManager = world->SpawnActor<ATriggerManager>(ATriggerManager::StaticClass(), FTransform::Identity, spawnParams);
+	}
+
+	if (TriggerManager != nullptr)
+	{
+		TriggerManager->OnPickupCollected.AddUObject(this, &ALocalMultiplayerDemoGameModeBase::HandlePickupCollected);
+		TriggerManager->OnCharacterKilled.AddUObject(this, &ALocalMultiplayerDemoGameModeBase::HandleCharacterKilled);
+
+		// Record the frame with this frame's pickups and kills in it. Only during physics: with the trigger manager
+		// back after physics, the prerequisite would drag the managers there too instead of before physics.
+		if (FLocalMultiplayerDemoModule::GetGameplayTickGroup(TG_PrePhysics) == TG_DuringPhysics)
+			ManagersTick.AddPrerequisite(TriggerManager, TriggerManager->PrimaryActorTick);
+	}
+}
+
+void ALocalMultiplayerDemoGameModeBase::HandlePickupCollected(ACharacter* Collector, int32 Score)
+{
+	if (class AP1_Character* PlayerOne = Cast<AP1_Character>(Collector))
+		PlayerOne->AddScore(Score);
+	else if (class AP2_Character* PlayerTwo = Cast<AP2_Character>(Collector))
+		PlayerTwo->AddScore(Score);
+}
+
+// Only player two can die
+void ALocalMultiplayerDemoGameModeBase::HandleCharacterKilled(ACharacter* Character)
+{
+	if (class AP2_Character* PlayerTwo = Cast<AP2_Character>(Character))
+		PlayerTwo->Kill();
+}
+
+// Track local players as they join
+void ALocalMultiplayerDemoGameModeBase::PostLogin(APlayerController* NewPlayer)
+{
+	Super::PostLogin(NewPlayer);
+
+	// The HUD and default pawn exist once Super::PostLogin returns
+	PlayerRegistry->RegisterController(NewPlayer);
+}
+
+void ALocalMultiplayerDemoGameModeBase::Logout(AController* Exiting)
+{
+	PlayerRegistry->UnregisterController(Exiting);
+
+	Super::Logout(Exiting);
+}
+
+// Called when the game ends or the map changes
+void ALocalMultiplayerDemoGameModeBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Save input latency next to the other profiling output when it was being recorded
+	if (FInputLatencyTracker::IsEnabled())
+	{
+		const FString Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("InputLatency-%s-%s.csv"), *UGameplayStatics::GetCurrentLevelName(this, true), *FDateTime::Now().ToString());
+		FInputLatencyTracker::Get().ExportCSV(Filename);
+	}
+
+	WorldChecksum->Stop();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALocalMultiplayerDemoGameModeBase::SetRandomSeed(int32 Seed)
+{
+	GameplayRandom.Initialize(Seed);
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Gameplay random seed %d (RandomSeed=%d in DefaultGame.ini repeats it)"), Seed, Seed);
+}
+
+FRandomStream& ALocalMultiplayerDemoGameModeBase::GetGameplayRandom(const UObject* WorldContextObject)
+{
+	class UWorld* const world = WorldContextObject ? WorldContextObject->GetWorld() : NULL;
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	if (GameMode != nullptr)
+		return GameMode->GameplayRandom;
+
+	static FRandomStream UnseededRandom(FMath::Rand());
+	return UnseededRandom;
+}
+
+// Once player one is found and each respawn position has been set, spawn a respawn point at each of them.
+// Like points placed in a level, they register themselves as they begin play.
+void ALocalMultiplayerDemoGameModeBase::CreateRespawnPoints()
+{
+	class UWorld* const world = GetWorld();
+
+	if (world != nullptr)
+	{
+		FRotator StartRot = FRotator(0, 0, 0);
+
+		TArray<FVector> RespawnPositions;
+		RespawnSetup.GetRespawnPositions(RespawnPositions);
+
+		for (int32 Index = 0; Index < RespawnPositions.Num(); ++Index)
+		{
+			class ARespawnPoint* Point = world->SpawnActorDeferred<ARespawnPoint>(ARespawnPoint::StaticClass(), FTransform(StartRot, RespawnPositions[Index]), this, Instigator);
+
+			if (Point != nullptr)
+			{
+				Point->RespawnIndex = Index;
+				Point->FinishSpawning(FTransform(StartRot, RespawnPositions[Index]));
+			}
+		}
+	}
+}
+
+void ALocalMultiplayerDemoGameModeBase::RegisterRespawnPoint(ARespawnPoint* Point)
+{
+	RespawnPoints.AddUnique(Point);
+}
+
+void ALocalMultiplayerDemoGameModeBase::UnregisterRespawnPoint(ARespawnPoint* Point)
+{
+	RespawnPoints.Remove(Point);
+}
+
+// While arenas are switching both may be registered, so only hand out the current arena's
+void ALocalMultiplayerDemoGameModeBase::GetRespawnPoints(TArray<ARespawnPoint*>& OutPoints) const
+{
+	const class ULevel* ArenaLevel = ArenaRotation->GetCurrentArenaLevel();
+
+	OutPoints.Reset();
+
+	for (class ARespawnPoint* Point : RespawnPoints)
+	{
+		if (Point != nullptr && (ArenaLevel == nullptr || Point->GetLevel() == ArenaLevel))
+			OutPoints.Add(Point);
+	}
+
+	// An arena without points of its own uses any others there are
+	if (OutPoints.Num() == 0 && ArenaLevel != nullptr)
+	{
+		for (class ARespawnPoint* Point : RespawnPoints)
+		{
+			if (Point != nullptr)
+				OutPoints.Add(Point);
+		}
+	}
+
+	OutPoints.Sort([](const ARespawnPoint& A, const ARespawnPoint& B) { return A.RespawnIndex < B.RespawnIndex; });
+}
+
+// The bake loads in the background. Until it arrives, or if it doesn't match the respawn points, respawns stay purely random.
+void ALocalMultiplayerDemoGameModeBase::LoadRespawnBake(const FString& MapName, const TArray<FVector>& RespawnPositions)
+{
+	RespawnBakeData = NULL;
+	RespawnBakeMapName = MapName;
+
+	const FString BakePackageName = GetRespawnBakePackageName(MapName);
+
+	if (!FPackageName::DoesPackageExist(BakePackageName))
+		return;
+
+	LoadPackageAsync(BakePackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &ALocalMultiplayerDemoGameModeBase::OnRespawnBakeLoaded, MapName, RespawnPositions));
+}
+
+void ALocalMultiplayerDemoGameModeBase::OnRespawnBakeLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result, FString MapName, TArray<FVector> RespawnPositions)
+{
+	// Another arena may have been shown while this one loaded
+	if (Package == nullptr || MapName != RespawnBakeMapName)
+		return;
+
+	class URespawnBakeData* BakeData = FindObject<URespawnBakeData>(Package, *FPackageName::GetShortName(PackageName));
+
+	// Ignore stale bakes, the tables are indexed by respawn point
+	if (BakeData != nullptr && !BakeData->MatchesRespawnPositions(RespawnPositions))
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Respawn bake for %s doesn't match its respawn points. Run the RespawnBake commandlet again."), *MapName);
+		return;
+	}
+
+	RespawnBakeData = BakeData;
+}
+
+// Once an arena is in, put everyone on its respawn points before the old one goes from under them
+void ALocalMultiplayerDemoGameModeBase::HandleArenaShown(const FString& ArenaName, bool bReplaced)
+{
+	TArray<class ARespawnPoint*> Points;
+	GetRespawnPoints(Points);
+
+	TArray<FVector> RespawnPositions;
+
+	for (const class ARespawnPoint* Point : Points)
+		RespawnPositions.Add(Point->GetActorLocation());
+
+	LoadRespawnBake(ArenaName, RespawnPositions);
+
+	if (!bReplaced || Points.Num() == 0)
+		return;
+
+	int32 NextPoint = 0;
+
+	for (FConstPawnIterator Iterator = GetWorld()->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		class APawn* Pawn = Iterator->Get();
+
+		if (Pawn == nullptr)
+			continue;
+
+		const class ARespawnPoint* Point = Points[NextPoint++ % Points.Num()];
+		Pawn->TeleportTo(Point->GetActorLocation(), Point->GetActorRotation());
+	}
+}
+
+// Everything is reset in place: no actor is spawned or destroyed and nothing is possessed again, so
+// the HUD, the widget and every controller's view carry on as they are
+void ALocalMultiplayerDemoGameModeBase::ResetRound()
+{
+	class UWorld* const world = GetWorld();
+
+	if (world == nullptr)
+		return;
+
+	SCOPE_HITCH_CYCLE_COUNTER(STAT_RoundReset, EHitchSection::RoundReset);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<class ARespawnPoint*> Points;
+	GetRespawnPoints(Points);
+
+	int32 NextPoint = 0;
+	int32 NumPawns = 0;
+
+	for (FConstPawnIterator Iterator = world->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		class APawn* Pawn = Iterator->Get();
+
+		if (Pawn == nullptr)
+			continue;
+
+		// Stay put on a map without respawn points
+		FVector Location = Pawn->GetActorLocation();
+		FRotator Rotation = Pawn->GetActorRotation();
+
+		if (Points.Num() > 0)
+		{
+			const class ARespawnPoint* Point = Points[NextPoint++ % Points.Num()];
+			Location = Point->GetActorLocation();
+			Rotation = Point->GetActorRotation();
+		}
+
+		if (class AP1_Character* PlayerOne = Cast<AP1_Character>(Pawn))
+			PlayerOne->ResetForRound(Location, Rotation);
+		else if (class AP2_Character* PlayerTwo = Cast<AP2_Character>(Pawn))
+			PlayerTwo->ResetForRound(Location, Rotation);
+		else
+			Pawn->TeleportTo(Location, Rotation);
+
+		++NumPawns;
+	}
+
+	if (TriggerManager != nullptr)
+		TriggerManager->ResetPickups();
+
+	KillCamRecorder->ClearHistory();
+
+	LastRoundResetTime = (FPlatformTime::Seconds() - StartTime) * 1000.f;
+	SET_FLOAT_STAT(STAT_RoundResetTime, LastRoundResetTime);
+
+	if (LastRoundResetTime > RoundResetBudget)
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("Round reset took %.2f ms for %d pawns, over its %.2f ms budget"), LastRoundResetTime, NumPawns, RoundResetBudget);
+	else
+		UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Round reset in %.2f ms for %d pawns"), LastRoundResetTime, NumPawns);
+}
+
+// Compared against the persistent level's script actor, so arenas streaming in and out don't change the answer
+bool ALocalMultiplayerDemoGameModeBase::IsTwoPlayerLevel(const UWorld* World)
+{
+	const class ALevelScriptActor* LevelScript = (World && World->PersistentLevel) ? World->PersistentLevel->GetLevelScriptActor() : NULL;
+
+	return LevelScript != nullptr && LevelScript->GetName().Contains(GetDefault<ALocalMultiplayerDemoGameModeBase>()->TwoPlayerLevelName);
+}
+
+FString ALocalMultiplayerDemoGameModeBase::GetRespawnBakePackageName(const FString& MapName)
+{
+	return FString::Printf(TEXT("/Game/Data/RespawnBake_%s"), *MapName);
+}
+
+// The arena's diagonal, so players anywhere in it are relevant to each other, capped at MaxNetCullDistance
+float ALocalMultiplayerDemoGameModeBase::GetArenaNetCullDistanceSquared()
+{
+	if (ArenaNetCullDistanceSquared <= 0.f)
+	{
+		class UWorld* const world = GetWorld();
+		float CullDistance = MaxNetCullDistance;
+
+		if (world != nullptr && world->PersistentLevel != nullptr)
+		{
+			const FBox ArenaBounds = ALevelBounds::CalculateLevelBounds(world->PersistentLevel);
+
+			if (ArenaBounds.IsValid)
+				CullDistance = FMath::Min(ArenaBounds.GetSize().Size(), MaxNetCullDistance);
+		}
+
+		ArenaNetCullDistanceSquared = FMath::Square(CullDistance);
+	}
+
+	return ArenaNetCullDistanceSquared;
+}
+#pragma endregion
+
+// Called every frame
+void ALocalMultiplayerDemoGameModeBase::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Again, to make sure everything has loaded correctly, we will do another level check
+	if (!canSetWidget && LevelActorInstance.IsValid())
+	{
+		if (IsTwoPlayerLevel(GetWorld()))
+		{
+			if (isTwoPlayerMode)
+			{
+				SetupTwoPlayers();
+
+				// Once players have spawned, load player UI
+				LoadTwoPlayerWidget();
+			}
+		}
+	}
+
+	// Respawning moves and re-enables capsules, so this stays before physics with the setup above
+	CharacterState->Tick(DeltaTime);
+
+	// The arena rotation moves on whatever mode we're in. A switch teleports every pawn, so it's before physics too.
+	ArenaRotation->Tick(DeltaTime);
+}
+
+void ALocalMultiplayerDemoGameModeBase::TickManagers(float DeltaTime)
+{
+	SCOPE_HITCH_CYCLE_COUNTER(STAT_GameModeManagers, EHitchSection::GameModeManagers);
+
+	KillCamRecorder->Tick(DeltaTime);
+	FrameBudgetGovernor->Tick(DeltaTime);
+
+	// Last, once everything else has had its say this frame
+	WorldChecksum->Tick();
+}
+
+void ALocalMultiplayerDemoGameModeBase::RegisterActorTickFunctions(bool bRegister)
+{
+	Super::RegisterActorTickFunctions(bRegister);
+
+	if (bRegister)
+	{
+		if (ManagersTick.bCanEverTick && !IsTemplate())
+		{
+			ManagersTick.Target = this;
+			ManagersTick.TickGroup = FLocalMultiplayerDemoModule::GetGameplayTickGroup(TG_PrePhysics);
+			ManagersTick.SetTickFunctionEnable(ManagersTick.bStartWithTickEnabled);
+			ManagersTick.RegisterTickFunction(GetLevel());
+		}
+	}
+	else if (ManagersTick.IsTickFunctionRegistered())
+	{
+		ManagersTick.UnRegisterTickFunction();
+	}
+}
+
+void FGameModeManagersTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	// Same checks as an actor's own tick
+	if (Target && !Target->IsPendingKillOrUnreachable() && TickType != LEVELTICK_ViewportsOnly)
+		Target->TickManagers(DeltaTime * Target->CustomTimeDilation);
+}
+
+FString FGameModeManagersTickFunction::DiagnosticMessage()
+{
+	return Target ? Target->GetFullName() + TEXT("[TickManagers]") : TEXT("<NULL>[TickManagers]");
+}
+
+#pragma region Player/UI Logic
+// Tag the default pawn's allocations with the player slot it is being spawned for
+APawn* ALocalMultiplayerDemoGameModeBase::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	LLM_SCOPE_PLAYER_SLOT(UPlayerRegistry::GetSlotIndex(NewPlayer));
+
+	return Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+}
+
+// Create a new APlayerController, unpossess it, spawn player two, and then have player two possess the created APlayerController
+void ALocalMultiplayerDemoGameModeBase::SetupTwoPlayers()
+{
+	class UWorld* const world = GetWorld();
+
+	if (world != nullptr)
+	{
+		if (PlayerOneInWorld != nullptr)
+		{
+			if (!canFinishSetup) 
+			{
+				SCOPE_HITCH_CYCLE_COUNTER(STAT_PlayerJoin, EHitchSection::PlayerJoin);
+
+				// Find location of player one
+				FVector PlayerOnePos = PlayerOneInWorld->GetActorLocation();
+				PlayerOnePos.X = PlayerOneInWorld->GetActorLocation().X;
+				PlayerOnePos.Y = PlayerOneInWorld->GetActorLocation().Y;
+				PlayerOnePos.Z = PlayerOneInWorld->GetActorLocation().Z;
+
+				// Create offset for player two spawn, so that it doesn't spawn on top of player one
+				FVector PlayerTwoSpawnLocationOffset = FVector(PlayerOnePos.X, -150.f, 40.f);
+				FVector FinalSpawnPos = PlayerOnePos + PlayerTwoSpawnLocationOffset;
+				FRotator SpawnRot = FRotator(0.f, 0.f, 0.f);
+
+				FActorSpawnParameters spawnParams;
+				spawnParams.Owner = this;
+				spawnParams.Instigator = Instigator;
+
+				// Player two goes in the first free local player slot
+				const int32 NewSlot = PlayerRegistry->FindFreeSlot();
+
+				if (NewSlot == INDEX_NONE)
+					return;
+
+				// Everything created for player two from here on is counted against its slot
+				LLM_SCOPE_PLAYER_SLOT(NewSlot);
+
+				// Create new APlayerController for that slot
+				class APlayerController* NewPlayerController = Cast<APlayerController>(UGameplayStatics::CreatePlayer(world, NewSlot));
+
+				if (NewPlayerController != nullptr)
+				{
+					// Another player one will spawn with the new APlayerController, because it is set as this GameModeBase's DefaultPawnClass
+					class AP1_Character* CreatedPlayer = Cast<AP1_Character>(NewPlayerController->GetCharacter());
+					class AHUD* CreatedHud = Cast<AHUD>(NewPlayerController->GetHUD());
+					class APlayerCameraManager* CreatedCamManager = Cast<APlayerCameraManager>(NewPlayerController->PlayerCameraManager);
+					class ALocalMultiplayerDemoPlayerState* CreatedPlayerState = Cast<ALocalMultiplayerDemoPlayerState>(NewPlayerController->PlayerState);
+
+					if (CreatedPlayer && CreatedHud && CreatedCamManager && CreatedPlayerState)
+					{
+						// DESTROY NEW PLAYER ONE and any new classes you aren't going to use
+						// Keep APlayerState classes, because we use them for scoring. Keep APlayerCameraManager, too.
+						// The native UI draws each player's view from that player's own HUD, so keep the HUD in that mode.
+						CreatedPlayer->Destroy();
+
+						if (!ALocalMultiplayerDemoHUD::UseNativeHUD())
+						{
+							CreatedHud->Destroy();
+							PlayerRegistry->RegisterController(NewPlayerController);
+						}
+						
+						// UnPossess the newly created APlayerController
+						NewPlayerController->UnPossess();
+
+						// Spawn player two
+						class AP2_Character* PlayerTwoInWorld = world->SpawnActor<AP2_Character>(AP2_Character::StaticClass(), FinalSpawnPos, SpawnRot, spawnParams);
+
+						if (PlayerTwoInWorld != nullptr)
+						{
+							// Have player two possess APlayerController at index 1
+							NewPlayerController->Possess(PlayerTwoInWorld);
+							hasSetSecondPlayer = true;
+														
+							// End method
+							canFinishSetup = true;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+// Load widget method
+void ALocalMultiplayerDemoGameModeBase::LoadTwoPlayerWidget()
+{
+	if (hasSetSecondPlayer)
+	{
+		if (!canSetWidget)
+		{
+			// Wait until player two has been spawned and possessed, rather than for a fixed delay
+			if (AreLocalPlayersReady())
+			{
+				class UWorld* const world = GetWorld();
+
+				if (world != nullptr)
+				{
+					// Check for Player Controller, Level, and HUD classes. The first local player owns the shared UI.
+					const int32 PrimarySlot = PlayerRegistry->GetPrimarySlot();
+					class ALevelScriptActor* LevelActorInst = Cast<ALevelScriptActor>(world->GetLevelScriptActor());
+					class APlayerController* PrimaryController = PlayerRegistry->GetController(PrimarySlot);
+					class ALocalMultiplayerDemoHUD* PrimaryHud = Cast<ALocalMultiplayerDemoHUD>(PlayerRegistry->GetHUD(PrimarySlot));
+
+					if (PrimaryController && PrimaryHud && LevelActorInst)
+					{
+						// Create widget
+						PrimaryHud->CreateTwoPlayerUI();
+						canSetWidget = true;
+
+						// Every local player is fully set up now
+						FPlayerMemoryReport::UpdateStats(world);
+
+						const float TimeToInteractive = (FPlatformTime::Seconds() - FLocalMultiplayerDemoModule::GetMapLoadStartTime()) * 1000.f;
+						SET_FLOAT_STAT(STAT_TimeToInteractive, TimeToInteractive);
+						UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("Two player UI ready %.1f ms after map load"), TimeToInteractive);
+					}
+				}
+			}
+		}
+	}
+}
+
+bool ALocalMultiplayerDemoGameModeBase::AreLocalPlayersReady() const
+{
+	const int32 PrimarySlot = PlayerRegistry->GetPrimarySlot();
+	int32 NumLocalPlayers = 0;
+
+	for (int32 Slot = 0; Slot < UPlayerRegistry::MaxSlots; ++Slot)
+	{
+		if (PlayerRegistry->GetController(Slot) == nullptr)
+			continue;
+
+		class APawn* PossessedPawn = PlayerRegistry->GetPawn(Slot);
+
+		// Pawn must have run BeginPlay so it has already looked up its player state
+		if (PossessedPawn == nullptr || !PossessedPawn->HasActorBegunPlay() || PlayerRegistry->GetPlayerState(Slot) == nullptr)
+			return false;
+
+		// Only the first player keeps a HUD, the others' HUDs are destroyed in SetupTwoPlayers
+		if (Slot == PrimarySlot && PlayerRegistry->GetHUD(Slot) == nullptr)
+			return false;
+
+		++NumLocalPlayers;
+	}
+
+	return NumLocalPlayers >= (isTwoPlayerMode ? 2 : 1);
+}
+#pragma endregion
+
+
+
@@ -1,87 +1,284 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/GameModeBase.h"
-#include "LocalMultiplayerDemoGameModeBase.generated.h"
-
-USTRUCT(BlueprintType)
-struct FRespawnSettings
-{
-	GENERATED_USTRUCT_BODY()
-
-	UPROPERTY()
-	FVector RespawnPosition_1;
-	
-	UPROPERTY()
-	FVector RespawnPosition_2;
-	
-	UPROPERTY()
-	FVector RespawnPosition_3;
-	
-	UPROPERTY()
-	FVector RespawnPosition_4;
-
-};
-
-UCLASS()
-class LOCALMULTIPLAYERDEMO_API ALocalMultiplayerDemoGameModeBase : public AGameModeBase
-{
-	GENERATED_BODY()
-	
-private:
-
-	// Two Player Mode Variables
-	bool hasSetSecondPlayer;
-	bool canFinishSetup;
-
-	// Load Widget Variables
-	bool canSetWidget;
-	float delayWidgetSetupTimer;
-	
-	// Method to Spawn Player Two
-	void SetupTwoPlayers();
-	
-public:
-
-	// Sets default values for this character's properties
-	ALocalMultiplayerDemoGameModeBase();
-
-protected:
-
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-	// Player One Reference
-	UPROPERTY()
-	class AP1_Character* PlayerOneInWorld;
-
-	// Level Reference
-	class ALevelScriptActor* LevelActorInstance;
-
-	// Level Name
-	static const FString MyLevelName;
-
-public:
-
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-	
-	// Load UI Method
-	void LoadTwoPlayerWidget(float dTime);
-
-	// Two Player Variable
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Play Mode")
-	bool isTwoPlayerMode;
-
-public:
-
-	// Struct Reference
-	UPROPERTY(EditDefaultsOnly, Category = "Setup")
-	FRespawnSettings RespawnSetup;
-
-	// Populate World With Respawn Locations
-	void CreateRespawnPoints();
-	
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameModeBase.h"
+#include "LocalMultiplayerDemoGameModeBase.generated.h"
+
+USTRUCT(BlueprintType)
+struct FRespawnSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	FVector RespawnPosition_1;
+	
+	UPROPERTY()
+	FVector RespawnPosition_2;
+	
+	UPROPERTY()
+	FVector RespawnPosition_3;
+	
+	UPROPERTY()
+	FVector RespawnPosition_4;
+
+	// Respawn positions, in the RespawnIndex order CreateRespawnPoints gives them
+	void GetRespawnPositions(TArray<FVector>& OutPositions) const
+	{
+		OutPositions.Reset(4);
+		OutPositions.Add(RespawnPosition_1);
+		OutPositions.Add(RespawnPosition_2);
+		OutPositions.Add(RespawnPosition_3);
+		OutPositions.Add(RespawnPosition_4);
+	}
+
+};
+
+// Ticks the game mode's managers apart from the game mode itself, so they can run while physics simulates
+USTRUCT()
+struct FGameModeManagersTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	class ALocalMultiplayerDemoGameModeBase* Target;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+
+};
+
+template<>
+struct TStructOpsTypeTraits<FGameModeManagersTickFunction> : public TStructOpsTypeTraitsBase2<FGameModeManagersTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+// Character that died
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlayerDied, class ACharacter*);
+
+// Character that came back, and the index of the respawn point it came back at
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPlayerRespawned, class ACharacter*, int32);
+
+UCLASS(config = Game)
+class LOCALMULTIPLAYERDEMO_API ALocalMultiplayerDemoGameModeBase : public AGameModeBase
+{
+	GENERATED_BODY()
+	
+private:
+
+	// Two Player Mode Variables
+	bool hasSetSecondPlayer;
+	bool canFinishSetup;
+
+	// Load Widget Variables
+	bool canSetWidget;
+
+	// When BeginPlay ran, in FPlatformTime::Seconds() and GFrameCounter
+	double BeginPlayTime;
+	uint64 BeginPlayFrame;
+	
+	// Method to Spawn Player Two
+	void SetupTwoPlayers();
+
+	// True once every local player has possessed its pawn and has a player state, and the UI owner has its HUD
+	bool AreLocalPlayersReady() const;
+
+	// Cached by GetArenaNetCullDistanceSquared, 0 until first asked
+	float ArenaNetCullDistanceSquared;
+
+	// Trigger Methods
+	void SetupTriggerManager();
+	void HandlePickupCollected(class ACharacter* Collector, int32 Score);
+	void HandleCharacterKilled(class ACharacter* Character);
+
+	// Respawn points registered by the points themselves, across every level that is shown
+	UPROPERTY()
+	TArray<class ARespawnPoint*> RespawnPoints;
+
+	// Load the respawn table baked for a map or arena, if there is one that matches its respawn points
+	void LoadRespawnBake(const FString& MapName, const TArray<FVector>& RespawnPositions);
+	void OnRespawnBakeLoaded(const FName& PackageName, class UPackage* Package, EAsyncLoadingResult::Type Result, FString MapName, TArray<FVector> RespawnPositions);
+
+	// Map or arena the respawn bake being loaded or used is for
+	FString RespawnBakeMapName;
+
+	// Move everyone onto the new arena's respawn points
+	void HandleArenaShown(const FString& ArenaName, bool bReplaced);
+
+	// How long the last ResetRound took, in ms
+	float LastRoundResetTime;
+	
+public:
+
+	// Sets default values for this character's properties
+	ALocalMultiplayerDemoGameModeBase();
+
+protected:
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or the map changes
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Registers ManagersTick along with the game mode's own tick
+	virtual void RegisterActorTickFunctions(bool bRegister) override;
+
+	// Called as players join and leave
+	virtual void PostLogin(APlayerController* NewPlayer) override;
+	virtual void Logout(AController* Exiting) override;
+
+	// Player One Reference
+	UPROPERTY()
+	class AP1_Character* PlayerOneInWorld;
+
+	// Level Reference. Weak, the level owns it and it goes when the map changes.
+	TWeakObjectPtr<class ALevelScriptActor> LevelActorInstance;
+
+public:
+
+	// Called every frame. Sets up two players, updates every character's respawn state and moves the arena
+	// rotation on. All of them move capsules, so it runs before physics.
+	virtual void Tick(float DeltaTime) override;
+
+	// Kill-cam recording, the frame budget governor and the world checksum. None of them move anything physics
+	// simulates, so they tick in the gameplay tick group after the trigger manager's pickups and kills.
+	UPROPERTY()
+	FGameModeManagersTickFunction ManagersTick;
+
+	// Called every frame by ManagersTick
+	void TickManagers(float DeltaTime);
+	
+	// Load UI Method
+	void LoadTwoPlayerWidget();
+
+	// True once every local player is set up and the two player UI has been created
+	FORCEINLINE bool IsSetupComplete() const { return canSetWidget; }
+
+	// When BeginPlay ran, to time setup from
+	FORCEINLINE double GetBeginPlayTime() const { return BeginPlayTime; }
+	FORCEINLINE uint64 GetBeginPlayFrame() const { return BeginPlayFrame; }
+
+	// Spawns the default pawn for a player
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
+
+	// Two Player Variable
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Play Mode")
+	bool isTwoPlayerMode;
+
+	// Run player input and character movement in fixed size steps, interpolating what is rendered
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Simulation")
+	bool bUseFixedTimestep;
+
+	// Simulation rate in Hz when bUseFixedTimestep is set
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Simulation", meta = (ClampMin = "10"))
+	float FixedTimestepRate;
+
+	// Most steps a single frame may run before the rest of the frame time is dropped
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Simulation", meta = (ClampMin = "1"))
+	int32 MaxFixedSubsteps;
+
+	// Upper limit on how far away players stay relevant to each other online, in cm
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Networking", meta = (ClampMin = "1000"))
+	float MaxNetCullDistance;
+
+	// Squared net cull distance covering the whole arena, so every player in it stays relevant to every other
+	float GetArenaNetCullDistanceSquared();
+
+	// Persistent map two player mode is played in. Arenas stream in as its sub-levels.
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Play Mode")
+	FString TwoPlayerLevelName;
+
+	// True when the world's persistent map is TwoPlayerLevelName
+	static bool IsTwoPlayerLevel(const class UWorld* World);
+
+	// Start a new round without reloading the map. Every pawn goes back to a respawn point alive, standing and with
+	// no score, and collected pickups come back. Actors, controllers and the UI are all kept, so it's done in the frame
+	// it is called in. Also "LocalMultiplayer.ResetRound" from the console.
+	UFUNCTION(BlueprintCallable, Category = "Play Mode")
+	void ResetRound();
+
+	// Warn when ResetRound takes longer than this many ms, a share of the frame it runs in
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Play Mode", meta = (ClampMin = "0"))
+	float RoundResetBudget;
+
+	// How long the last ResetRound took in ms, 0 before the first one
+	FORCEINLINE float GetLastRoundResetTime() const { return LastRoundResetTime; }
+
+public:
+
+	// Struct Reference. Config so respawn layouts can be tried from an ini without rebuilding.
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Setup")
+	FRespawnSettings RespawnSetup;
+
+	// Seconds a dead player waits before respawning
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Setup", meta = (ClampMin = "0"))
+	float RespawnDelay;
+
+	// Fired as players die and respawn
+	FOnPlayerDied OnPlayerDied;
+	FOnPlayerRespawned OnPlayerRespawned;
+
+	// Controller, pawn, player state and HUD of every local player slot
+	UPROPERTY()
+	class UPlayerRegistry* PlayerRegistry;
+
+	// Score pickups and kill volumes for the arena, the level's own or one spawned at BeginPlay
+	UPROPERTY()
+	class ATriggerManager* TriggerManager;
+
+	// Arenas played in turn as streaming sub-levels of the persistent map
+	UPROPERTY()
+	class UArenaRotation* ArenaRotation;
+
+	// Last few seconds of every character, replayed to local players while they wait to respawn
+	UPROPERTY()
+	class UKillCamRecorder* KillCamRecorder;
+
+	// Steps gameplay detail down and back up to hold the frame rate as split-screen players join
+	UPROPERTY()
+	class UFrameBudgetGovernor* FrameBudgetGovernor;
+
+	// Hashes gameplay state every frame when enabled, to find where two runs stop matching
+	UPROPERTY()
+	class UWorldStateChecksum* WorldChecksum;
+
+	// Dead or alive and respawn countdowns of every player two and bot, in arrays updated in one pass
+	UPROPERTY()
+	class UCharacterStateManager* CharacterState;
+
+	// Seed for GameplayRandom, 0 for a different one every run. Set it to repeat a run.
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Simulation")
+	int32 RandomSeed;
+
+	// Every random choice gameplay makes comes from here, so a seed repeats a run and its state can be checksummed
+	FRandomStream GameplayRandom;
+
+	// Restart GameplayRandom from a seed, e.g. for each match of the match simulator
+	void SetRandomSeed(int32 Seed);
+
+	// The game mode's GameplayRandom, or one shared unseeded stream where there is no game mode (e.g. network clients)
+	static FRandomStream& GetGameplayRandom(const UObject* WorldContextObject);
+
+	// Populate World With Respawn Locations, for maps that don't place their own
+	void CreateRespawnPoints();
+
+	// Called by respawn points as their level is shown and hidden
+	void RegisterRespawnPoint(class ARespawnPoint* Point);
+	void UnregisterRespawnPoint(class ARespawnPoint* Point);
+
+	// Respawn points of the arena being played in RespawnIndex order, or every registered point without arenas
+	void GetRespawnPoints(TArray<class ARespawnPoint*>& OutPoints) const;
+
+	// Offline baked visibility/path distance table for the current map (NULL if the map was never baked)
+	UPROPERTY(Transient)
+	class URespawnBakeData* RespawnBakeData;
+
+	// Package name the respawn bake commandlet saves to for a given map
+	static FString GetRespawnBakePackageName(const FString& MapName);
+
+};
@@ -1,49 +1,156 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "LocalMultiplayerDemoHUD.h"
-#include "LocalMultiplayerDemo.h"
-#include "Runtime/UMG/Public/UMG.h"
-#include "Runtime/UMG/Public/UMGStyle.h"
-#include "Runtime/UMG/Public/Slate/SObjectWidget.h"
-#include "Runtime/UMG/Public/IUMGModule.h"
-#include "Runtime/UMG/Public/Blueprint/UserWidget.h"
-#include "UObject/ConstructorHelpers.h"
-
-ALocalMultiplayerDemoHUD::ALocalMultiplayerDemoHUD()
-{
-	static ConstructorHelpers::FClassFinder<UUserWidget> WidgetAsset(TEXT("/Game/Blueprints/PlayerUI"));
-
-	if (WidgetAsset.Succeeded())
-	{
-		PlayerWidgetClass = WidgetAsset.Class;
-	}
-}
-
-// Called when the game starts or when spawned
-void ALocalMultiplayerDemoHUD::BeginPlay()
-{
-	Super::BeginPlay();
-
-	// If one player game, you can create widget here
-}
-
-// Create 2P widget and add to viewport
-void ALocalMultiplayerDemoHUD::CreateTwoPlayerUI()
-{
-	class UWorld* const world = GetWorld();
-
-	if (world != NULL)
-	{
-		if (PlayerWidgetClass != NULL) 
-		{
-			PlayerUI = CreateWidget<UUserWidget>(world, PlayerWidgetClass);
-
-			if (PlayerUI != NULL)
-				PlayerUI->AddToViewport();
-		}
-	}
-}
-
-
-
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocalMultiplayerDemoHUD.h"
+#include "LocalMultiplayerDemo.h"
+#include "Runtime/UMG/Public/UMG.h"
+#include "Runtime/UMG/Public/UMGStyle.h"
+#include "Runtime/UMG/Public/Slate/SObjectWidget.h"
+#include "Runtime/UMG/Public/IUMGModule.h"
+#include "Runtime/UMG/Public/Blueprint/UserWidget.h"
+#include "UObject/ConstructorHelpers.h"
+#include "PlayerMemoryReport.h"
+#include "PlayerRegistry.h"
+#include "HitchDetector.h"
+#include "P1_Character.h"
+#include "P2_Character.h"
+#include "Engine/Canvas.h"
+#include "CanvasItem.h"
+#include "Engine/Font.h"
+
+DECLARE_CYCLE_STAT(TEXT("Native HUD Draw"), STAT_NativeHUDDraw, STATGROUP_LocalMultiplayerDemo);
+DECLARE_CYCLE_STAT(TEXT("UI Create"), STAT_UICreate, STATGROUP_LocalMultiplayerDemo);
+
+static int32 GUseNativeHUD = 0;
+static FAutoConsoleVariableRef CVarUseNativeHUD(
+	TEXT("LocalMultiplayer.NativeHUD"),
+	GUseNativeHUD,
+	TEXT("0 = UMG PlayerUI widget, 1 = native Canvas UI drawn into each player's split-screen area. Takes effect when players are set up."));
+
+// Layout of the native UI, in pixels from the top left of each player's view
+static const FVector2D NativeHUDOrigin(24.f, 24.f);
+static const FVector2D NativeHUDSize(220.f, 56.f);
+static const FVector2D NativeHUDPadding(10.f, 6.f);
+static const float NativeHUDLineHeight = 22.f;
+
+ALocalMultiplayerDemoHUD::ALocalMultiplayerDemoHUD()
+{
+	PlayerWidgetClass = NULL;
+
+	// No UI on a dedicated server
+#if !UE_SERVER
+	static ConstructorHelpers::FClassFinder<UUserWidget> WidgetAsset(TEXT("/Game/Blueprints/PlayerUI"));
+
+	if (WidgetAsset.Succeeded())
+	{
+		PlayerWidgetClass = WidgetAsset.Class;
+	}
+#endif
+
+	PlayerUI = NULL;
+	StatusColor = FLinearColor::White;
+	NativeFont = NULL;
+	ShownScore = MIN_int32;
+	ShownRespawnSeconds = MIN_int32;
+}
+
+// Called when the game starts or when spawned
+void ALocalMultiplayerDemoHUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// If one player game, you can create widget here
+
+	// Font isn't available when the class default object is constructed
+	NativeFont = GEngine ? GEngine->GetMediumFont() : NULL;
+}
+
+bool ALocalMultiplayerDemoHUD::UseNativeHUD()
+{
+	return GUseNativeHUD != 0;
+}
+
+// Create 2P widget and add to viewport
+void ALocalMultiplayerDemoHUD::CreateTwoPlayerUI()
+{
+	// The native UI draws itself from DrawHUD, there is no widget to create
+	if (UseNativeHUD())
+		return;
+
+	class UWorld* const world = GetWorld();
+
+	if (world != NULL)
+	{
+		if (PlayerWidgetClass != NULL) 
+		{
+			LLM_SCOPE_PLAYER_SLOT(UPlayerRegistry::GetSlotIndex(PlayerOwner));
+			SCOPE_HITCH_CYCLE_COUNTER(STAT_UICreate, EHitchSection::UICreate);
+
+			PlayerUI = CreateWidget<UUserWidget>(world, PlayerWidgetClass);
+
+			if (PlayerUI != NULL)
+				PlayerUI->AddToViewport();
+		}
+	}
+}
+
+// Draw this player's score and status into its own split-screen view.
+// The items are cheap stack objects around cached text, and the text only changes when the values do, so steady state
+// draws don't allocate.
+void ALocalMultiplayerDemoHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	if (!UseNativeHUD() || Canvas == nullptr || PlayerOwner == nullptr || PlayerOwner->GetPawn() == nullptr)
+		return;
+
+	SCOPE_HITCH_CYCLE_COUNTER(STAT_NativeHUDDraw, EHitchSection::NativeHUDDraw);
+
+	UpdateNativeText();
+
+	FCanvasTileItem BackgroundItem(NativeHUDOrigin, NativeHUDSize, FLinearColor(0.f, 0.f, 0.f, 0.5f));
+	BackgroundItem.BlendMode = SE_BLEND_Translucent;
+
+	FCanvasTextItem ScoreTextItem(NativeHUDOrigin + NativeHUDPadding, ScoreText, NativeFont, FLinearColor::White);
+	FCanvasTextItem StatusTextItem(NativeHUDOrigin + NativeHUDPadding + FVector2D(0.f, NativeHUDLineHeight), StatusText, NativeFont, StatusColor);
+
+	// Tiles first, then text, so the canvas can batch each kind together
+	Canvas->DrawItem(BackgroundItem);
+	Canvas->DrawItem(ScoreTextItem);
+	Canvas->DrawItem(StatusTextItem);
+}
+
+void ALocalMultiplayerDemoHUD::UpdateNativeText()
+{
+	int32 Score = 0;
+	int32 RespawnSeconds = INDEX_NONE;
+
+	if (class AP1_Character* PlayerOne = Cast<AP1_Character>(PlayerOwner->GetPawn()))
+	{
+		Score = PlayerOne->TotalScore;
+	}
+	else if (class AP2_Character* PlayerTwo = Cast<AP2_Character>(PlayerOwner->GetPawn()))
+	{
+		Score = PlayerTwo->TotalScore;
+
+		if (PlayerTwo->isDead)
+			RespawnSeconds = FMath::CeilToInt(FMath::Max(PlayerTwo->GetRespawnCountdown(), 0.f));
+	}
+
+	if (Score != ShownScore)
+	{
+		ShownScore = Score;
+		ScoreText = FText::Format(NSLOCTEXT("LocalMultiplayerDemoHUD", "Score", "Score: {0}"), FText::AsNumber(Score));
+	}
+
+	if (RespawnSeconds != ShownRespawnSeconds)
+	{
+		ShownRespawnSeconds = RespawnSeconds;
+
+		if (RespawnSeconds == INDEX_NONE)
+			StatusText = NSLOCTEXT("LocalMultiplayerDemoHUD", "Alive", "Alive");
+		else
+			StatusText = FText::Format(NSLOCTEXT("LocalMultiplayerDemoHUD", "Respawning", "Respawning in {0}"), FText::AsNumber(RespawnSeconds));
+
+		StatusColor = RespawnSeconds == INDEX_NONE ? FLinearColor::White : FLinearColor::Red;
+	}
+}
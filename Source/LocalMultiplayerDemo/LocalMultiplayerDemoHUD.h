@@ -1,34 +1,59 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/HUD.h"
-#include "LocalMultiplayerDemoHUD.generated.h"
-
-UCLASS()
-class LOCALMULTIPLAYERDEMO_API ALocalMultiplayerDemoHUD : public AHUD
-{
-	GENERATED_BODY()
-		
-public:
-
-	ALocalMultiplayerDemoHUD();
-	
-protected:
-
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-public:
-
-	// Widget Blueprint Class
-	TSubclassOf<class UUserWidget> PlayerWidgetClass;
-
-	// Point to Widget Class
-	class UUserWidget* PlayerUI;
-
-	// Widget Method
-	void CreateTwoPlayerUI();
-
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "LocalMultiplayerDemoHUD.generated.h"
+
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API ALocalMultiplayerDemoHUD : public AHUD
+{
+	GENERATED_BODY()
+		
+public:
+
+	ALocalMultiplayerDemoHUD();
+	
+protected:
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:
+
+	// Widget Blueprint Class
+	UPROPERTY()
+	TSubclassOf<class UUserWidget> PlayerWidgetClass;
+
+	// Point to Widget Class
+	UPROPERTY(Transient)
+	class UUserWidget* PlayerUI;
+
+	// Widget Method
+	void CreateTwoPlayerUI();
+
+	// Draws the native split-screen UI when it is selected instead of the PlayerUI widget
+	virtual void DrawHUD() override;
+
+	// True when "LocalMultiplayer.NativeHUD" selects the Canvas UI over the UMG PlayerUI widget
+	static bool UseNativeHUD();
+
+private:
+
+	// Native UI text, only re-formatted when the values change
+	FText ScoreText;
+	FText StatusText;
+	FLinearColor StatusColor;
+
+	UPROPERTY(Transient)
+	class UFont* NativeFont;
+
+	// Values the text currently shows
+	int32 ShownScore;
+	int32 ShownRespawnSeconds;
+
+	// Refresh the cached text from the owning player's pawn
+	void UpdateNativeText();
+
+};
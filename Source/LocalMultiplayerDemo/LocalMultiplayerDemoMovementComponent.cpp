@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocalMultiplayerDemoMovementComponent.h"
+#include "LocalMultiplayerDemo.h"
+#include "GameFramework/Character.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lightweight Movers"), STAT_LightweightMovers, STATGROUP_LocalMultiplayerDemo);
+
+static int32 GLightweightMovement = 1;
+static FAutoConsoleVariableRef CVarLightweightMovement(
+	TEXT("LocalMultiplayer.LightweightMovement"),
+	GLightweightMovement,
+	TEXT("1 = bots no local player is looking at use navmesh walking at a reduced tick rate, 0 = everyone uses full movement"));
+
+ULocalMultiplayerDemoMovementComponent::ULocalMultiplayerDemoMovementComponent()
+{
+	bEnableLightweightMovement = true;
+	LightweightTickInterval = 0.1f;
+	NotViewedTime = 0.5f;
+	InteractionFullMovementTime = 2.f;
+	LastInteractionTime = -MAX_flt;
+}
+
+void ULocalMultiplayerDemoMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	UpdateLightweightMode();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+}
+
+void ULocalMultiplayerDemoMovementComponent::NotifyInteraction()
+{
+	if (class UWorld* const world = GetWorld())
+		LastInteractionTime = world->GetTimeSeconds();
+
+	UpdateLightweightMode();
+}
+
+void ULocalMultiplayerDemoMovementComponent::UpdateLightweightMode()
+{
+	const bool bWantsLightweight = ShouldUseLightweightMovement();
+
+	if (bWantsLightweight && MovementMode == MOVE_Walking)
+	{
+		SetMovementMode(MOVE_NavWalking);
+	}
+	else if (!bWantsLightweight && IsLightweight())
+	{
+		SetMovementMode(MOVE_Walking);
+	}
+}
+
+bool ULocalMultiplayerDemoMovementComponent::ShouldUseLightweightMovement() const
+{
+	class UWorld* const world = GetWorld();
+
+	if (!GLightweightMovement || !bEnableLightweightMovement || CharacterOwner == nullptr || world == nullptr)
+		return false;
+
+	// Bots only. Players move from their own input, and online their client's moves are replayed on the server.
+	if (CharacterOwner->IsPlayerControlled() || CharacterOwner->Role != ROLE_Authority)
+		return false;
+
+	// Navmesh walking needs a navmesh to project onto
+	if (GetNavData() == nullptr)
+		return false;
+
+	if (world->GetTimeSeconds() - LastInteractionTime < InteractionFullMovementTime)
+		return false;
+
+	// Rendered in any split-screen view counts as viewed
+	return !CharacterOwner->WasRecentlyRendered(NotViewedTime);
+}
+
+// Tick slower while in the cheap mode, whoever switched us in or out of it
+void ULocalMultiplayerDemoMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	if (PreviousMovementMode == MOVE_NavWalking && !IsLightweight())
+	{
+		SetComponentTickInterval(0.f);
+		DEC_DWORD_STAT(STAT_LightweightMovers);
+	}
+	else if (PreviousMovementMode != MOVE_NavWalking && IsLightweight())
+	{
+		SetComponentTickInterval(LightweightTickInterval);
+		INC_DWORD_STAT(STAT_LightweightMovers);
+	}
+}
+
+void ULocalMultiplayerDemoMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (IsLightweight())
+		DEC_DWORD_STAT(STAT_LightweightMovers);
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "LocalMultiplayerDemoMovementComponent.generated.h"
+
+// Character movement that drops bots nobody is looking at into navmesh walking, which projects onto the navmesh
+// instead of sweeping for the floor and stepping up, and ticks them at a reduced rate until they are seen again.
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API ULocalMultiplayerDemoMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	ULocalMultiplayerDemoMovementComponent();
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+	// Something touched or hit the character, so give it full movement for a while
+	void NotifyInteraction();
+
+	// True while in the cheap movement mode
+	FORCEINLINE bool IsLightweight() const { return MovementMode == MOVE_NavWalking; }
+
+	// Allow this character to use the cheap movement mode when it is a bot and not being viewed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lightweight Movement")
+	bool bEnableLightweightMovement;
+
+	// Seconds between movement updates in the cheap mode
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lightweight Movement", meta = (ClampMin = "0"))
+	float LightweightTickInterval;
+
+	// How long since any local player last rendered the character before it counts as not viewed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lightweight Movement", meta = (ClampMin = "0"))
+	float NotViewedTime;
+
+	// Seconds of full movement after an interaction
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Lightweight Movement", meta = (ClampMin = "0"))
+	float InteractionFullMovementTime;
+
+protected:
+
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	// Switch between full and cheap movement when needed
+	void UpdateLightweightMode();
+	bool ShouldUseLightweightMovement() const;
+
+	// World time of the last interaction
+	float LastInteractionTime;
+
+};
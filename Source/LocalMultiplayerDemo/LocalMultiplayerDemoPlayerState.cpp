@@ -1,14 +1,24 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "LocalMultiplayerDemoPlayerState.h"
-#include "LocalMultiplayerDemo.h"
-
-ALocalMultiplayerDemoPlayerState::ALocalMultiplayerDemoPlayerState()
-{
-	TotalScore_P1 = 0;
-	TotalScore_P2 = 0;
-}
-
-
-
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "LocalMultiplayerDemo.h"
+#include "Net/UnrealNetwork.h"
+
+ALocalMultiplayerDemoPlayerState::ALocalMultiplayerDemoPlayerState()
+{
+	TotalScore_P1 = 0;
+	TotalScore_P2 = 0;
+}
+
+void ALocalMultiplayerDemoPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Scores only go out when they change
+	DOREPLIFETIME(ALocalMultiplayerDemoPlayerState, TotalScore_P1);
+	DOREPLIFETIME(ALocalMultiplayerDemoPlayerState, TotalScore_P2);
+}
+
+
+
+
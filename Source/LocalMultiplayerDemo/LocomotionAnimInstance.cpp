@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocomotionAnimInstance.h"
+#include "LocalMultiplayerDemo.h"
+#include "Animation/AnimSequenceBase.h"
+#include "Animation/BlendSpaceBase.h"
+#include "UObject/ConstructorHelpers.h"
+
+ULocomotionAnimInstance::ULocomotionAnimInstance()
+{
+	StandBlendSpace = NULL;
+	CrouchBlendSpace = NULL;
+	ProneIdle = NULL;
+	StandToCrouch = NULL;
+	CrouchToStand = NULL;
+	StandToProne = NULL;
+	ProneToStand = NULL;
+
+	// Nothing is animated on a dedicated server, so it doesn't load the animations
+#if !UE_SERVER
+	static ConstructorHelpers::FObjectFinder<UBlendSpaceBase> StandBlendSpaceObj(TEXT("/Game/AnimStarterPack/BS_Jog"));
+	static ConstructorHelpers::FObjectFinder<UBlendSpaceBase> CrouchBlendSpaceObj(TEXT("/Game/AnimStarterPack/BS_CrouchWalk"));
+	static ConstructorHelpers::FObjectFinder<UAnimSequenceBase> ProneIdleObj(TEXT("/Game/AnimStarterPack/Prone_Idle"));
+	static ConstructorHelpers::FObjectFinder<UAnimSequenceBase> StandToCrouchObj(TEXT("/Game/AnimStarterPack/Stand_to_Crouch_Rifle_Hip"));
+	static ConstructorHelpers::FObjectFinder<UAnimSequenceBase> CrouchToStandObj(TEXT("/Game/AnimStarterPack/Crouch_to_Stand_Rifle_Hip"));
+	static ConstructorHelpers::FObjectFinder<UAnimSequenceBase> StandToProneObj(TEXT("/Game/AnimStarterPack/Stand_To_Prone"));
+	static ConstructorHelpers::FObjectFinder<UAnimSequenceBase> ProneToStandObj(TEXT("/Game/AnimStarterPack/Prone_To_Stand"));
+
+	StandBlendSpace = StandBlendSpaceObj.Object;
+	CrouchBlendSpace = CrouchBlendSpaceObj.Object;
+	ProneIdle = ProneIdleObj.Object;
+	StandToCrouch = StandToCrouchObj.Object;
+	CrouchToStand = CrouchToStandObj.Object;
+	StandToProne = StandToProneObj.Object;
+	ProneToStand = ProneToStandObj.Object;
+#endif
+
+	// Default Values for Variables
+	InputStance = ECharacterStance::Stand;
+	InputForward = 0.f;
+	InputRight = 0.f;
+}
+
+void ULocomotionAnimInstance::SetLocomotionInput(ECharacterStance InStance, float InForward, float InRight)
+{
+	InputStance = InStance;
+	InputForward = InForward;
+	InputRight = InRight;
+}
+
+void ULocomotionAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeUpdateAnimation(DeltaSeconds);
+
+	Locomotion.Forward = InputForward;
+	Locomotion.Right = InputRight;
+
+	// Start a transition when the stance changes, cutting short any transition already playing
+	if (InputStance != Locomotion.Stance)
+	{
+		Locomotion.PreviousStance = Locomotion.Stance;
+		Locomotion.Stance = InputStance;
+		Locomotion.TransitionAnim = GetTransitionAnim(Locomotion.PreviousStance, Locomotion.Stance);
+		Locomotion.TransitionTime = 0.f;
+		Locomotion.bInTransition = Locomotion.TransitionAnim != nullptr;
+
+		switch (Locomotion.Stance)
+		{
+		case ECharacterStance::Crouch:
+			Locomotion.BlendSpace = CrouchBlendSpace;
+			Locomotion.IdleAnim = NULL;
+			break;
+		case ECharacterStance::Prone:
+			Locomotion.BlendSpace = NULL;
+			Locomotion.IdleAnim = ProneIdle;
+			break;
+		default:
+			Locomotion.BlendSpace = StandBlendSpace;
+			Locomotion.IdleAnim = NULL;
+			break;
+		}
+
+		Locomotion.bHasBlendSpace = Locomotion.BlendSpace != nullptr;
+	}
+	else if (Locomotion.BlendSpace == nullptr && Locomotion.IdleAnim == nullptr)
+	{
+		// First update, standing
+		Locomotion.BlendSpace = StandBlendSpace;
+		Locomotion.bHasBlendSpace = StandBlendSpace != nullptr;
+	}
+
+	// Play the transition through once, then hand over to the stance's own animation
+	if (Locomotion.bInTransition)
+	{
+		Locomotion.TransitionTime += DeltaSeconds;
+
+		if (Locomotion.TransitionTime >= Locomotion.TransitionAnim->SequenceLength)
+		{
+			Locomotion.TransitionTime = Locomotion.TransitionAnim->SequenceLength;
+			Locomotion.bInTransition = false;
+		}
+	}
+}
+
+// The pack only has transitions to and from standing, so crouch to prone borrows stand to prone
+UAnimSequenceBase* ULocomotionAnimInstance::GetTransitionAnim(ECharacterStance From, ECharacterStance To) const
+{
+	switch (To)
+	{
+	case ECharacterStance::Crouch:
+		return From == ECharacterStance::Stand ? StandToCrouch : NULL;
+	case ECharacterStance::Prone:
+		return StandToProne;
+	default:
+		return From == ECharacterStance::Crouch ? CrouchToStand : ProneToStand;
+	}
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimInstance.h"
+#include "CharacterStance.h"
+#include "LocomotionAnimInstance.generated.h"
+
+// Native parent for the character AnimBPs. The character hands over its stance and run input with a plain function call,
+// and the stance's blend space, idle and transition are picked here into one FLocomotionAnimState for the graph to read.
+// Nothing is looked up by name, and the graph's bindings are all direct member reads, so the update stays on the fast path.
+UCLASS(Transient, Blueprintable)
+class LOCALMULTIPLAYERDEMO_API ULocomotionAnimInstance : public UAnimInstance
+{
+	GENERATED_BODY()
+
+public:
+
+	ULocomotionAnimInstance();
+
+	// Called by the character when its stance or run input changes, picked up on the next animation update
+	void SetLocomotionInput(ECharacterStance InStance, float InForward, float InRight);
+
+	// State for the anim graph. Read its members directly (Break Struct or member access, no function calls).
+	UPROPERTY(Transient, BlueprintReadOnly, Category = "Locomotion")
+	FLocomotionAnimState Locomotion;
+
+	// Locomotion Animations, from the AnimStarterPack by default
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UBlendSpaceBase* StandBlendSpace;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UBlendSpaceBase* CrouchBlendSpace;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* ProneIdle;
+
+	// Stance Transition Animations
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* StandToCrouch;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* CrouchToStand;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* StandToProne;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Locomotion")
+	class UAnimSequenceBase* ProneToStand;
+
+protected:
+
+	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+
+private:
+
+	// Animation to play going from one stance to another, NULL to cut straight over
+	class UAnimSequenceBase* GetTransitionAnim(ECharacterStance From, ECharacterStance To) const;
+
+	// Latest input from the character
+	ECharacterStance InputStance;
+	float InputForward;
+	float InputRight;
+
+};
@@ -0,0 +1,353 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MatchSimCommandlet.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "LocalMultiplayerDemoBotController.h"
+#include "TriggerManager.h"
+#include "P2_Character.h"
+#include "RespawnPoint.h"
+#include "ArenaRotation.h"
+#include "EngineUtils.h"
+#include "Engine/GameInstance.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "Containers/Ticker.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UMatchSimCommandlet::UMatchSimCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = true;
+	LogToConsole = true;
+
+	NumBots = 4;
+	MatchLength = 300.f;
+	TickRate = 30.f;
+	RespawnDelay = -1.f;
+	NumKillVolumes = 4;
+	KillVolumeSize = 150.f;
+	PickupGridSize = 8;
+	NumRespawnPoints = INDEX_NONE;
+	SimWorld = NULL;
+	CurrentResults = NULL;
+}
+
+int32 UMatchSimCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	// Map to play, defaults to the game's default map
+	if (ParamVals.Contains(TEXT("Map")))
+		MapPath = ParamVals[TEXT("Map")];
+	else
+		GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("GameDefaultMap"), MapPath, GEngineIni);
+
+	const int32 NumMatches = ParamVals.Contains(TEXT("Matches")) ? FCString::Atoi(*ParamVals[TEXT("Matches")]) : 100;
+	const int32 BaseSeed = ParamVals.Contains(TEXT("Seed")) ? FCString::Atoi(*ParamVals[TEXT("Seed")]) : 1;
+
+	if (ParamVals.Contains(TEXT("Bots")))
+		NumBots = FMath::Max(1, FCString::Atoi(*ParamVals[TEXT("Bots")]));
+
+	if (ParamVals.Contains(TEXT("MatchLength")))
+		MatchLength = FMath::Max(1.f, FCString::Atof(*ParamVals[TEXT("MatchLength")]));
+
+	if (ParamVals.Contains(TEXT("TickRate")))
+		TickRate = FMath::Max(1.f, FCString::Atof(*ParamVals[TEXT("TickRate")]));
+
+	if (ParamVals.Contains(TEXT("RespawnDelay")))
+		RespawnDelay = FCString::Atof(*ParamVals[TEXT("RespawnDelay")]);
+
+	if (ParamVals.Contains(TEXT("KillVolumes")))
+		NumKillVolumes = FMath::Max(0, FCString::Atoi(*ParamVals[TEXT("KillVolumes")]));
+
+	if (ParamVals.Contains(TEXT("KillVolumeSize")))
+		KillVolumeSize = FMath::Max(1.f, FCString::Atof(*ParamVals[TEXT("KillVolumeSize")]));
+
+	if (ParamVals.Contains(TEXT("PickupGrid")))
+		PickupGridSize = FMath::Max(0, FCString::Atoi(*ParamVals[TEXT("PickupGrid")]));
+
+	const FString OutPath = ParamVals.Contains(TEXT("Out")) ? ParamVals[TEXT("Out")]
+		: FPaths::ProfilingDir() / TEXT("MatchSim") / FString::Printf(TEXT("MatchSim-%s.csv"), *FDateTime::Now().ToString());
+
+	// A standalone game instance to load the map into, with no local players
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone();
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumRun = 0;
+
+	for (int32 Match = 0; Match < NumMatches; ++Match)
+	{
+		const int32 MatchSeed = BaseSeed + Match;
+		FMatchResults Results;
+
+		if (!RunMatch(*GameInstance->GetWorldContext(), MatchSeed, Results))
+			break;
+
+		// The header has a column per respawn point, which isn't known until the map is loaded
+		if (NumRun == 0 && !FFileHelper::SaveStringToFile(GetCsvHeader(), *OutPath))
+		{
+			UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("MatchSim: couldn't write %s"), *OutPath);
+			break;
+		}
+
+		// Written as we go, so an overnight run that dies part way still leaves its results
+		FFileHelper::SaveStringToFile(GetCsvRow(Match, MatchSeed, Results), *OutPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+		++NumRun;
+
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("MatchSim: match %d/%d, %d deaths, %.2fs"), Match + 1, NumMatches, Results.Deaths, Results.WallSeconds);
+	}
+
+	const double WallSeconds = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("MatchSim: %d matches (%.0f simulated seconds) in %.1fs, %.0fx real time. Results in %s"),
+		NumRun, NumRun * MatchLength, WallSeconds, WallSeconds > 0.0 ? NumRun * MatchLength / WallSeconds : 0.0, *OutPath);
+
+	if (UWorld* World = GameInstance->GetWorld())
+	{
+		World->DestroyWorld(false);
+		GEngine->DestroyWorldContext(World);
+	}
+
+	GameInstance->RemoveFromRoot();
+
+	return NumRun == NumMatches ? 0 : 1;
+}
+
+bool UMatchSimCommandlet::RunMatch(FWorldContext& WorldContext, int32 MatchSeed, FMatchResults& OutResults)
+{
+	const double MatchStartTime = FPlatformTime::Seconds();
+
+	// Same seed, same match
+	FMath::RandInit(MatchSeed);
+	FMath::SRandInit(MatchSeed);
+
+	// Loading the map again throws the last match's world away
+	FString Error;
+
+	if (!GEngine->LoadMap(WorldContext, FURL(NULL, *MapPath, TRAVEL_Absolute), NULL, Error))
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("MatchSim: couldn't load map '%s': %s"), *MapPath, *Error);
+		return false;
+	}
+
+	SimWorld = WorldContext.World();
+	class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(SimWorld->GetAuthGameMode());
+
+	if (GameMode == nullptr)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("MatchSim: %s doesn't use ALocalMultiplayerDemoGameModeBase"), *MapPath);
+		return false;
+	}
+
+	// The game mode seeded its own random stream as the map began play
+	GameMode->SetRandomSeed(MatchSeed);
+
+	// Bots read the respawn delay when they spawn
+	if (RespawnDelay >= 0.f)
+		GameMode->RespawnDelay = RespawnDelay;
+
+	// There are no players to trigger the game mode's own respawn point setup, so do what it would
+	if (!GameMode->ArenaRotation->IsActive() && !TActorIterator<ARespawnPoint>(SimWorld))
+		GameMode->CreateRespawnPoints();
+
+	GameMode->OnPlayerDied.AddUObject(this, &UMatchSimCommandlet::HandlePlayerDied);
+	GameMode->OnPlayerRespawned.AddUObject(this, &UMatchSimCommandlet::HandlePlayerRespawned);
+
+	UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(SimWorld);
+
+	if (NavSys != nullptr && NavSys->GetMainNavData() == nullptr)
+		NavSys->Build();
+
+	if (NavSys == nullptr || NavSys->GetMainNavData() == nullptr)
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("MatchSim: %s has no navmesh, bots will walk in straight lines"), *MapPath);
+
+	// The respawn points the bots will use, whether the map placed them or the game mode made them
+	TArray<class ARespawnPoint*> Points;
+	GameMode->GetRespawnPoints(Points);
+
+	if (NumRespawnPoints == INDEX_NONE)
+		NumRespawnPoints = Points.Num();
+	else if (Points.Num() != NumRespawnPoints)
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("MatchSim: match has %d respawn points, the CSV has columns for %d"), Points.Num(), NumRespawnPoints);
+
+	TArray<FVector> RespawnPositions;
+
+	for (class ARespawnPoint* Point : Points)
+		RespawnPositions.Add(Point->GetActorLocation());
+
+	// The arena is taken to be the area around the respawn points
+	const FBox Arena = FBox(RespawnPositions).ExpandBy(FVector(500.f, 500.f, 0.f));
+
+	if (class ATriggerManager* TriggerManager = GameMode->TriggerManager)
+	{
+		const FVector KillExtent(KillVolumeSize * 0.5f, KillVolumeSize * 0.5f, 200.f);
+
+		for (int32 KillVolume = 0; KillVolume < NumKillVolumes; ++KillVolume)
+		{
+			const FVector Center(GameMode->GameplayRandom.FRandRange(Arena.Min.X, Arena.Max.X), GameMode->GameplayRandom.FRandRange(Arena.Min.Y, Arena.Max.Y), Arena.GetCenter().Z);
+			TriggerManager->AddKillVolume(FBox(Center - KillExtent, Center + KillExtent));
+		}
+
+		for (int32 X = 0; X < PickupGridSize; ++X)
+		{
+			for (int32 Y = 0; Y < PickupGridSize; ++Y)
+			{
+				const FVector Alpha((X + 0.5f) / PickupGridSize, (Y + 0.5f) / PickupGridSize, 0.5f);
+				TriggerManager->AddPickup(Arena.Min + Arena.GetSize() * Alpha);
+			}
+		}
+	}
+
+	// Bots start on the respawn points in turn
+	OutResults.DeathsByRespawnPoint.SetNumZeroed(NumRespawnPoints + 1);
+	CurrentResults = &OutResults;
+	Lives.Reset();
+
+	TArray<class ACharacter*> Bots;
+	FActorSpawnParameters spawnParams;
+	spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for (int32 Bot = 0; Bot < NumBots; ++Bot)
+	{
+		const FVector SpawnPos = RespawnPositions.Num() > 0 ? RespawnPositions[Bot % RespawnPositions.Num()] : Arena.GetCenter();
+		class AP2_Character* BotCharacter = SimWorld->SpawnActor<AP2_Character>(AP2_Character::StaticClass(), SpawnPos, FRotator::ZeroRotator, spawnParams);
+		class ALocalMultiplayerDemoBotController* BotController = SimWorld->SpawnActor<ALocalMultiplayerDemoBotController>(ALocalMultiplayerDemoBotController::StaticClass());
+
+		if (BotCharacter == nullptr || BotController == nullptr)
+			continue;
+
+		BotController->Possess(BotCharacter);
+		Bots.Add(BotCharacter);
+
+		FLife& Life = Lives.Add(BotCharacter);
+		Life.StartTime = SimWorld->GetTimeSeconds();
+		Life.RespawnPoint = INDEX_NONE;
+		Life.EarlierLivesScore = 0;
+	}
+
+	// Fixed steps, as fast as they'll go
+	const float StepSeconds = 1.f / TickRate;
+	const int32 NumSteps = FMath::CeilToInt(MatchLength * TickRate);
+
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		SimWorld->Tick(LEVELTICK_All, StepSeconds);
+		FTicker::GetCoreTicker().Tick(StepSeconds);
+		++GFrameCounter;
+	}
+
+	// Lives still going at the end aren't counted as times alive, there's no death to measure to
+	for (class ACharacter* Bot : Bots)
+	{
+		const FLife* Life = Lives.Find(Bot);
+		const class AP2_Character* BotCharacter = Cast<AP2_Character>(Bot);
+
+		if (Life != nullptr && BotCharacter != nullptr)
+			OutResults.Scores.Add(Life->EarlierLivesScore + BotCharacter->TotalScore);
+	}
+
+	OutResults.WallSeconds = FPlatformTime::Seconds() - MatchStartTime;
+	CurrentResults = NULL;
+	Lives.Reset();
+	SimWorld = NULL;
+
+	return true;
+}
+
+void UMatchSimCommandlet::HandlePlayerDied(ACharacter* Character)
+{
+	FLife* Life = Lives.Find(Character);
+
+	if (Life == nullptr || CurrentResults == nullptr)
+		return;
+
+	CurrentResults->Deaths++;
+	CurrentResults->TimesAlive.Add(SimWorld->GetTimeSeconds() - Life->StartTime);
+
+	// Broadcast before the death resets the score, so bank this life's
+	if (const class AP2_Character* BotCharacter = Cast<AP2_Character>(Character))
+		Life->EarlierLivesScore += BotCharacter->TotalScore;
+
+	const int32 PointColumn = Life->RespawnPoint + 1;
+
+	if (CurrentResults->DeathsByRespawnPoint.IsValidIndex(PointColumn))
+		CurrentResults->DeathsByRespawnPoint[PointColumn]++;
+}
+
+void UMatchSimCommandlet::HandlePlayerRespawned(ACharacter* Character, int32 RespawnPoint)
+{
+	if (FLife* Life = Lives.Find(Character))
+	{
+		Life->StartTime = SimWorld->GetTimeSeconds();
+		Life->RespawnPoint = RespawnPoint;
+	}
+}
+
+FString UMatchSimCommandlet::GetCsvHeader() const
+{
+	FString Header = TEXT("Match,Seed,SimSeconds,WallSeconds,Bots,RespawnDelay,Deaths,DeathsFromInitialSpawn");
+
+	for (int32 Point = 0; Point < NumRespawnPoints; ++Point)
+		Header += FString::Printf(TEXT(",DeathsFromRespawn%d"), Point + 1);
+
+	Header += TEXT(",TimeAliveMean,TimeAliveP10,TimeAliveP50,TimeAliveP90,ScoreMin,ScoreMax,ScoreMean,ScoreStdDev\n");
+	return Header;
+}
+
+FString UMatchSimCommandlet::GetCsvRow(int32 Match, int32 MatchSeed, const FMatchResults& Results) const
+{
+	const float MatchRespawnDelay = RespawnDelay >= 0.f ? RespawnDelay : GetDefault<ALocalMultiplayerDemoGameModeBase>()->RespawnDelay;
+	FString Row = FString::Printf(TEXT("%d,%d,%.1f,%.3f,%d,%.2f,%d"), Match, MatchSeed, MatchLength, Results.WallSeconds, NumBots, MatchRespawnDelay, Results.Deaths);
+
+	for (int32 Deaths : Results.DeathsByRespawnPoint)
+		Row += FString::Printf(TEXT(",%d"), Deaths);
+
+	// Time alive distribution
+	TArray<float> TimesAlive = Results.TimesAlive;
+	TimesAlive.Sort();
+
+	auto Percentile = [&TimesAlive](float P) -> float
+	{
+		return TimesAlive.Num() > 0 ? TimesAlive[FMath::Clamp(FMath::FloorToInt(P * (TimesAlive.Num() - 1)), 0, TimesAlive.Num() - 1)] : 0.f;
+	};
+
+	float TimeAliveSum = 0.f;
+
+	for (float TimeAlive : TimesAlive)
+		TimeAliveSum += TimeAlive;
+
+	Row += FString::Printf(TEXT(",%.2f,%.2f,%.2f,%.2f"), TimesAlive.Num() > 0 ? TimeAliveSum / TimesAlive.Num() : 0.f, Percentile(0.1f), Percentile(0.5f), Percentile(0.9f));
+
+	// Score spread
+	int32 ScoreMin = 0;
+	int32 ScoreMax = 0;
+	float ScoreMean = 0.f;
+	float ScoreVariance = 0.f;
+
+	if (Results.Scores.Num() > 0)
+	{
+		ScoreMin = FMath::Min(Results.Scores);
+		ScoreMax = FMath::Max(Results.Scores);
+
+		for (int32 Score : Results.Scores)
+			ScoreMean += Score;
+
+		ScoreMean /= Results.Scores.Num();
+
+		for (int32 Score : Results.Scores)
+			ScoreVariance += FMath::Square(Score - ScoreMean);
+
+		ScoreVariance /= Results.Scores.Num();
+	}
+
+	Row += FString::Printf(TEXT(",%d,%d,%.2f,%.2f\n"), ScoreMin, ScoreMax, ScoreMean, FMath::Sqrt(ScoreVariance));
+	return Row;
+}
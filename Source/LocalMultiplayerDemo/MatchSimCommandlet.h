@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MatchSimCommandlet.generated.h"
+
+// Runs whole matches of the game mode back to back with bots in place of players, with no rendering, ticking at a
+// fixed timestep as fast as the CPU allows, and appends one row of summary statistics per match to a CSV file.
+// Usage: UE4Editor-Cmd LocalMultiplayerDemo.uproject -run=MatchSim -nullrhi [-Map=/Game/Path/To/Map] [-Matches=100]
+//        [-MatchLength=300] [-Bots=4] [-TickRate=30] [-RespawnDelay=3] [-KillVolumes=4] [-KillVolumeSize=150]
+//        [-PickupGrid=8] [-Seed=1] [-Out=Path/To/Results.csv]
+// Respawn layouts come from the game mode's RespawnSetup, which can be overridden with -ini:Game:[...]:RespawnSetup=(...)
+UCLASS()
+class UMatchSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UMatchSimCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	// Where a bot's current life started
+	struct FLife
+	{
+		float StartTime;
+		int32 RespawnPoint;
+
+		// Score of the lives before this one, a death resets TotalScore
+		int32 EarlierLivesScore;
+	};
+
+	// What happened in one match
+	struct FMatchResults
+	{
+		// Deaths counted against the respawn point the life started at. Index 0 is lives that started at the initial spawn.
+		TArray<int32> DeathsByRespawnPoint;
+		TArray<float> TimesAlive;
+
+		// Each bot's score over the whole match
+		TArray<int32> Scores;
+		int32 Deaths;
+		double WallSeconds;
+
+		FMatchResults() : Deaths(0), WallSeconds(0.0) {}
+	};
+
+	// Load the map, add bots, kill volumes and pickups, and tick the world to the end of the match
+	bool RunMatch(struct FWorldContext& WorldContext, int32 MatchSeed, FMatchResults& OutResults);
+
+	// Game mode events
+	void HandlePlayerDied(class ACharacter* Character);
+	void HandlePlayerRespawned(class ACharacter* Character, int32 RespawnPoint);
+
+	// CSV header and one row
+	FString GetCsvHeader() const;
+	FString GetCsvRow(int32 Match, int32 MatchSeed, const FMatchResults& Results) const;
+
+	// Settings from the command line
+	FString MapPath;
+	int32 NumBots;
+	float MatchLength;
+	float TickRate;
+	float RespawnDelay;
+	int32 NumKillVolumes;
+	float KillVolumeSize;
+	int32 PickupGridSize;
+
+	// Respawn points in the first match, one CSV column each
+	int32 NumRespawnPoints;
+
+	// State of the match being simulated
+	class UWorld* SimWorld;
+	TMap<class ACharacter*, FLife> Lives;
+	FMatchResults* CurrentResults;
+
+};
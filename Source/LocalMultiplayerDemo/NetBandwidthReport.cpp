@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NetBandwidthReport.h"
+#include "LocalMultiplayerDemo.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GNetReportCommand(
+	TEXT("LocalMultiplayer.NetReport"),
+	TEXT("Prints bytes and packets per second in and out for each network connection"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		FNetBandwidthReport::Print(World, Ar);
+	}));
+
+static void PrintConnection(const UNetConnection* Connection, FOutputDevice& Ar)
+{
+	const APlayerController* PlayerController = Connection->PlayerController;
+	const FString PlayerName = (PlayerController && PlayerController->PlayerState) ? PlayerController->PlayerState->PlayerName : FString(TEXT("(no player)"));
+
+	Ar.Logf(TEXT("  %s %s: out %d B/s (%d pkt/s), in %d B/s (%d pkt/s), ping %.0f ms"),
+		*Connection->LowLevelGetRemoteAddress(true), *PlayerName,
+		Connection->OutBytesPerSecond, Connection->OutPacketsPerSecond,
+		Connection->InBytesPerSecond, Connection->InPacketsPerSecond,
+		Connection->AvgLag * 1000.f);
+}
+
+void FNetBandwidthReport::Print(UWorld* World, FOutputDevice& Ar)
+{
+	const UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+
+	if (NetDriver == nullptr)
+	{
+		Ar.Logf(TEXT("Not networked"));
+		return;
+	}
+
+	// Clients have the one connection to the server
+	if (NetDriver->ServerConnection != nullptr)
+	{
+		Ar.Logf(TEXT("Server connection:"));
+		PrintConnection(NetDriver->ServerConnection, Ar);
+		return;
+	}
+
+	int32 TotalOut = 0;
+	int32 TotalIn = 0;
+
+	Ar.Logf(TEXT("%d client connections:"), NetDriver->ClientConnections.Num());
+
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection == nullptr)
+			continue;
+
+		PrintConnection(Connection, Ar);
+		TotalOut += Connection->OutBytesPerSecond;
+		TotalIn += Connection->InBytesPerSecond;
+	}
+
+	Ar.Logf(TEXT("Total: out %d B/s, in %d B/s"), TotalOut, TotalIn);
+}
@@ -0,0 +1,13 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Per connection bandwidth. Run "LocalMultiplayer.NetReport" in the console on a server or client.
+struct LOCALMULTIPLAYERDEMO_API FNetBandwidthReport
+{
+	// Bytes and packets per second over the last second, both directions, for every connection of the world's net driver
+	static void Print(class UWorld* World, FOutputDevice& Ar);
+
+};
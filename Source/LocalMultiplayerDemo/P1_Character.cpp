@@ -1,236 +1,630 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "P1_Character.h"
-#include "LocalMultiplayerDemo.h"
-#include "GameFramework/Controller.h"
-#include "GameFramework/PlayerController.h"
-#include "GameFramework/PlayerState.h"
-#include "LocalMultiplayerDemoPlayerState.h"
-#include "Components/SkeletalMeshComponent.h"
-#include "Components/CapsuleComponent.h"
-#include "Components/InputComponent.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "Animation/AnimInstance.h"
-#include "Runtime/Engine/Classes/Engine/LevelScriptActor.h"
-#include "UObject/ConstructorHelpers.h"
-
-const FName AP1_Character::HorizontalAnimName("Horizontal");
-const FName AP1_Character::VerticalAnimName("Vertical");
-const FString AP1_Character::MyLevelName("Minimal_Default");
-const FName AP1_Character::MyTagName("PlayerOne");
-
-// Sets default values
-AP1_Character::AP1_Character(const FObjectInitializer &ObjectInitializer) : Super(ObjectInitializer)
-{
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
-	// Don't rotate when the controller rotates. Let that just affect the camera.
-	bUseControllerRotationPitch = false;
-	bUseControllerRotationYaw = false;
-	bUseControllerRotationRoll = false;
-
-	// Set Collision Component
-	CollisionComp = GetCapsuleComponent();
-	CollisionComp->InitCapsuleSize(42.f, 96.0f);
-	CollisionComp->bHiddenInGame = false;
-	CollisionComp->bGenerateOverlapEvents = true;
-	CollisionComp->SetCollisionObjectType(ECollisionChannel::ECC_Pawn);
-
-	// Set Skeletal Mesh Component
-	PlayerMesh = GetMesh();
-	static ConstructorHelpers::FObjectFinder<USkeletalMesh> ObjMesh(TEXT("/Game/AnimStarterPack/UE4_Mannequin/Mesh/SK_Mannequin"));
-	PlayerMesh->SetSkeletalMesh(ObjMesh.Object);
-	PlayerMesh->SetRelativeLocation(FVector(0.f, 0.f, -95.f));
-	PlayerMesh->SetRelativeRotation(FRotator(0.f, -90.f, 0.f));
-	PlayerMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-
-	// Set Skeletal Mesh Animation Blueprint
-	static ConstructorHelpers::FClassFinder<UObject> AnimBPClass(TEXT("/Game/Blueprints/P1_AnimBP"));
-	PlayerMesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
-	PlayerMesh->SetAnimInstanceClass(AnimBPClass.Class);
-
-	// Set Character Movement Component Variables
-	CharacterMove = GetCharacterMovement();
-	CharacterMove->JumpZVelocity = 600.f;
-	CharacterMove->GravityScale = 1.f;
-	CharacterMove->bOrientRotationToMovement = true; // Character moves in the direction of input...	
-	CharacterMove->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
-
-	// Create Camera Spring Arm (pulls in towards the player if there is a collision)
-	CameraSpringArm = ObjectInitializer.CreateDefaultSubobject<USpringArmComponent>(this, TEXT("CameraSpringArm"));
-	CameraSpringArm->SetRelativeLocation(FVector(0.f, 0.f, 50.f));
-	CameraSpringArm->TargetArmLength = 300.0f; // The camera follows at this distance behind the character	
-	CameraSpringArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
-	CameraSpringArm->bDoCollisionTest = false;
-	CameraSpringArm->bAutoActivate = true;
-	CameraSpringArm->SetupAttachment(RootComponent);
-
-	// Create Player Camera
-	PlayerCamera = ObjectInitializer.CreateDefaultSubobject<UCameraComponent>(this, TEXT("PlayerCamera"));
-	PlayerCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
-	PlayerCamera->bAutoActivate = true;
-	PlayerCamera->SetupAttachment(CameraSpringArm, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
-
-	// Default Values for Variables
-	animInstance = NULL;
-	myPlayerState = NULL;
-	horizontal = 0.f;
-	vertical = 0.f;
-	TotalScore = 0;
-	BaseTurnRate = 45.f;
-	BaseLookUpRate = 45.f;
-	isTwoPlayerGame = false;
-	
-	// Actor Tag
-	this->Tags.Add(MyTagName);
-
-}
-
-#pragma region Setup Logic
-// Called when the game starts or when spawned
-void AP1_Character::BeginPlay()
-{
-	Super::BeginPlay();
-	FindPlayerState();
-
-	// Animation instance that allows us to change variables in animation blueprint
-	if (PlayerMesh)
-		animInstance = Cast<UAnimInstance>(PlayerMesh->GetAnimInstance());
-
-}
-
-void AP1_Character::FindPlayerState()
-{
-	class UWorld* const world = GetWorld();
-
-	if (world != nullptr)
-	{
-		class ALevelScriptActor* LevelActorInstance = Cast<ALevelScriptActor>(world->GetLevelScriptActor());
-		class APlayerController* PlConOne = Cast<APlayerController>(UGameplayStatics::GetPlayerController(world, 0));
-
-		if (PlConOne && LevelActorInstance)
-		{
-			if (LevelActorInstance->GetName().Contains(MyLevelName))
-			{
-				myPlayerState = Cast<ALocalMultiplayerDemoPlayerState>(PlConOne->PlayerState);
-			}
-		}
-	}
-}
-#pragma endregion
-
-// Called every frame
-void AP1_Character::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
-#pragma region Movement
-// Called to bind functionality to input
-void AP1_Character::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
-{
-	Super::SetupPlayerInputComponent(PlayerInputComponent);
-	PlayerInputComponent->BindAxis("MoveForward", this, &AP1_Character::MoveForward);
-	PlayerInputComponent->BindAxis("MoveRight", this, &AP1_Character::MoveRight);
-	PlayerInputComponent->BindAxis("TurnRate", this, &AP1_Character::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUpRate", this, &AP1_Character::LookUpAtRate);
-
-}
-
-void AP1_Character::MoveForward(float v)
-{
-	// Variable to track movement in editor
-	vertical = v;
-
-	// Animate
-	RunForwardAnimation(vertical);
-
-	if ((Controller != NULL) && (vertical != 0.0f))
-	{
-		// Find out which way is forward
-		const FRotator Rotation = Controller->GetControlRotation();
-		const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-		// Get forward vector
-		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-
-		// Add movement in that direction
-		AddMovementInput(Direction, vertical);
-	}
-}
-
-void AP1_Character::MoveRight(float h)
-{
-	// Variable to track movement in editor
-	horizontal = h;
-
-	// Animate
-	RunRightAnimation(horizontal);
-
-	if ((Controller != NULL) && (horizontal != 0.0f))
-	{
-		// Find out which way is right
-		const FRotator Rotation = Controller->GetControlRotation();
-		const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-		// Get right vector 
-		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
-
-		// Add movement in that direction
-		AddMovementInput(Direction, horizontal);
-	}
-}
-
-void AP1_Character::TurnAtRate(float Rate)
-{
-	// Calculate delta for this frame from the rate information
-	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
-}
-
-void AP1_Character::LookUpAtRate(float Rate)
-{
-	// Calculate delta for this frame from the rate information
-	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
-}
-#pragma endregion
-
-#pragma region Animations
-void AP1_Character::RunForwardAnimation(float amount)
-{
-	if (!animInstance)
-		return;
-
-	// Create pointer to the horizontal variable inside the animation blueprint
-	class UFloatProperty *forwardProp = FindField<UFloatProperty>(animInstance->GetClass(), HorizontalAnimName);
-
-	if (forwardProp != NULL)
-	{
-		float retVal = forwardProp->GetPropertyValue_InContainer(animInstance);
-
-		// Set value of horizontal variable
-		forwardProp->SetPropertyValue_InContainer(animInstance, amount);
-		retVal = forwardProp->GetPropertyValue_InContainer(animInstance);
-	}
-}
-
-void AP1_Character::RunRightAnimation(float amount)
-{
-	if (!animInstance)
-		return;
-
-	// Create pointer to the vertical variable inside the animation blueprint
-	class UFloatProperty *rightProp = FindField<UFloatProperty>(animInstance->GetClass(), VerticalAnimName);
-
-	if (rightProp != NULL)
-	{
-		float retVal = rightProp->GetPropertyValue_InContainer(animInstance);
-
-		// Set value of vertical variable
-		rightProp->SetPropertyValue_InContainer(animInstance, amount);
-		retVal = rightProp->GetPropertyValue_InContainer(animInstance);
-	}
-}
-#pragma endregion
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "P1_Character.h"
+#include "LocalMultiplayerDemo.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerState.h"
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "InputLatencyTracker.h"
+#include "PlayerRegistry.h"
+#include "LocalMultiplayerDemoMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Animation/AnimInstance.h"
+#include "LocomotionAnimInstance.h"
+#include "UObject/ConstructorHelpers.h"
+
+const FName AP1_Character::HorizontalAnimName("Horizontal");
+const FName AP1_Character::VerticalAnimName("Vertical");
+const FName AP1_Character::MyTagName("PlayerOne");
+
+// Sets default values
+AP1_Character::AP1_Character(const FObjectInitializer &ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<ULocalMultiplayerDemoMovementComponent>(ACharacter::CharacterMovementComponentName))
+{
+ 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Input, movement and respawning all move the capsule, so they have to be done before physics runs.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	// Don't rotate when the controller rotates. Let that just affect the camera.
+	bUseControllerRotationPitch = false;
+	bUseControllerRotationYaw = false;
+	bUseControllerRotationRoll = false;
+
+	// Set Collision Component
+	CollisionComp = GetCapsuleComponent();
+	CollisionComp->InitCapsuleSize(42.f, 96.0f);
+	CollisionComp->bHiddenInGame = false;
+	CollisionComp->bGenerateOverlapEvents = false; // Pickups and kill volumes are tested centrally by ATriggerManager
+	CollisionComp->SetCollisionObjectType(ECollisionChannel::ECC_Pawn);
+
+	// Set Skeletal Mesh Component
+	PlayerMesh = GetMesh();
+	PlayerMesh->SetRelativeLocation(FVector(0.f, 0.f, -95.f));
+	PlayerMesh->SetRelativeRotation(FRotator(0.f, -90.f, 0.f));
+	PlayerMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+
+	// The dedicated server never draws or animates the character, so it doesn't load the mesh or AnimBP
+#if !UE_SERVER
+	static ConstructorHelpers::FObjectFinder<USkeletalMesh> ObjMesh(TEXT("/Game/AnimStarterPack/UE4_Mannequin/Mesh/SK_Mannequin"));
+	PlayerMesh->SetSkeletalMesh(ObjMesh.Object);
+
+	// Set Skeletal Mesh Animation Blueprint
+	static ConstructorHelpers::FClassFinder<UObject> AnimBPClass(TEXT("/Game/Blueprints/P1_AnimBP"));
+	PlayerMesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
+	PlayerMesh->SetAnimInstanceClass(AnimBPClass.Class);
+#endif
+
+	// Set Character Movement Component Variables
+	CharacterMove = GetCharacterMovement();
+	CharacterMove->JumpZVelocity = 600.f;
+	CharacterMove->GravityScale = 1.f;
+	CharacterMove->bOrientRotationToMovement = true; // Character moves in the direction of input...	
+	CharacterMove->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
+	CharacterMove->MaxWalkSpeed = StanceSettings.Stand.MaxWalkSpeed;
+
+	// Replication. Movement goes out quantised to whole centimetres and byte sized rotation axes, a few dozen times a second.
+	// The net cull distance is set from the arena size in BeginPlay.
+	bReplicates = true;
+	bReplicateMovement = true;
+	NetUpdateFrequency = 30.f;
+	MinNetUpdateFrequency = 10.f;
+	NetPriority = 3.f;
+	ReplicatedMovement.LocationQuantizationLevel = EVectorQuantization::RoundWholeNumber;
+	ReplicatedMovement.VelocityQuantizationLevel = EVectorQuantization::RoundWholeNumber;
+	ReplicatedMovement.RotationQuantizationLevel = ERotatorQuantization::ByteComponents;
+
+	// The spring arm and camera are only created while a local player controls us, see CreatePlayerCamera
+	CameraSpringArm = NULL;
+	PlayerCamera = NULL;
+
+	// Default Values for Variables
+	animInstance = NULL;
+	locomotionAnim = NULL;
+	forwardAnimProp = NULL;
+	rightAnimProp = NULL;
+	Stance = ECharacterStance::Stand;
+	appliedStance = ECharacterStance::Stand;
+	myPlayerState = nullptr;
+	horizontal = 0.f;
+	vertical = 0.f;
+	TotalScore = 0;
+	BaseTurnRate = 45.f;
+	BaseLookUpRate = 45.f;
+	useFixedTimestep = false;
+	turnRateInput = 0.f;
+	runInputSendsLeft = 0;
+	lookUpRateInput = 0.f;
+	isTwoPlayerGame = false;
+	
+	// Actor Tag
+	this->Tags.Add(MyTagName);
+
+}
+
+#pragma region Setup Logic
+// Called when the game starts or when spawned
+void AP1_Character::BeginPlay()
+{
+	Super::BeginPlay();
+	FindPlayerState();
+
+	// Animation instance that allows us to change variables in animation blueprint
+	if (PlayerMesh)
+		animInstance = Cast<UAnimInstance>(PlayerMesh->GetAnimInstance());
+
+	// Nothing is rendered on a dedicated server, so never tick the pose there (this also covers an editor -server run)
+	if (PlayerMesh && IsRunningDedicatedServer())
+	{
+		PlayerMesh->MeshComponentUpdateFlag = EMeshComponentUpdateFlag::OnlyTickPoseWhenRendered;
+		PlayerMesh->SetComponentTickEnabled(false);
+		animInstance = NULL;
+	}
+
+	// Hand the anim graph its state directly when the AnimBP has the native parent, otherwise find its run variables once
+	locomotionAnim = Cast<ULocomotionAnimInstance>(animInstance);
+
+	if (animInstance && !locomotionAnim)
+	{
+		forwardAnimProp = FindField<UFloatProperty>(animInstance->GetClass(), HorizontalAnimName);
+		rightAnimProp = FindField<UFloatProperty>(animInstance->GetClass(), VerticalAnimName);
+	}
+
+	// Size the capsule from the stance settings before the fixed timestep takes the mesh's transform
+	ApplyStance();
+
+	SetupFixedTimestep();
+
+	// Keep everyone in the arena relevant to each other, and nothing much further away
+	if (HasAuthority())
+	{
+		if (class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetWorld()->GetAuthGameMode()))
+			NetCullDistanceSquared = GameMode->GetArenaNetCullDistanceSquared();
+	}
+}
+
+void AP1_Character::FindPlayerState()
+{
+	class UWorld* const world = GetWorld();
+	class UPlayerRegistry* Registry = UPlayerRegistry::Get(this);
+
+	if (world != nullptr && Registry != nullptr)
+	{
+		// Player state of whichever local player slot is controlling us
+		const int32 MySlot = Registry->FindSlotForPawn(this);
+
+		// To make sure everything has loaded correctly, we will also do a level check
+		if (MySlot != INDEX_NONE && ALocalMultiplayerDemoGameModeBase::IsTwoPlayerLevel(world))
+		{
+			myPlayerState = Registry->GetPlayerState(MySlot);
+		}
+	}
+}
+
+// Score from pickups, mirrored into the player state
+void AP1_Character::AddScore(int32 Amount)
+{
+	TotalScore += Amount;
+
+	if (myPlayerState.IsValid())
+		myPlayerState->TotalScore_P1 = TotalScore;
+}
+
+// Same actor, controller and camera, only its state goes back to how a round starts
+void AP1_Character::ResetForRound(const FVector& Location, const FRotator& Rotation)
+{
+	TotalScore = 0;
+
+	if (myPlayerState.IsValid())
+		myPlayerState->TotalScore_P1 = TotalScore;
+
+	if (Stance != ECharacterStance::Stand)
+	{
+		Stance = ECharacterStance::Stand;
+		ApplyStance();
+	}
+
+	CharacterMove->StopMovementImmediately();
+	TeleportTo(Location, Rotation);
+
+	// Don't interpolate across the teleport
+	if (useFixedTimestep)
+		FixedStep.Reset(this);
+}
+
+// Keep the player registry up to date as controllers come and go
+void AP1_Character::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	if (class UPlayerRegistry* Registry = UPlayerRegistry::Get(this))
+		Registry->NotifyPossessed(this, NewController);
+
+	FindPlayerState();
+
+	if (IsLocallyControlled() && Cast<APlayerController>(NewController))
+		CreatePlayerCamera();
+}
+
+// Owning clients of an online game get their camera here, PossessedBy only runs on the server
+void AP1_Character::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	if (IsLocallyControlled() && Cast<APlayerController>(Controller))
+		CreatePlayerCamera();
+}
+
+void AP1_Character::UnPossessed()
+{
+	if (class UPlayerRegistry* Registry = UPlayerRegistry::Get(this))
+		Registry->NotifyUnPossessed(this, Controller);
+
+	DestroyPlayerCamera();
+
+	Super::UnPossessed();
+}
+
+// Bots and pooled pawns never look through a camera, so only pawns viewed by a local player pay for one
+void AP1_Character::CreatePlayerCamera()
+{
+	if (CameraSpringArm != nullptr)
+		return;
+
+	// Create Camera Spring Arm (pulls in towards the player if there is a collision)
+	CameraSpringArm = NewObject<USpringArmComponent>(this, MakeUniqueObjectName(this, USpringArmComponent::StaticClass(), TEXT("CameraSpringArm")));
+	CameraSpringArm->SetRelativeLocation(FVector(0.f, 0.f, 50.f));
+	CameraSpringArm->TargetArmLength = 300.0f; // The camera follows at this distance behind the character	
+	CameraSpringArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	CameraSpringArm->bDoCollisionTest = false;
+	CameraSpringArm->bAutoActivate = true;
+	CameraSpringArm->SetupAttachment(RootComponent);
+	CameraSpringArm->RegisterComponent();
+
+	// Create Player Camera
+	PlayerCamera = NewObject<UCameraComponent>(this, MakeUniqueObjectName(this, UCameraComponent::StaticClass(), TEXT("PlayerCamera")));
+	PlayerCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	PlayerCamera->bAutoActivate = true;
+	PlayerCamera->SetupAttachment(CameraSpringArm, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
+	PlayerCamera->RegisterComponent();
+
+	// Fixed timestep mode offsets the arm from here
+	SpringArmBaseTransform = CameraSpringArm->GetRelativeTransform();
+}
+
+void AP1_Character::DestroyPlayerCamera()
+{
+	if (PlayerCamera != nullptr)
+		PlayerCamera->DestroyComponent();
+
+	if (CameraSpringArm != nullptr)
+		CameraSpringArm->DestroyComponent();
+
+	PlayerCamera = NULL;
+	CameraSpringArm = NULL;
+}
+
+// Fixed timestep mode is switched on by the game mode
+void AP1_Character::SetupFixedTimestep()
+{
+	class UWorld* const world = GetWorld();
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	if (GameMode && GameMode->bUseFixedTimestep)
+	{
+		useFixedTimestep = true;
+		FixedStep.Configure(GameMode->FixedTimestepRate, GameMode->MaxFixedSubsteps);
+		FixedStep.Reset(this);
+
+		// Remember where the mesh sits so it can be offset to the interpolated transform (the camera's is set when it is created)
+		MeshBaseTransform = PlayerMesh->GetRelativeTransform();
+
+		// Movement is stepped by hand from Tick
+		CharacterMove->SetComponentTickEnabled(false);
+	}
+}
+#pragma endregion
+
+// Called every frame
+void AP1_Character::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Input has been read for the frame by now, the controller ticks first
+	if (IsLocallyControlled())
+		UpdateReplicatedRunInput();
+
+	if (useFixedTimestep)
+	{
+		const int32 Steps = FixedStep.Advance(DeltaTime);
+
+		for (int32 Step = 0; Step < Steps; ++Step)
+			SimulateFixedStep(FixedStep.GetStepSeconds());
+
+		// Draw between the last two steps so motion stays smooth at any frame rate
+		FixedStep.ApplyRenderTransform(PlayerMesh, MeshBaseTransform);
+		FixedStep.ApplyRenderTransform(CameraSpringArm, SpringArmBaseTransform);
+	}
+}
+
+// One step of input and movement at a fixed delta
+void AP1_Character::SimulateFixedStep(float StepTime)
+{
+	FixedStep.BeginStep(this);
+
+	ApplyStepLookInput(StepTime);
+	AddForwardMovement();
+	AddRightMovement();
+
+	if (CharacterMove->IsActive())
+		CharacterMove->TickComponent(StepTime, LEVELTICK_All, &CharacterMove->PrimaryComponentTick);
+
+	TrackInputApplied();
+
+	FixedStep.EndStep(this);
+}
+
+// AddControllerYawInput would wait for the controller's UpdateRotation, which has already run this frame, so every
+// step would move along last frame's view. Same scaling and pitch limits as UpdateRotation.
+void AP1_Character::ApplyStepLookInput(float StepTime)
+{
+	class APlayerController* PlayerController = Cast<APlayerController>(Controller);
+
+	if (PlayerController == nullptr || PlayerController->IsLookInputIgnored())
+		return;
+
+	FRotator DeltaRotation(lookUpRateInput * BaseLookUpRate * StepTime * PlayerController->InputPitchScale,
+		turnRateInput * BaseTurnRate * StepTime * PlayerController->InputYawScale, 0.f);
+
+	if (DeltaRotation.IsZero())
+		return;
+
+	FRotator ViewRotation = PlayerController->GetControlRotation();
+
+	if (PlayerController->PlayerCameraManager != nullptr)
+		PlayerController->PlayerCameraManager->ProcessViewRotation(StepTime, ViewRotation, DeltaRotation);
+	else
+		ViewRotation += DeltaRotation;
+
+	PlayerController->SetControlRotation(ViewRotation);
+}
+
+#pragma region Movement
+// Called to bind functionality to input
+void AP1_Character::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+{
+	Super::SetupPlayerInputComponent(PlayerInputComponent);
+	PlayerInputComponent->BindAxis("MoveForward", this, &AP1_Character::MoveForward);
+	PlayerInputComponent->BindAxis("MoveRight", this, &AP1_Character::MoveRight);
+	PlayerInputComponent->BindAxis("TurnRate", this, &AP1_Character::TurnAtRate);
+	PlayerInputComponent->BindAxis("LookUpRate", this, &AP1_Character::LookUpAtRate);
+	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &AP1_Character::ToggleCrouch);
+	PlayerInputComponent->BindAction("Prone", IE_Pressed, this, &AP1_Character::ToggleProne);
+
+}
+
+void AP1_Character::MoveForward(float v)
+{
+	TrackInputLatency(v);
+
+	// Variable to track movement in editor
+	vertical = v;
+
+	// Animate
+	RunForwardAnimation(vertical);
+
+	// In fixed timestep mode the input is applied by SimulateFixedStep instead
+	if (!useFixedTimestep)
+		AddForwardMovement();
+}
+
+void AP1_Character::MoveRight(float h)
+{
+	TrackInputLatency(h);
+
+	// Variable to track movement in editor
+	horizontal = h;
+
+	// Animate
+	RunRightAnimation(horizontal);
+
+	if (!useFixedTimestep)
+		AddRightMovement();
+}
+
+void AP1_Character::AddForwardMovement()
+{
+	if ((Controller != NULL) && (vertical != 0.0f))
+	{
+		// Find out which way is forward
+		const FRotator Rotation = Controller->GetControlRotation();
+		const FRotator YawRotation(0, Rotation.Yaw, 0);
+
+		// Get forward vector
+		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
+
+		// Add movement in that direction
+		AddMovementInput(Direction, vertical);
+		TrackInputApplied();
+	}
+}
+
+void AP1_Character::AddRightMovement()
+{
+	if ((Controller != NULL) && (horizontal != 0.0f))
+	{
+		// Find out which way is right
+		const FRotator Rotation = Controller->GetControlRotation();
+		const FRotator YawRotation(0, Rotation.Yaw, 0);
+
+		// Get right vector 
+		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
+
+		// Add movement in that direction
+		AddMovementInput(Direction, horizontal);
+		TrackInputApplied();
+	}
+}
+
+void AP1_Character::TurnAtRate(float Rate)
+{
+	TrackInputLatency(Rate);
+
+	// Fixed timestep mode applies the rate once per step
+	if (useFixedTimestep)
+	{
+		turnRateInput = Rate;
+		return;
+	}
+
+	// Calculate delta for this frame from the rate information
+	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
+	TrackInputApplied();
+}
+
+void AP1_Character::LookUpAtRate(float Rate)
+{
+	TrackInputLatency(Rate);
+
+	if (useFixedTimestep)
+	{
+		lookUpRateInput = Rate;
+		return;
+	}
+
+	// Calculate delta for this frame from the rate information
+	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
+	TrackInputApplied();
+}
+
+// Timestamp non-zero input for the per controller latency histograms
+void AP1_Character::TrackInputLatency(float Value)
+{
+	if (Value != 0.f && FInputLatencyTracker::IsEnabled())
+		FInputLatencyTracker::Get().MarkInput(UPlayerRegistry::GetSlotIndex(Controller));
+}
+
+void AP1_Character::TrackInputApplied()
+{
+	if (FInputLatencyTracker::IsEnabled())
+		FInputLatencyTracker::Get().MarkApplied(UPlayerRegistry::GetSlotIndex(Controller));
+}
+#pragma endregion
+
+#pragma region Animations
+void AP1_Character::RunForwardAnimation(float amount)
+{
+	if (locomotionAnim)
+	{
+		locomotionAnim->SetLocomotionInput(Stance, amount, horizontal);
+	}
+	else if (forwardAnimProp)
+	{
+		// Set value of horizontal variable inside the animation blueprint
+		forwardAnimProp->SetPropertyValue_InContainer(animInstance, amount);
+	}
+}
+
+void AP1_Character::RunRightAnimation(float amount)
+{
+	if (locomotionAnim)
+	{
+		locomotionAnim->SetLocomotionInput(Stance, vertical, amount);
+	}
+	else if (rightAnimProp)
+	{
+		// Set value of vertical variable inside the animation blueprint
+		rightAnimProp->SetPropertyValue_InContainer(animInstance, amount);
+	}
+}
+#pragma endregion
+
+#pragma region Stance
+void AP1_Character::ToggleCrouch()
+{
+	SetStance(Stance == ECharacterStance::Crouch ? ECharacterStance::Stand : ECharacterStance::Crouch);
+}
+
+void AP1_Character::ToggleProne()
+{
+	SetStance(Stance == ECharacterStance::Prone ? ECharacterStance::Stand : ECharacterStance::Prone);
+}
+
+// The server decides, so a client that can't get up isn't left with a capsule nobody else agrees on
+void AP1_Character::SetStance(ECharacterStance NewStance)
+{
+	if (NewStance == Stance)
+		return;
+
+	if (!HasAuthority())
+	{
+		ServerSetStance(NewStance);
+		return;
+	}
+
+	if (!FStanceTable::HasRoomFor(this, StanceSettings.Get(NewStance)))
+		return;
+
+	Stance = NewStance;
+	ApplyStance();
+}
+
+void AP1_Character::ServerSetStance_Implementation(ECharacterStance NewStance)
+{
+	SetStance(NewStance);
+}
+
+bool AP1_Character::ServerSetStance_Validate(ECharacterStance NewStance)
+{
+	return NewStance <= ECharacterStance::Prone;
+}
+
+void AP1_Character::OnRep_Stance()
+{
+	if (Stance != appliedStance)
+		ApplyStance();
+}
+
+// Resize the capsule and set the walk speed for Stance, and tell the anim instance
+void AP1_Character::ApplyStance()
+{
+	const float HeightChange = FStanceTable::Apply(this, StanceSettings.Get(Stance));
+	appliedStance = Stance;
+
+	// Keep the mesh on the floor as the capsule's centre moves
+	if (HeightChange != 0.f && PlayerMesh)
+	{
+		FVector MeshLocation = PlayerMesh->RelativeLocation;
+		MeshLocation.Z -= HeightChange;
+		PlayerMesh->SetRelativeLocation(MeshLocation);
+
+		// Network smoothing and fixed timestep mode both offset the mesh from these
+		BaseTranslationOffset.Z = MeshLocation.Z;
+		MeshBaseTransform.AddToTranslation(FVector(0.f, 0.f, -HeightChange));
+
+		if (useFixedTimestep)
+			FixedStep.Reset(this);
+	}
+
+	if (locomotionAnim)
+		locomotionAnim->SetLocomotionInput(Stance, vertical, horizontal);
+}
+#pragma endregion
+
+
+#pragma region Networking
+void AP1_Character::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owner animates from its own input
+	DOREPLIFETIME_CONDITION(AP1_Character, RunInput, COND_SkipOwner);
+	DOREPLIFETIME(AP1_Character, TotalScore);
+	DOREPLIFETIME(AP1_Character, Stance);
+}
+
+void AP1_Character::UpdateReplicatedRunInput()
+{
+	const FReplicatedRunInput NewRunInput(horizontal, vertical);
+
+	if (NewRunInput != RunInput)
+	{
+		RunInput = NewRunInput;
+		runInputSendsLeft = FReplicatedRunInput::SendCount;
+	}
+
+	// A listen server's own players replicate straight from RunInput
+	if (Role != ROLE_AutonomousProxy || runInputSendsLeft == 0)
+		return;
+
+	runInputSendsLeft--;
+	ServerSetRunInput(RunInput);
+}
+
+void AP1_Character::ServerSetRunInput_Implementation(FReplicatedRunInput NewRunInput)
+{
+	RunInput = NewRunInput;
+}
+
+bool AP1_Character::ServerSetRunInput_Validate(FReplicatedRunInput NewRunInput)
+{
+	return true;
+}
+
+// Animate other clients' characters from their replicated input
+void AP1_Character::OnRep_RunInput()
+{
+	horizontal = RunInput.GetHorizontal();
+	vertical = RunInput.GetVertical();
+
+	RunForwardAnimation(vertical);
+	RunRightAnimation(horizontal);
+}
+#pragma endregion
@@ -1,460 +1,1003 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#include "P2_Character.h"
-#include "LocalMultiplayerDemo.h"
-#include "GameFramework/Controller.h"
-#include "GameFramework/PlayerController.h"
-#include "GameFramework/PlayerState.h"
-#include "LocalMultiplayerDemoPlayerState.h"
-#include "Components/SkeletalMeshComponent.h"
-#include "Components/CapsuleComponent.h"
-#include "Components/InputComponent.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "Animation/AnimInstance.h"
-#include "Runtime/Engine/Classes/Engine/LevelScriptActor.h"
-#include "Runtime/Engine/Classes/Engine/TargetPoint.h"
-#include "Runtime/Engine/Public/EngineUtils.h"
-#include "Engine.h"
-#include "UObject/ConstructorHelpers.h"
-
-const FName AP2_Character::HorizontalAnimName("Horizontal");
-const FName AP2_Character::VerticalAnimName("Vertical");
-const FString AP2_Character::MyLevelName("Minimal_Default");
-const FName AP2_Character::MyTagName("PlayerTwo");
-
-// Sets default values
-AP2_Character::AP2_Character(const FObjectInitializer &ObjectInitializer) : Super(ObjectInitializer)
-{
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
-	// Don't rotate when the controller rotates. Let that just affect the camera.
-	bUseControllerRotationPitch = false;
-	bUseControllerRotationYaw = false;
-	bUseControllerRotationRoll = false;
-
-	// Set Collision Component
-	CollisionComp = GetCapsuleComponent();
-	CollisionComp->InitCapsuleSize(42.f, 96.0f);
-	CollisionComp->bHiddenInGame = false;
-	CollisionComp->bGenerateOverlapEvents = true;
-	CollisionComp->SetCollisionObjectType(ECollisionChannel::ECC_Pawn);
-
-	// Set Skeletal Mesh Component
-	PlayerMesh = GetMesh();
-	static ConstructorHelpers::FObjectFinder<USkeletalMesh> ObjMesh(TEXT("/Game/AnimStarterPack/UE4_Mannequin/Mesh/HumanMale"));
-	PlayerMesh->SetSkeletalMesh(ObjMesh.Object);
-	PlayerMesh->SetRelativeLocation(FVector(0.f, 0.f, -95.f));
-	PlayerMesh->SetRelativeRotation(FRotator(0.f, -90.f, 0.f));
-	PlayerMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-
-	// Set Skeletal Mesh Animation Blueprint
-	static ConstructorHelpers::FClassFinder<UObject> AnimBPClass(TEXT("/Game/Blueprints/P2_AnimBP"));
-	PlayerMesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
-	PlayerMesh->SetAnimInstanceClass(AnimBPClass.Class);
-
-	// Set Character Movement Component Variables
-	CharacterMove = GetCharacterMovement();
-	CharacterMove->JumpZVelocity = 600.f;
-	CharacterMove->GravityScale = 1.f;
-	CharacterMove->bOrientRotationToMovement = true; // Character moves in the direction of input...	
-	CharacterMove->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
-
-	// Create Camera Spring Arm (pulls in towards the player if there is a collision)
-	CameraSpringArm = ObjectInitializer.CreateDefaultSubobject<USpringArmComponent>(this, TEXT("CameraSpringArm"));
-	CameraSpringArm->SetRelativeLocation(FVector(0.f, 0.f, 50.f));
-	CameraSpringArm->TargetArmLength = 300.0f; // The camera follows at this distance behind the character	
-	CameraSpringArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
-	CameraSpringArm->bDoCollisionTest = false;
-	CameraSpringArm->bAutoActivate = true;
-	CameraSpringArm->SetupAttachment(RootComponent);
-
-	// Create Player Camera
-	PlayerCamera = ObjectInitializer.CreateDefaultSubobject<UCameraComponent>(this, TEXT("PlayerCamera"));
-	PlayerCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
-	PlayerCamera->bAutoActivate = true;
-	PlayerCamera->SetupAttachment(CameraSpringArm, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
-
-	// Default Values for Variables
-	respawnCountdown = 3.f;
-	canDisable = false;
-	canRespawn = false;
-	animInstance = NULL;
-	FirstRespawnInWorld = NULL;
-	SecondRespawnInWorld = NULL;
-	ThirdRespawnInWorld = NULL;
-	FourthRespawnInWorld = NULL;
-	myPlayerState = NULL;
-	horizontal = 0.f;
-	vertical = 0.f;
-	TotalScore = 0;
-	isDead = false;
-	BaseTurnRate = 45.f;
-	BaseLookUpRate = 45.f;
-	
-	// Initialize Array
-	RespawnLocation.Empty();
-
-	// Actor Tag
-	this->Tags.Add(MyTagName);
-
-}
-
-#pragma region Setup Logic
-// Called when the game starts or when spawned
-void AP2_Character::BeginPlay()
-{
-	Super::BeginPlay();
-	FindPlayerState();
-	FindRespawnLocations();
-
-	// Animation instance that allows us to change variables in animation blueprint
-	if (PlayerMesh)
-		animInstance = Cast<UAnimInstance>(PlayerMesh->GetAnimInstance());
-
-}
-
-// Get Player State from Player Controller 1
-void AP2_Character::FindPlayerState()
-{
-	class UWorld* const world = GetWorld();
-
-	if (world != nullptr)
-	{
-		// To make sure everything has loaded correctly, we will also do a level check
-		class ALevelScriptActor* LevelActorInstance = Cast<ALevelScriptActor>(world->GetLevelScriptActor());
-		class APlayerController* PlConPlTwo = Cast<APlayerController>(UGameplayStatics::GetPlayerController(world, 1));
-
-		if (PlConPlTwo && LevelActorInstance)
-		{
-			if (LevelActorInstance->GetName().Contains(MyLevelName))
-			{
-				myPlayerState = Cast<ALocalMultiplayerDemoPlayerState>(PlConPlTwo->PlayerState);
-			}
-		}
-	}
-}
-
-// Find each ATargetPoint and add them to our array of respawn locations
-void AP2_Character::FindRespawnLocations()
-{
-	class UWorld* const world = GetWorld();
-
-	if (world)
-	{
-		for (TActorIterator<ATargetPoint> FirstItr(world); FirstItr; ++FirstItr)
-		{
-			class ATargetPoint* FoundPoint = *FirstItr;
-
-			if (FoundPoint != nullptr)
-			{
-				if (FoundPoint->ActorHasTag(FName(TEXT("RespawnOne")))) 
-				{
-					if (FirstRespawnInWorld != FoundPoint)
-					{
-						FirstRespawnInWorld = FoundPoint;
-
-						// Once the location is found, add it to array
-						RespawnLocation.Add(FirstRespawnInWorld);
-					}
-				}
-			}
-		}
-
-		for (TActorIterator<ATargetPoint> SecondItr(world); SecondItr; ++SecondItr)
-		{
-			class ATargetPoint* FoundPoint_2 = *SecondItr;
-
-			if (FoundPoint_2 != nullptr)
-			{
-				if (FoundPoint_2->ActorHasTag(FName(TEXT("RespawnTwo"))))
-				{
-					if (SecondRespawnInWorld != FoundPoint_2)
-					{
-						SecondRespawnInWorld = FoundPoint_2;
-
-						// Once the location is found, add it to array
-						RespawnLocation.Add(SecondRespawnInWorld);
-					}
-				}
-			}
-		}
-
-		for (TActorIterator<ATargetPoint> ThirdItr(world); ThirdItr; ++ThirdItr)
-		{
-			class ATargetPoint* FoundPoint_3 = *ThirdItr;
-
-			if (FoundPoint_3 != nullptr)
-			{
-				if (FoundPoint_3->ActorHasTag(FName(TEXT("RespawnThree"))))
-				{
-					if (ThirdRespawnInWorld != FoundPoint_3)
-					{
-						ThirdRespawnInWorld = FoundPoint_3;
-
-						// Once the location is found, add it to array
-						RespawnLocation.Add(ThirdRespawnInWorld);
-					}
-				}
-			}
-		}
-
-		for (TActorIterator<ATargetPoint> FourthItr(world); FourthItr; ++FourthItr)
-		{
-			class ATargetPoint* FoundPoint_4 = *FourthItr;
-
-			if (FoundPoint_4 != nullptr)
-			{
-				if (FoundPoint_4->ActorHasTag(FName(TEXT("RespawnFour"))))
-				{
-					if (FourthRespawnInWorld != FoundPoint_4)
-					{
-						FourthRespawnInWorld = FoundPoint_4;
-
-						// Once the location is found, add it to array
-						RespawnLocation.Add(FourthRespawnInWorld);
-					}
-				}
-			}
-		}
-	}
-}
-#pragma endregion
-
-// Called every frame
-void AP2_Character::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-	if (isDead)
-	{
-		// Timer to determine when to disable/respawn player
-		respawnCountdown -= 1 * DeltaTime;
-
-		if (respawnCountdown < 0.f)
-		{
-			if (!canRespawn)
-			{
-				Respawn();
-
-				// Reset variables
-				respawnCountdown = 3.f;
-				canRespawn = true;
-				canDisable = false;
-			}
-		}
-		else
-		{
-			if (!canDisable)
-			{
-				DisablePlayer();
-				canDisable = true;
-				canRespawn = false;
-			}
-		}
-	}
-}
-
-#pragma region Movement
-// Called to bind functionality to input
-void AP2_Character::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
-{
-	Super::SetupPlayerInputComponent(PlayerInputComponent);
-	PlayerInputComponent->BindAxis("MoveForward", this, &AP2_Character::MoveForward);
-	PlayerInputComponent->BindAxis("MoveRight", this, &AP2_Character::MoveRight);
-	PlayerInputComponent->BindAxis("TurnRate", this, &AP2_Character::TurnAtRate);
-	PlayerInputComponent->BindAxis("LookUpRate", this, &AP2_Character::LookUpAtRate);
-
-}
-
-void AP2_Character::MoveForward(float v)
-{
-	if (!isDead)
-	{
-		// Variable to track vertical movement in editor
-		vertical = v;
-
-		// Animate
-		RunForwardAnimation(vertical);
-
-		if ((Controller != NULL) && (vertical != 0.0f))
-		{
-			// Find out which way is forward
-			const FRotator Rotation = Controller->GetControlRotation();
-			const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-			// Get forward vector
-			const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-
-			// Add movement in that direction
-			AddMovementInput(Direction, vertical);
-		}
-	}
-}
-
-void AP2_Character::MoveRight(float h)
-{
-	if (!isDead) 
-	{
-		// Variable to track horizontal movement in editor
-		horizontal = h;
-
-		// Animate
-		RunRightAnimation(horizontal);
-
-		if ((Controller != NULL) && (horizontal != 0.0f))
-		{
-			// Find out which way is right
-			const FRotator Rotation = Controller->GetControlRotation();
-			const FRotator YawRotation(0, Rotation.Yaw, 0);
-
-			// Get right vector 
-			const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
-
-			// Add movement in that direction
-			AddMovementInput(Direction, horizontal);
-		}
-	}
-}
-
-void AP2_Character::TurnAtRate(float Rate)
-{
-	// Calculate delta for this frame from the rate information
-	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
-}
-
-void AP2_Character::LookUpAtRate(float Rate)
-{
-	// Calculate delta for this frame from the rate information
-	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
-}
-#pragma endregion
-
-#pragma region Animations
-void AP2_Character::RunForwardAnimation(float amount)
-{
-	if (!animInstance)
-		return;
-
-	// Create pointer to the horizontal variable inside the animation blueprint
-	class UFloatProperty *forwardProp = FindField<UFloatProperty>(animInstance->GetClass(), HorizontalAnimName);
-
-	if (forwardProp != NULL)
-	{
-		float retVal = forwardProp->GetPropertyValue_InContainer(animInstance);
-
-		// Set value of horizontal variable
-		forwardProp->SetPropertyValue_InContainer(animInstance, amount);
-		retVal = forwardProp->GetPropertyValue_InContainer(animInstance);
-	}
-}
-
-void AP2_Character::RunRightAnimation(float amount)
-{
-	if (!animInstance)
-		return;
-
-	// Create pointer to the vertical variable inside the animation blueprint
-	class UFloatProperty *rightProp = FindField<UFloatProperty>(animInstance->GetClass(), VerticalAnimName);
-
-	if (rightProp != NULL)
-	{
-		float retVal = rightProp->GetPropertyValue_InContainer(animInstance);
-
-		// Set value of vertical variable
-		rightProp->SetPropertyValue_InContainer(animInstance, amount);
-		retVal = rightProp->GetPropertyValue_InContainer(animInstance);
-	}
-}
-#pragma endregion
-
-#pragma region Respawn Logic
-// Our disable method, where we disable the collision, mesh, movement, and then hide the actor
-void AP2_Character::DisablePlayer()
-{
-	if (PlayerMesh)
-	{
-		this->SetActorEnableCollision(false);
-		PlayerMesh->SetActive(false);
-		CharacterMove->Deactivate();
-
-		// If using splitscreen, I recommend not to hide actor with this.  Possible bug in the behavior there.
-		//this->SetActorHiddenInGame(true);
-
-		// If using a follow camera
-		CameraSpringArm->SetActive(false);
-		PlayerCamera->SetActive(false);
-
-		GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("YOU'RE DEAD"));
-
-		// Reset player two score
-		if (myPlayerState != NULL)
-		{
-			TotalScore = 0;
-			myPlayerState->TotalScore_P2 = TotalScore;
-		}
-
-		// Now find respawn location and put player two there
-		ChooseRandomRespawnPoint();
-	}
-}
-
-void AP2_Character::ChooseRandomRespawnPoint()
-{
-	// Initialize Point for ATargetPoint
-	class ATargetPoint* LocationToRespawnAt = NULL;
-
-	// Find a random value between 0-3, which is the size of our array
-	int32 ranVal = FMath::RandRange(0, 3);
-
-	// Check if our array is filled with ATargetPoint
-	if (RespawnLocation.Num() > 0) 
-	{
-		if (RespawnLocation[ranVal] != NULL)
-		{
-			// Set respawn location
-			LocationToRespawnAt = RespawnLocation[ranVal];
-
-			// Get location and rotation of where we are respawning
-			if (LocationToRespawnAt != NULL) 
-			{
-				FVector RespawnPos = LocationToRespawnAt->GetActorLocation();
-				FRotator RespawnRot = LocationToRespawnAt->GetActorRotation();
-
-				// Set player two at the found random respawn point
-				SetActorLocation(RespawnPos);
-				SetActorRotation(RespawnRot);
-
-				GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Blue, TEXT("ACTOR POSITION IS SET"));
-			}
-		}
-	}
-}
-
-// Our respawn method, where we activate collision, mesh, and movement
-void AP2_Character::Respawn()
-{
-	if (isDead)
-	{
-		if (PlayerMesh)
-		{
-			this->SetActorEnableCollision(true);
-			PlayerMesh->SetActive(true);
-			CharacterMove->Activate();
-
-			// If using splitscreen, I recommend not to hide actor with this.  Possible bug in the behavior.
-			//this->SetActorHiddenInGame(false);
-
-			// If using a follow camera
-			CameraSpringArm->SetActive(true);
-			PlayerCamera->SetActive(true);
-		}
-
-		GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Green, TEXT("RESPAWNED"));
-
-		// End Method
-		isDead = false;
-	}
-}
-#pragma endregion
-
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "P2_Character.h"
+#include "LocalMultiplayerDemo.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerState.h"
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "InputLatencyTracker.h"
+#include "HitchDetector.h"
+#include "PlayerRegistry.h"
+#include "LocalMultiplayerDemoMovementComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "RespawnBakeData.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InputComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Animation/AnimInstance.h"
+#include "LocomotionAnimInstance.h"
+#include "RespawnPoint.h"
+#include "KillCamRecorder.h"
+#include "CharacterStateManager.h"
+#include "LocalMultiplayerDemoBotController.h"
+#include "Runtime/Engine/Public/EngineUtils.h"
+#include "Engine.h"
+#include "UObject/ConstructorHelpers.h"
+
+DECLARE_CYCLE_STAT(TEXT("Death"), STAT_Death, STATGROUP_LocalMultiplayerDemo);
+DECLARE_CYCLE_STAT(TEXT("Respawn"), STAT_Respawn, STATGROUP_LocalMultiplayerDemo);
+
+const FName AP2_Character::HorizontalAnimName("Horizontal");
+const FName AP2_Character::VerticalAnimName("Vertical");
+const FName AP2_Character::MyTagName("PlayerTwo");
+
+// Sets default values
+AP2_Character::AP2_Character(const FObjectInitializer &ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<ULocalMultiplayerDemoMovementComponent>(ACharacter::CharacterMovementComponentName))
+{
+ 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Input, movement and respawning all move the capsule, so they have to be done before physics runs.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	// Don't rotate when the controller rotates. Let that just affect the camera.
+	bUseControllerRotationPitch = false;
+	bUseControllerRotationYaw = false;
+	bUseControllerRotationRoll = false;
+
+	// Set Collision Component
+	CollisionComp = GetCapsuleComponent();
+	CollisionComp->InitCapsuleSize(42.f, 96.0f);
+	CollisionComp->bHiddenInGame = false;
+	CollisionComp->bGenerateOverlapEvents = false; // Pickups and kill volumes are tested centrally by ATriggerManager
+	CollisionComp->SetCollisionObjectType(ECollisionChannel::ECC_Pawn);
+
+	// Set Skeletal Mesh Component
+	PlayerMesh = GetMesh();
+	PlayerMesh->SetRelativeLocation(FVector(0.f, 0.f, -95.f));
+	PlayerMesh->SetRelativeRotation(FRotator(0.f, -90.f, 0.f));
+	PlayerMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
+
+	// The dedicated server never draws or animates the character, so it doesn't load the mesh or AnimBP
+#if !UE_SERVER
+	static ConstructorHelpers::FObjectFinder<USkeletalMesh> ObjMesh(TEXT("/Game/AnimStarterPack/UE4_Mannequin/Mesh/HumanMale"));
+	PlayerMesh->SetSkeletalMesh(ObjMesh.Object);
+
+	// Set Skeletal Mesh Animation Blueprint
+	static ConstructorHelpers::FClassFinder<UObject> AnimBPClass(TEXT("/Game/Blueprints/P2_AnimBP"));
+	PlayerMesh->SetAnimationMode(EAnimationMode::AnimationBlueprint);
+	PlayerMesh->SetAnimInstanceClass(AnimBPClass.Class);
+#endif
+
+	// Set Character Movement Component Variables
+	CharacterMove = GetCharacterMovement();
+	CharacterMove->JumpZVelocity = 600.f;
+	CharacterMove->GravityScale = 1.f;
+	CharacterMove->bOrientRotationToMovement = true; // Character moves in the direction of input...	
+	CharacterMove->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
+	CharacterMove->MaxWalkSpeed = StanceSettings.Stand.MaxWalkSpeed;
+
+	// Replication. Movement goes out quantised to whole centimetres and byte sized rotation axes, a few dozen times a second.
+	// The net cull distance is set from the arena size in BeginPlay.
+	bReplicates = true;
+	bReplicateMovement = true;
+	NetUpdateFrequency = 30.f;
+	MinNetUpdateFrequency = 10.f;
+	NetPriority = 3.f;
+	ReplicatedMovement.LocationQuantizationLevel = EVectorQuantization::RoundWholeNumber;
+	ReplicatedMovement.VelocityQuantizationLevel = EVectorQuantization::RoundWholeNumber;
+	ReplicatedMovement.RotationQuantizationLevel = ERotatorQuantization::ByteComponents;
+
+	// The spring arm and camera are only created while a local player controls us, see CreatePlayerCamera
+	CameraSpringArm = NULL;
+	PlayerCamera = NULL;
+
+	// Default Values for Variables
+	respawnDelay = 3.f;
+	lastRespawnIndex = INDEX_NONE;
+	stateSlot = INDEX_NONE;
+	stateManager = nullptr;
+	animInstance = NULL;
+	locomotionAnim = NULL;
+	forwardAnimProp = NULL;
+	rightAnimProp = NULL;
+	Stance = ECharacterStance::Stand;
+	appliedStance = ECharacterStance::Stand;
+	myPlayerState = nullptr;
+	horizontal = 0.f;
+	vertical = 0.f;
+	TotalScore = 0;
+	isDead = false;
+	BaseTurnRate = 45.f;
+	BaseLookUpRate = 45.f;
+	useFixedTimestep = false;
+	turnRateInput = 0.f;
+	runInputSendsLeft = 0;
+	lookUpRateInput = 0.f;
+	
+	// Initialize Array
+	RespawnLocation.Empty();
+
+	// Actor Tag
+	this->Tags.Add(MyTagName);
+
+}
+
+#pragma region Setup Logic
+// Called when the game starts or when spawned
+void AP2_Character::BeginPlay()
+{
+	Super::BeginPlay();
+	FindPlayerState();
+	FindRespawnLocations();
+
+	// Animation instance that allows us to change variables in animation blueprint
+	if (PlayerMesh)
+		animInstance = Cast<UAnimInstance>(PlayerMesh->GetAnimInstance());
+
+	// Nothing is rendered on a dedicated server, so never tick the pose there (this also covers an editor -server run)
+	if (PlayerMesh && IsRunningDedicatedServer())
+	{
+		PlayerMesh->MeshComponentUpdateFlag = EMeshComponentUpdateFlag::OnlyTickPoseWhenRendered;
+		PlayerMesh->SetComponentTickEnabled(false);
+		animInstance = NULL;
+	}
+
+	// Hand the anim graph its state directly when the AnimBP has the native parent, otherwise find its run variables once
+	locomotionAnim = Cast<ULocomotionAnimInstance>(animInstance);
+
+	if (animInstance && !locomotionAnim)
+	{
+		forwardAnimProp = FindField<UFloatProperty>(animInstance->GetClass(), HorizontalAnimName);
+		rightAnimProp = FindField<UFloatProperty>(animInstance->GetClass(), VerticalAnimName);
+	}
+
+	// Size the capsule from the stance settings before the fixed timestep takes the mesh's transform
+	ApplyStance();
+
+	SetupFixedTimestep();
+
+	if (HasAuthority())
+	{
+		if (class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetWorld()->GetAuthGameMode()))
+		{
+			// Keep everyone in the arena relevant to each other, and nothing much further away
+			NetCullDistanceSquared = GameMode->GetArenaNetCullDistanceSquared();
+
+			// How long we stay dead is up to the game mode
+			respawnDelay = GameMode->RespawnDelay;
+
+			// Our countdown and respawn cycle are updated along with everyone else's
+			stateManager = GameMode->CharacterState;
+			stateSlot = GameMode->CharacterState->Register(this, respawnDelay);
+		}
+	}
+
+	UpdateActorTickEnabled();
+}
+
+void AP2_Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (stateManager.IsValid())
+		stateManager->Unregister(this);
+
+	stateManager = nullptr;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Get Player State from Player Controller 1
+void AP2_Character::FindPlayerState()
+{
+	class UWorld* const world = GetWorld();
+	class UPlayerRegistry* Registry = UPlayerRegistry::Get(this);
+
+	if (world != nullptr && Registry != nullptr)
+	{
+		// Player state of whichever local player slot is controlling us
+		const int32 MySlot = Registry->FindSlotForPawn(this);
+
+		// To make sure everything has loaded correctly, we will also do a level check
+		if (MySlot != INDEX_NONE && ALocalMultiplayerDemoGameModeBase::IsTwoPlayerLevel(world))
+		{
+			myPlayerState = Registry->GetPlayerState(MySlot);
+		}
+	}
+}
+
+// Score from pickups, mirrored into the player state
+void AP2_Character::AddScore(int32 Amount)
+{
+	TotalScore += Amount;
+
+	if (myPlayerState.IsValid())
+		myPlayerState->TotalScore_P2 = TotalScore;
+}
+
+// Keep the player registry up to date as controllers come and go
+void AP2_Character::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	if (class UPlayerRegistry* Registry = UPlayerRegistry::Get(this))
+		Registry->NotifyPossessed(this, NewController);
+
+	FindPlayerState();
+
+	if (IsLocallyControlled() && Cast<APlayerController>(NewController))
+		CreatePlayerCamera();
+
+	UpdateActorTickEnabled();
+}
+
+// Owning clients of an online game get their camera here, PossessedBy only runs on the server
+void AP2_Character::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	if (IsLocallyControlled() && Cast<APlayerController>(Controller))
+		CreatePlayerCamera();
+
+	UpdateActorTickEnabled();
+}
+
+void AP2_Character::UnPossessed()
+{
+	if (class UPlayerRegistry* Registry = UPlayerRegistry::Get(this))
+		Registry->NotifyUnPossessed(this, Controller);
+
+	DestroyPlayerCamera();
+
+	Super::UnPossessed();
+	UpdateActorTickEnabled();
+}
+
+// Bots and pooled pawns never look through a camera, so only pawns viewed by a local player pay for one
+void AP2_Character::CreatePlayerCamera()
+{
+	if (CameraSpringArm != nullptr)
+		return;
+
+	// Create Camera Spring Arm (pulls in towards the player if there is a collision)
+	CameraSpringArm = NewObject<USpringArmComponent>(this, MakeUniqueObjectName(this, USpringArmComponent::StaticClass(), TEXT("CameraSpringArm")));
+	CameraSpringArm->SetRelativeLocation(FVector(0.f, 0.f, 50.f));
+	CameraSpringArm->TargetArmLength = 300.0f; // The camera follows at this distance behind the character	
+	CameraSpringArm->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	CameraSpringArm->bDoCollisionTest = false;
+	CameraSpringArm->bAutoActivate = true;
+	CameraSpringArm->SetupAttachment(RootComponent);
+	CameraSpringArm->RegisterComponent();
+
+	// Create Player Camera
+	PlayerCamera = NewObject<UCameraComponent>(this, MakeUniqueObjectName(this, UCameraComponent::StaticClass(), TEXT("PlayerCamera")));
+	PlayerCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	PlayerCamera->bAutoActivate = true;
+	PlayerCamera->SetupAttachment(CameraSpringArm, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
+	PlayerCamera->RegisterComponent();
+
+	// Fixed timestep mode offsets the arm from here
+	SpringArmBaseTransform = CameraSpringArm->GetRelativeTransform();
+}
+
+void AP2_Character::DestroyPlayerCamera()
+{
+	if (PlayerCamera != nullptr)
+		PlayerCamera->DestroyComponent();
+
+	if (CameraSpringArm != nullptr)
+		CameraSpringArm->DestroyComponent();
+
+	PlayerCamera = NULL;
+	CameraSpringArm = NULL;
+}
+
+// Respawn points of the arena being played, in respawn order. They come and go as arenas stream, so ask at each respawn.
+void AP2_Character::FindRespawnLocations()
+{
+	class UWorld* const world = GetWorld();
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	if (GameMode != nullptr)
+		GameMode->GetRespawnPoints(RespawnLocation);
+}
+
+// Fixed timestep mode is switched on by the game mode
+void AP2_Character::SetupFixedTimestep()
+{
+	class UWorld* const world = GetWorld();
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	if (GameMode && GameMode->bUseFixedTimestep)
+	{
+		useFixedTimestep = true;
+		FixedStep.Configure(GameMode->FixedTimestepRate, GameMode->MaxFixedSubsteps);
+		FixedStep.Reset(this);
+
+		// Remember where the mesh sits so it can be offset to the interpolated transform (the camera's is set when it is created)
+		MeshBaseTransform = PlayerMesh->GetRelativeTransform();
+
+		// Movement is stepped by hand from Tick
+		CharacterMove->SetComponentTickEnabled(false);
+	}
+}
+#pragma endregion
+
+// Called every frame
+void AP2_Character::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Input has been read for the frame by now, the controller ticks first
+	if (IsLocallyControlled())
+		UpdateReplicatedRunInput();
+
+	if (useFixedTimestep)
+	{
+		const int32 Steps = FixedStep.Advance(DeltaTime);
+
+		for (int32 Step = 0; Step < Steps; ++Step)
+			SimulateFixedStep(FixedStep.GetStepSeconds());
+
+		// Draw between the last two steps so motion stays smooth at any frame rate
+		FixedStep.ApplyRenderTransform(PlayerMesh, MeshBaseTransform);
+		FixedStep.ApplyRenderTransform(CameraSpringArm, SpringArmBaseTransform);
+	}
+	else
+	{
+		UpdateRespawn(DeltaTime);
+	}
+}
+
+// One step of input, movement and respawn timing at a fixed delta
+void AP2_Character::SimulateFixedStep(float StepTime)
+{
+	FixedStep.BeginStep(this);
+
+	ApplyStepLookInput(StepTime);
+
+	if (!isDead)
+	{
+		AddForwardMovement();
+		AddRightMovement();
+	}
+
+	if (CharacterMove->IsActive())
+		CharacterMove->TickComponent(StepTime, LEVELTICK_All, &CharacterMove->PrimaryComponentTick);
+
+	TrackInputApplied();
+
+	UpdateRespawn(StepTime);
+
+	FixedStep.EndStep(this);
+}
+
+// AddControllerYawInput would wait for the controller's UpdateRotation, which has already run this frame, so every
+// step would move along last frame's view. Same scaling and pitch limits as UpdateRotation.
+void AP2_Character::ApplyStepLookInput(float StepTime)
+{
+	class APlayerController* PlayerController = Cast<APlayerController>(Controller);
+
+	if (PlayerController == nullptr || PlayerController->IsLookInputIgnored())
+		return;
+
+	FRotator DeltaRotation(lookUpRateInput * BaseLookUpRate * StepTime * PlayerController->InputPitchScale,
+		turnRateInput * BaseTurnRate * StepTime * PlayerController->InputYawScale, 0.f);
+
+	if (DeltaRotation.IsZero())
+		return;
+
+	FRotator ViewRotation = PlayerController->GetControlRotation();
+
+	if (PlayerController->PlayerCameraManager != nullptr)
+		PlayerController->PlayerCameraManager->ProcessViewRotation(StepTime, ViewRotation, DeltaRotation);
+	else
+		ViewRotation += DeltaRotation;
+
+	PlayerController->SetControlRotation(ViewRotation);
+}
+
+// Only the server decides when to respawn and where (only it has a state manager), clients follow isDead
+void AP2_Character::UpdateRespawn(float DeltaTime)
+{
+	// Batched, the state manager does this for every character at once from the game mode's tick
+	if (!UCharacterStateManager::IsBatched() && stateManager.IsValid())
+		stateManager->TickSlot(stateSlot, DeltaTime);
+}
+
+// A local player's own tick also sends its run input, see UpdateReplicatedRunInput
+void AP2_Character::UpdateActorTickEnabled()
+{
+	const bool bLocalPlayer = IsLocallyControlled() && Cast<APlayerController>(Controller) != nullptr;
+
+	SetActorTickEnabled(useFixedTimestep || bLocalPlayer || (stateManager.IsValid() && !UCharacterStateManager::IsBatched()));
+}
+
+float AP2_Character::GetRespawnCountdown() const
+{
+	return stateManager.IsValid() ? stateManager->GetRespawnCountdown(stateSlot) : respawnDelay;
+}
+
+#pragma region Movement
+// Called to bind functionality to input
+void AP2_Character::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
+{
+	Super::SetupPlayerInputComponent(PlayerInputComponent);
+	PlayerInputComponent->BindAxis("MoveForward", this, &AP2_Character::MoveForward);
+	PlayerInputComponent->BindAxis("MoveRight", this, &AP2_Character::MoveRight);
+	PlayerInputComponent->BindAxis("TurnRate", this, &AP2_Character::TurnAtRate);
+	PlayerInputComponent->BindAxis("LookUpRate", this, &AP2_Character::LookUpAtRate);
+	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &AP2_Character::ToggleCrouch);
+	PlayerInputComponent->BindAction("Prone", IE_Pressed, this, &AP2_Character::ToggleProne);
+
+}
+
+void AP2_Character::MoveForward(float v)
+{
+	if (!isDead)
+	{
+		TrackInputLatency(v);
+
+		// Variable to track vertical movement in editor
+		vertical = v;
+
+		// Animate
+		RunForwardAnimation(vertical);
+
+		// In fixed timestep mode the input is applied by SimulateFixedStep instead
+		if (!useFixedTimestep)
+			AddForwardMovement();
+	}
+}
+
+void AP2_Character::MoveRight(float h)
+{
+	if (!isDead) 
+	{
+		TrackInputLatency(h);
+
+		// Variable to track horizontal movement in editor
+		horizontal = h;
+
+		// Animate
+		RunRightAnimation(horizontal);
+
+		if (!useFixedTimestep)
+			AddRightMovement();
+	}
+}
+
+void AP2_Character::AddForwardMovement()
+{
+	if ((Controller != NULL) && (vertical != 0.0f))
+	{
+		// Find out which way is forward
+		const FRotator Rotation = Controller->GetControlRotation();
+		const FRotator YawRotation(0, Rotation.Yaw, 0);
+
+		// Get forward vector
+		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
+
+		// Add movement in that direction
+		AddMovementInput(Direction, vertical);
+		TrackInputApplied();
+	}
+}
+
+void AP2_Character::AddRightMovement()
+{
+	if ((Controller != NULL) && (horizontal != 0.0f))
+	{
+		// Find out which way is right
+		const FRotator Rotation = Controller->GetControlRotation();
+		const FRotator YawRotation(0, Rotation.Yaw, 0);
+
+		// Get right vector 
+		const FVector Direction = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
+
+		// Add movement in that direction
+		AddMovementInput(Direction, horizontal);
+		TrackInputApplied();
+	}
+}
+
+void AP2_Character::TurnAtRate(float Rate)
+{
+	TrackInputLatency(Rate);
+
+	// Fixed timestep mode applies the rate once per step
+	if (useFixedTimestep)
+	{
+		turnRateInput = Rate;
+		return;
+	}
+
+	// Calculate delta for this frame from the rate information
+	AddControllerYawInput(Rate * BaseTurnRate * GetWorld()->GetDeltaSeconds());
+	TrackInputApplied();
+}
+
+void AP2_Character::LookUpAtRate(float Rate)
+{
+	TrackInputLatency(Rate);
+
+	if (useFixedTimestep)
+	{
+		lookUpRateInput = Rate;
+		return;
+	}
+
+	// Calculate delta for this frame from the rate information
+	AddControllerPitchInput(Rate * BaseLookUpRate * GetWorld()->GetDeltaSeconds());
+	TrackInputApplied();
+}
+
+// Timestamp non-zero input for the per controller latency histograms
+void AP2_Character::TrackInputLatency(float Value)
+{
+	if (Value != 0.f && FInputLatencyTracker::IsEnabled())
+		FInputLatencyTracker::Get().MarkInput(UPlayerRegistry::GetSlotIndex(Controller));
+}
+
+void AP2_Character::TrackInputApplied()
+{
+	if (FInputLatencyTracker::IsEnabled())
+		FInputLatencyTracker::Get().MarkApplied(UPlayerRegistry::GetSlotIndex(Controller));
+}
+#pragma endregion
+
+#pragma region Animations
+void AP2_Character::RunForwardAnimation(float amount)
+{
+	if (locomotionAnim)
+	{
+		locomotionAnim->SetLocomotionInput(Stance, amount, horizontal);
+	}
+	else if (forwardAnimProp)
+	{
+		// Set value of horizontal variable inside the animation blueprint
+		forwardAnimProp->SetPropertyValue_InContainer(animInstance, amount);
+	}
+}
+
+void AP2_Character::RunRightAnimation(float amount)
+{
+	if (locomotionAnim)
+	{
+		locomotionAnim->SetLocomotionInput(Stance, vertical, amount);
+	}
+	else if (rightAnimProp)
+	{
+		// Set value of vertical variable inside the animation blueprint
+		rightAnimProp->SetPropertyValue_InContainer(animInstance, amount);
+	}
+}
+#pragma endregion
+
+#pragma region Stance
+void AP2_Character::ToggleCrouch()
+{
+	if (isDead)
+		return;
+
+	SetStance(Stance == ECharacterStance::Crouch ? ECharacterStance::Stand : ECharacterStance::Crouch);
+}
+
+void AP2_Character::ToggleProne()
+{
+	if (isDead)
+		return;
+
+	SetStance(Stance == ECharacterStance::Prone ? ECharacterStance::Stand : ECharacterStance::Prone);
+}
+
+// The server decides, so a client that can't get up isn't left with a capsule nobody else agrees on
+void AP2_Character::SetStance(ECharacterStance NewStance)
+{
+	if (NewStance == Stance)
+		return;
+
+	if (!HasAuthority())
+	{
+		ServerSetStance(NewStance);
+		return;
+	}
+
+	if (!FStanceTable::HasRoomFor(this, StanceSettings.Get(NewStance)))
+		return;
+
+	Stance = NewStance;
+	ApplyStance();
+}
+
+void AP2_Character::ServerSetStance_Implementation(ECharacterStance NewStance)
+{
+	SetStance(NewStance);
+}
+
+bool AP2_Character::ServerSetStance_Validate(ECharacterStance NewStance)
+{
+	return NewStance <= ECharacterStance::Prone;
+}
+
+void AP2_Character::OnRep_Stance()
+{
+	if (Stance != appliedStance)
+		ApplyStance();
+}
+
+// Resize the capsule and set the walk speed for Stance, and tell the anim instance
+void AP2_Character::ApplyStance()
+{
+	const float HeightChange = FStanceTable::Apply(this, StanceSettings.Get(Stance));
+	appliedStance = Stance;
+
+	// Keep the mesh on the floor as the capsule's centre moves
+	if (HeightChange != 0.f && PlayerMesh)
+	{
+		FVector MeshLocation = PlayerMesh->RelativeLocation;
+		MeshLocation.Z -= HeightChange;
+		PlayerMesh->SetRelativeLocation(MeshLocation);
+
+		// Network smoothing and fixed timestep mode both offset the mesh from these
+		BaseTranslationOffset.Z = MeshLocation.Z;
+		MeshBaseTransform.AddToTranslation(FVector(0.f, 0.f, -HeightChange));
+
+		if (useFixedTimestep)
+			FixedStep.Reset(this);
+	}
+
+	if (locomotionAnim)
+		locomotionAnim->SetLocomotionInput(Stance, vertical, horizontal);
+}
+#pragma endregion
+
+#pragma region Respawn Logic
+// Killed by a kill volume. The state manager disables us on its next update and respawns us later.
+void AP2_Character::Kill()
+{
+	if (!isDead)
+	{
+		isDead = true;
+
+		if (stateManager.IsValid())
+			stateManager->Kill(stateSlot);
+	}
+}
+
+// Same actor, controller and camera, only its state goes back to how a round starts. Also ends a kill-cam or a
+// respawn countdown part way through, as if the respawn had happened.
+void AP2_Character::ResetForRound(const FVector& Location, const FRotator& Rotation)
+{
+	if (isDead)
+	{
+		if (class UKillCamRecorder* KillCam = UKillCamRecorder::Get(this))
+			KillCam->StopPlayback(this);
+
+		if (PlayerMesh)
+			SetPlayerActive(true);
+
+		isDead = false;
+	}
+
+	// Reset variables
+	if (stateManager.IsValid())
+		stateManager->ResetSlot(stateSlot);
+
+	TotalScore = 0;
+
+	if (myPlayerState.IsValid())
+		myPlayerState->TotalScore_P2 = TotalScore;
+
+	if (Stance != ECharacterStance::Stand)
+	{
+		Stance = ECharacterStance::Stand;
+		ApplyStance();
+	}
+
+	CharacterMove->StopMovementImmediately();
+	TeleportTo(Location, Rotation);
+
+	// Don't interpolate across the teleport
+	if (useFixedTimestep)
+		FixedStep.Reset(this);
+}
+
+// Our disable method, where we disable the collision, mesh, movement, and then hide the actor
+void AP2_Character::DisablePlayer()
+{
+	if (PlayerMesh)
+	{
+		SCOPE_HITCH_CYCLE_COUNTER(STAT_Death, EHitchSection::Death);
+
+		SetPlayerActive(false);
+
+		GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Red, TEXT("YOU'RE DEAD"));
+
+		if (class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetWorld()->GetAuthGameMode()))
+			GameMode->OnPlayerDied.Broadcast(this);
+
+		// Show whoever is controlling us the last few seconds while we wait, before we're moved away
+		if (class UKillCamRecorder* KillCam = UKillCamRecorder::Get(this))
+			KillCam->StartPlayback(this, Cast<APlayerController>(Controller), respawnDelay);
+
+		// Reset player two score
+		TotalScore = 0;
+
+		if (myPlayerState.IsValid())
+			myPlayerState->TotalScore_P2 = TotalScore;
+
+		// Come back standing
+		Stance = ECharacterStance::Stand;
+		ApplyStance();
+
+		// Now find respawn location and put player two there
+		ChooseRandomRespawnPoint();
+	}
+}
+
+void AP2_Character::ChooseRandomRespawnPoint()
+{
+	// Initialize Point for ARespawnPoint
+	class ARespawnPoint* LocationToRespawnAt = NULL;
+
+	FindRespawnLocations();
+
+	// Check if our array is filled with ARespawnPoint
+	if (RespawnLocation.Num() > 0) 
+	{
+		// Prefer a point the other players can't see, using the baked table when this map has one
+		int32 ranVal = ChooseSafeRespawnIndex();
+
+		// Otherwise find a random value between 0 and the size of our array
+		if (ranVal == INDEX_NONE)
+			ranVal = ALocalMultiplayerDemoGameModeBase::GetGameplayRandom(this).RandRange(0, RespawnLocation.Num() - 1);
+
+		if (RespawnLocation[ranVal] != NULL)
+		{
+			// Set respawn location
+			LocationToRespawnAt = RespawnLocation[ranVal];
+			lastRespawnIndex = ranVal;
+
+			// Get location and rotation of where we are respawning
+			if (LocationToRespawnAt != NULL) 
+			{
+				FVector RespawnPos = LocationToRespawnAt->GetActorLocation();
+				FRotator RespawnRot = LocationToRespawnAt->GetActorRotation();
+
+				// Set player two at the found random respawn point
+				SetActorLocation(RespawnPos);
+				SetActorRotation(RespawnRot);
+
+				// Don't interpolate across the teleport
+				if (useFixedTimestep)
+					FixedStep.Reset(this);
+
+				GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Blue, TEXT("ACTOR POSITION IS SET"));
+			}
+		}
+	}
+}
+
+// Pick among respawn points hidden from every other pawn, favouring the longest path away from them.
+// Costs one table lookup per point and pawn, plus a line trace for each point we end up considering.
+int32 AP2_Character::ChooseSafeRespawnIndex() const
+{
+	class UWorld* const world = GetWorld();
+
+	if (world == nullptr)
+		return INDEX_NONE;
+
+	class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode());
+	const class URespawnBakeData* BakeData = GameMode ? GameMode->RespawnBakeData : NULL;
+
+	if (BakeData == nullptr || BakeData->NumRespawnPoints != RespawnLocation.Num())
+		return INDEX_NONE;
+
+	// Where everyone else is standing
+	TArray<APawn*, TInlineAllocator<4>> Threats;
+	TArray<int32, TInlineAllocator<4>> ThreatCells;
+
+	for (FConstPawnIterator Iterator = world->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		APawn* OtherPawn = Iterator->Get();
+
+		if (OtherPawn != nullptr && OtherPawn != this)
+		{
+			Threats.Add(OtherPawn);
+			ThreatCells.Add(BakeData->GetCellIndex(OtherPawn->GetActorLocation()));
+		}
+	}
+
+	TArray<int32, TInlineAllocator<4>> SafePoints;
+	int32 FarthestPoint = INDEX_NONE;
+	float FarthestDistance = -1.f;
+
+	for (int32 Point = 0; Point < RespawnLocation.Num(); ++Point)
+	{
+		if (RespawnLocation[Point] == NULL)
+			continue;
+
+		bool bSeen = false;
+		float ClosestThreat = MAX_flt;
+
+		for (int32 Threat = 0; Threat < ThreatCells.Num(); ++Threat)
+		{
+			const int32 Cell = ThreatCells[Threat];
+
+			if (Cell == INDEX_NONE)
+				continue;
+
+			bSeen |= BakeData->IsPointVisibleFromCell(Point, Cell);
+
+			const float Distance = BakeData->GetPathDistance(Point, Cell);
+
+			if (Distance >= 0.f)
+				ClosestThreat = FMath::Min(ClosestThreat, Distance);
+		}
+
+		if (ClosestThreat > FarthestDistance)
+		{
+			FarthestDistance = ClosestThreat;
+			FarthestPoint = Point;
+		}
+
+		if (!bSeen)
+			SafePoints.Add(Point);
+	}
+
+	// The table is static, so confirm with a live trace in case someone is standing somewhere unusual
+	FCollisionQueryParams TraceParams(FName(TEXT("RespawnCheck")), false, this);
+
+	for (APawn* Threat : Threats)
+		TraceParams.AddIgnoredActor(Threat);
+
+	while (SafePoints.Num() > 0)
+	{
+		const int32 Pick = ALocalMultiplayerDemoGameModeBase::GetGameplayRandom(this).RandRange(0, SafePoints.Num() - 1);
+		const FVector PointEye = RespawnLocation[SafePoints[Pick]]->GetActorLocation() + FVector(0.f, 0.f, BaseEyeHeight);
+		bool bVisible = false;
+
+		for (APawn* Threat : Threats)
+		{
+			if (!world->LineTraceTestByChannel(Threat->GetPawnViewLocation(), PointEye, ECC_Visibility, TraceParams))
+			{
+				bVisible = true;
+				break;
+			}
+		}
+
+		if (!bVisible)
+			return SafePoints[Pick];
+
+		SafePoints.RemoveAtSwap(Pick);
+	}
+
+	return FarthestPoint;
+}
+
+// Our respawn method, where we activate collision, mesh, and movement
+void AP2_Character::Respawn()
+{
+	if (isDead)
+	{
+		SCOPE_HITCH_CYCLE_COUNTER(STAT_Respawn, EHitchSection::Respawn);
+
+		if (PlayerMesh)
+			SetPlayerActive(true);
+
+		GEngine->AddOnScreenDebugMessage(-1, 2.f, FColor::Green, TEXT("RESPAWNED"));
+
+		if (class UKillCamRecorder* KillCam = UKillCamRecorder::Get(this))
+			KillCam->StopPlayback(this);
+
+		if (class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetWorld()->GetAuthGameMode()))
+			GameMode->OnPlayerRespawned.Broadcast(this, lastRespawnIndex);
+
+		// End Method
+		isDead = false;
+	}
+}
+
+void AP2_Character::SetPlayerActive(bool bActive)
+{
+	this->SetActorEnableCollision(bActive);
+	PlayerMesh->SetActive(bActive);
+
+	if (bActive)
+	{
+		CharacterMove->Activate();
+
+		// Activating turns the movement tick back on, but fixed timestep mode steps it by hand
+		if (useFixedTimestep)
+			CharacterMove->SetComponentTickEnabled(false);
+
+		// And a bot the frame budget governor has parked stays parked
+		if (class ALocalMultiplayerDemoBotController* BotController = Cast<ALocalMultiplayerDemoBotController>(Controller))
+			BotController->ReapplyParking();
+	}
+	else
+	{
+		CharacterMove->Deactivate();
+	}
+
+	// If using splitscreen, I recommend not to hide actor with this.  Possible bug in the behavior there.
+	//this->SetActorHiddenInGame(!bActive);
+
+	// If using a follow camera
+	if (CameraSpringArm != nullptr)
+		CameraSpringArm->SetActive(bActive);
+
+	if (PlayerCamera != nullptr)
+		PlayerCamera->SetActive(bActive);
+}
+#pragma endregion
+
+#pragma region Networking
+void AP2_Character::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// The owner animates from its own input
+	DOREPLIFETIME_CONDITION(AP2_Character, RunInput, COND_SkipOwner);
+	DOREPLIFETIME(AP2_Character, TotalScore);
+	DOREPLIFETIME(AP2_Character, Stance);
+	DOREPLIFETIME(AP2_Character, isDead);
+}
+
+void AP2_Character::UpdateReplicatedRunInput()
+{
+	const FReplicatedRunInput NewRunInput(horizontal, vertical);
+
+	if (NewRunInput != RunInput)
+	{
+		RunInput = NewRunInput;
+		runInputSendsLeft = FReplicatedRunInput::SendCount;
+	}
+
+	// A listen server's own players replicate straight from RunInput
+	if (Role != ROLE_AutonomousProxy || runInputSendsLeft == 0)
+		return;
+
+	runInputSendsLeft--;
+	ServerSetRunInput(RunInput);
+}
+
+void AP2_Character::ServerSetRunInput_Implementation(FReplicatedRunInput NewRunInput)
+{
+	RunInput = NewRunInput;
+}
+
+bool AP2_Character::ServerSetRunInput_Validate(FReplicatedRunInput NewRunInput)
+{
+	return true;
+}
+
+// Clients mirror the server's disable/respawn, the server also picks the respawn point and resets the score
+void AP2_Character::OnRep_IsDead()
+{
+	if (PlayerMesh)
+		SetPlayerActive(!isDead);
+}
+
+// Input isn't replicated while dead, so nothing is sent for a character that can't move
+void AP2_Character::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	DOREPLIFETIME_ACTIVE_OVERRIDE(AP2_Character, RunInput, !isDead);
+}
+
+// Animate other clients' characters from their replicated input
+void AP2_Character::OnRep_RunInput()
+{
+	horizontal = RunInput.GetHorizontal();
+	vertical = RunInput.GetVertical();
+
+	RunForwardAnimation(vertical);
+	RunRightAnimation(horizontal);
+}
+#pragma endregion
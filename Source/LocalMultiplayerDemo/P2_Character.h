@@ -1,134 +1,250 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-#pragma once
-
-#include "CoreMinimal.h"
-#include "GameFramework/Character.h"
-#include "P2_Character.generated.h"
-
-UCLASS()
-class LOCALMULTIPLAYERDEMO_API AP2_Character : public ACharacter
-{
-	GENERATED_BODY()
-
-private:
-
-	// Respawn Variables
-	float respawnCountdown;
-	bool canDisable;
-	bool canRespawn;
-
-	// Respawn Methods
-	void FindRespawnLocations();
-	void DisablePlayer();
-	void ChooseRandomRespawnPoint();
-	void Respawn();
-
-	// Player State Method
-	void FindPlayerState();
-		
-public:
-
-	// Sets default values for this character's properties
-	AP2_Character(const FObjectInitializer &ObjectInitializer);
-
-protected:
-
-	// Called when the game starts or when spawned
-	virtual void BeginPlay() override;
-
-	// Animation Instance Reference
-	class UAnimInstance* animInstance;
-
-	// Respawn Location References
-	class ATargetPoint* FirstRespawnInWorld;
-	class ATargetPoint* SecondRespawnInWorld;
-	class ATargetPoint* ThirdRespawnInWorld;
-	class ATargetPoint* FourthRespawnInWorld;
-
-	// Player State for Player Controller at index 1
-	class ALocalMultiplayerDemoPlayerState* myPlayerState;
-
-public:	
-
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-
-	// Called to bind functionality to input
-	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
-
-	// References to Collision, Mesh, and Character Movement Components
-	class UCapsuleComponent* CollisionComp;
-	class USkeletalMeshComponent* PlayerMesh;
-	class UCharacterMovementComponent* CharacterMove;
-	
-	// Spring Arm Component
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
-	class USpringArmComponent* CameraSpringArm;
-
-	// Camera Component
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
-	class UCameraComponent* PlayerCamera;
-
-	// Actor Movement
-	void MoveForward(float v);
-	void MoveRight(float h);
-
-	// Actor Animation
-	void RunForwardAnimation(float amount);
-	void RunRightAnimation(float amount);
-		
-	// Called via input to turn at a given rate.
-	void TurnAtRate(float Rate);
-
-	// Called via input to turn look up/down at a given rate.
-	void LookUpAtRate(float Rate);
-
-	// Character Stats Variables
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character Stats")
-	float horizontal;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character Stats")
-	float vertical;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Stats")
-	int32 TotalScore;
-
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Character Stats")
-	bool isDead;
-
-	// Base turn rate, in deg/sec. Other scaling may affect final turn rate
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
-	float BaseTurnRate;
-
-	// Base look up/down rate, in deg/sec. Other scaling may affect final rate
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
-	float BaseLookUpRate;
-	
-protected:
-
-	// Animation Blueprint Variable References
-	static const FName HorizontalAnimName;
-	static const FName VerticalAnimName;
-
-	// Level Name
-	static const FString MyLevelName;
-
-	// Player Tag Name
-	static const FName MyTagName;
-
-public:
-
-	// Respawn Locations Array
-	UPROPERTY(EditAnywhere, Category = "Spawn Locations")
-	TArray<class ATargetPoint*> RespawnLocation;
-		
-public:
-
-	// Returns CameraSpringArm Subobject
-	FORCEINLINE class USpringArmComponent* GetCameraSpringArm() const { return CameraSpringArm; }
-
-	// Returns PlayerCamera Subobject
-	FORCEINLINE class UCameraComponent* GetPlayerCamera() const { return PlayerCamera; }
-
-};
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "FixedStepSimulation.h"
+#include "ReplicatedRunInput.h"
+#include "CharacterStance.h"
+#include "P2_Character.generated.h"
+
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API AP2_Character : public ACharacter
+{
+	GENERATED_BODY()
+
+	// Runs our disable/respawn cycle from its arrays
+	friend class UCharacterStateManager;
+
+private:
+
+	// Respawn Variables. The countdown and cycle live in the state manager, at stateSlot.
+	float respawnDelay;
+	int32 lastRespawnIndex;
+	int32 stateSlot;
+	TWeakObjectPtr<class UCharacterStateManager> stateManager;
+
+	// Respawn Methods
+	void FindRespawnLocations();
+	void DisablePlayer();
+	void ChooseRandomRespawnPoint();
+	int32 ChooseSafeRespawnIndex() const;
+	void Respawn();
+	void UpdateRespawn(float DeltaTime);
+
+	// Tick only when there is something to do: fixed timestep steps, or our own respawn update when not batched
+	void UpdateActorTickEnabled();
+
+	// Turn collision, mesh, movement and camera off while dead and back on at respawn
+	void SetPlayerActive(bool bActive);
+
+	// Player State Method
+	void FindPlayerState();
+
+	// Fixed Timestep Variables
+	bool useFixedTimestep;
+	FFixedStepSimulation FixedStep;
+	float turnRateInput;
+	float lookUpRateInput;
+	FTransform MeshBaseTransform;
+	FTransform SpringArmBaseTransform;
+
+	// Fixed Timestep Methods
+	void SetupFixedTimestep();
+	void SimulateFixedStep(float StepTime);
+
+	// Turn the view by one step's look input straight away, so the step's movement uses it
+	void ApplyStepLookInput(float StepTime);
+
+	// Apply the current movement input along the controller's forward/right
+	void AddForwardMovement();
+	void AddRightMovement();
+
+	// Input Latency Methods
+	void TrackInputLatency(float Value);
+	void TrackInputApplied();
+
+	// Send the run input to the server when its quantised value changes, once a frame after both axes are read
+	void UpdateReplicatedRunInput();
+
+	// Sends of the current RunInput still to go
+	uint8 runInputSendsLeft;
+
+	// Stance Methods
+	void ToggleCrouch();
+	void ToggleProne();
+	void ApplyStance();
+
+	// Stance the capsule and walk speed are currently set for
+	ECharacterStance appliedStance;
+
+	// Run variables of an AnimBP that isn't parented to ULocomotionAnimInstance, found once in BeginPlay
+	class UFloatProperty* forwardAnimProp;
+	class UFloatProperty* rightAnimProp;
+		
+public:
+
+	// Sets default values for this character's properties
+	AP2_Character(const FObjectInitializer &ObjectInitializer);
+
+protected:
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when destroyed or the map changes
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Stop replicating run input while dead
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	// Called when a controller takes or releases this pawn
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+	virtual void PawnClientRestart() override;
+
+	// Spring arm and camera for a local player, created on possession and destroyed on unpossession
+	void CreatePlayerCamera();
+	void DestroyPlayerCamera();
+
+	// Run input for other clients' animation, replicated to everyone but the owner
+	UPROPERTY(ReplicatedUsing = OnRep_RunInput)
+	FReplicatedRunInput RunInput;
+
+	UFUNCTION()
+	void OnRep_RunInput();
+
+	// Unreliable, each send is a snapshot the next one supersedes. See FReplicatedRunInput::SendCount.
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerSetRunInput(FReplicatedRunInput NewRunInput);
+
+	UFUNCTION()
+	void OnRep_Stance();
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerSetStance(ECharacterStance NewStance);
+
+	// Animation Instance Reference, owned by PlayerMesh
+	UPROPERTY(Transient)
+	class UAnimInstance* animInstance;
+
+	// The same instance when the AnimBP is parented to ULocomotionAnimInstance, otherwise NULL
+	UPROPERTY(Transient)
+	class ULocomotionAnimInstance* locomotionAnim;
+
+	// Player State of the local player controlling us. Weak, its controller owns it and may leave first.
+	TWeakObjectPtr<class ALocalMultiplayerDemoPlayerState> myPlayerState;
+
+public:	
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Properties replicated to clients
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Called to bind functionality to input
+	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+	// References to Collision, Mesh, and Character Movement Components
+	class UCapsuleComponent* CollisionComp;
+	class USkeletalMeshComponent* PlayerMesh;
+	class UCharacterMovementComponent* CharacterMove;
+	
+	// Spring Arm Component, NULL unless a local player controls us
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Camera")
+	class USpringArmComponent* CameraSpringArm;
+
+	// Camera Component, NULL unless a local player controls us
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Camera")
+	class UCameraComponent* PlayerCamera;
+
+	// Actor Movement
+	void MoveForward(float v);
+	void MoveRight(float h);
+
+	// Actor Animation
+	void RunForwardAnimation(float amount);
+	void RunRightAnimation(float amount);
+		
+	// Called via input to turn at a given rate.
+	void TurnAtRate(float Rate);
+
+	// Called via input to turn look up/down at a given rate.
+	void LookUpAtRate(float Rate);
+
+	// Character Stats Variables
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character Stats")
+	float horizontal;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character Stats")
+	float vertical;
+
+	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite, Category = "Character Stats")
+	int32 TotalScore;
+
+	// Add to TotalScore and the player state's copy of it
+	void AddScore(int32 Amount);
+
+	// Stance, decided by the server
+	UPROPERTY(ReplicatedUsing = OnRep_Stance, VisibleInstanceOnly, BlueprintReadOnly, Category = "Stance")
+	ECharacterStance Stance;
+
+	// Capsule size and walk speed for each stance
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Stance")
+	FStanceTable StanceSettings;
+
+	// Change stance, unless there isn't room to get up where we are
+	void SetStance(ECharacterStance NewStance);
+
+	UPROPERTY(ReplicatedUsing = OnRep_IsDead, EditAnywhere, BlueprintReadOnly, Category = "Character Stats")
+	bool isDead;
+
+	UFUNCTION()
+	void OnRep_IsDead();
+
+	// Start the disable/respawn cycle, if not already dead. Setting isDead alone doesn't, the state manager has to know.
+	void Kill();
+
+	// Start a new round at this spot: alive, standing, still and with no score. Called by the game mode's ResetRound.
+	void ResetForRound(const FVector& Location, const FRotator& Rotation);
+
+	// Base turn rate, in deg/sec. Other scaling may affect final turn rate
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
+	float BaseTurnRate;
+
+	// Base look up/down rate, in deg/sec. Other scaling may affect final rate
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
+	float BaseLookUpRate;
+	
+protected:
+
+	// Animation Blueprint Variable References
+	static const FName HorizontalAnimName;
+	static const FName VerticalAnimName;
+
+	// Player Tag Name
+	static const FName MyTagName;
+
+public:
+
+	// Respawn Locations Array, filled from the game mode's registered respawn points
+	UPROPERTY(VisibleInstanceOnly, Transient, Category = "Spawn Locations")
+	TArray<class ARespawnPoint*> RespawnLocation;
+		
+public:
+
+	// Returns CameraSpringArm, NULL unless a local player controls us
+	FORCEINLINE class USpringArmComponent* GetCameraSpringArm() const { return CameraSpringArm; }
+
+	// Returns PlayerCamera, NULL unless a local player controls us
+	FORCEINLINE class UCameraComponent* GetPlayerCamera() const { return PlayerCamera; }
+
+	// Returns seconds left until a dead player two respawns, the full delay where there is no state manager
+	float GetRespawnCountdown() const;
+
+	// Returns the respawn point last chosen for us, INDEX_NONE before the first respawn
+	FORCEINLINE int32 GetLastRespawnIndex() const { return lastRespawnIndex; }
+
+};
@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerMemoryReport.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoHUD.h"
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "PlayerRegistry.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "Camera/CameraComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Blueprint/UserWidget.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "EngineUtils.h"
+
+DECLARE_MEMORY_STAT(TEXT("Player 0 Memory"), STAT_PlayerMemory_0, STATGROUP_LocalMultiplayerDemo);
+DECLARE_MEMORY_STAT(TEXT("Player 1 Memory"), STAT_PlayerMemory_1, STATGROUP_LocalMultiplayerDemo);
+DECLARE_MEMORY_STAT(TEXT("Player 2 Memory"), STAT_PlayerMemory_2, STATGROUP_LocalMultiplayerDemo);
+DECLARE_MEMORY_STAT(TEXT("Player 3 Memory"), STAT_PlayerMemory_3, STATGROUP_LocalMultiplayerDemo);
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("LocalMultiplayer Player 0"), STAT_LLM_Player_0, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("LocalMultiplayer Player 1"), STAT_LLM_Player_1, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("LocalMultiplayer Player 2"), STAT_LLM_Player_2, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("LocalMultiplayer Player 3"), STAT_LLM_Player_3, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("LocalMultiplayer Other"), STAT_LLM_Player_Other, STATGROUP_LLMFULL);
+#endif
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GPlayerMemReportCommand(
+	TEXT("LocalMultiplayer.MemReport"),
+	TEXT("Prints the memory held by each local player's pawn, mesh, anim instance, camera, HUD, widget, camera manager and player state, and what lazily created cameras save"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		FPlayerMemoryReport::Print(World, Ar);
+	}));
+
+// Size of the object itself plus any resources it owns exclusively
+static SIZE_T GetObjectMemory(const UObject* Object)
+{
+	if (Object == nullptr)
+		return 0;
+
+	FArchiveCountMem CountMem(const_cast<UObject*>(Object));
+	return CountMem.GetMax() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+}
+
+void FPlayerMemoryReport::Gather(UWorld* World, TArray<FSlot>& OutSlots)
+{
+	OutSlots.Reset();
+
+	if (World == nullptr)
+		return;
+
+	class UPlayerRegistry* Registry = UPlayerRegistry::Get(World);
+
+	if (Registry == nullptr)
+		return;
+
+	for (int32 PlayerSlot = 0; PlayerSlot < UPlayerRegistry::MaxSlots; ++PlayerSlot)
+	{
+		class APlayerController* PlayerController = Registry->GetController(PlayerSlot);
+
+		if (PlayerController == nullptr)
+			continue;
+
+		FSlot Slot;
+		Slot.ControllerId = PlayerSlot;
+
+		if (class ACharacter* Character = Cast<ACharacter>(Registry->GetPawn(PlayerSlot)))
+		{
+			Slot.Pawn = GetObjectMemory(Character);
+			Slot.Mesh = GetObjectMemory(Character->GetMesh());
+			Slot.AnimInstance = Character->GetMesh() ? GetObjectMemory(Character->GetMesh()->GetAnimInstance()) : 0;
+			Slot.SpringArm = GetObjectMemory(Character->FindComponentByClass<USpringArmComponent>());
+			Slot.Camera = GetObjectMemory(Character->FindComponentByClass<UCameraComponent>());
+		}
+
+		Slot.HUD = GetObjectMemory(Registry->GetHUD(PlayerSlot));
+
+		if (class ALocalMultiplayerDemoHUD* HUD = Cast<ALocalMultiplayerDemoHUD>(Registry->GetHUD(PlayerSlot)))
+			Slot.Widget = GetObjectMemory(HUD->PlayerUI);
+
+		Slot.CameraManager = GetObjectMemory(PlayerController->PlayerCameraManager);
+		Slot.PlayerState = GetObjectMemory(Registry->GetPlayerState(PlayerSlot));
+
+		OutSlots.Add(Slot);
+	}
+}
+
+void FPlayerMemoryReport::Print(UWorld* World, FOutputDevice& Ar)
+{
+	TArray<FSlot> Slots;
+	Gather(World, Slots);
+
+	SIZE_T Total = 0;
+
+	for (const FSlot& Slot : Slots)
+	{
+		Ar.Logf(TEXT("Player %d: %.1f KB (pawn %.1f, mesh %.1f, anim %.1f, spring arm %.1f, camera %.1f, HUD %.1f, widget %.1f, camera manager %.1f, player state %.1f)"),
+			Slot.ControllerId, Slot.GetTotal() / 1024.f, Slot.Pawn / 1024.f, Slot.Mesh / 1024.f, Slot.AnimInstance / 1024.f, Slot.SpringArm / 1024.f,
+			Slot.Camera / 1024.f, Slot.HUD / 1024.f, Slot.Widget / 1024.f, Slot.CameraManager / 1024.f, Slot.PlayerState / 1024.f);
+
+		Total += Slot.GetTotal();
+	}
+
+	Ar.Logf(TEXT("%d local players, %.1f KB total"), Slots.Num(), Total / 1024.f);
+
+	PrintCameraSavings(World, Ar);
+}
+
+// Characters only get a spring arm and camera while a local player controls them, so every other character saves a pair
+void FPlayerMemoryReport::PrintCameraSavings(UWorld* World, FOutputDevice& Ar)
+{
+	if (World == nullptr)
+		return;
+
+	int32 NumWithoutCamera = 0;
+
+	for (TActorIterator<ACharacter> It(World); It; ++It)
+	{
+		if (It->FindComponentByClass<UCameraComponent>() == nullptr)
+			++NumWithoutCamera;
+	}
+
+	// The class defaults are what a freshly created pair would cost
+	const USpringArmComponent* SpringArm = GetDefault<USpringArmComponent>();
+	const UCameraComponent* Camera = GetDefault<UCameraComponent>();
+	const SIZE_T BytesPerCharacter = GetObjectMemory(SpringArm) + GetObjectMemory(Camera);
+	const int32 TicksPerCharacter = (SpringArm->PrimaryComponentTick.bCanEverTick ? 1 : 0) + (Camera->PrimaryComponentTick.bCanEverTick ? 1 : 0);
+
+	Ar.Logf(TEXT("%d non-player characters without a camera, saving %.1f KB and %d component ticks each (%.1f KB, %d ticks in all)"),
+		NumWithoutCamera, BytesPerCharacter / 1024.f, TicksPerCharacter, (NumWithoutCamera * BytesPerCharacter) / 1024.f, NumWithoutCamera * TicksPerCharacter);
+}
+
+void FPlayerMemoryReport::UpdateStats(UWorld* World)
+{
+#if STATS
+	TArray<FSlot> Slots;
+	Gather(World, Slots);
+
+	for (const FSlot& Slot : Slots)
+	{
+		switch (Slot.ControllerId)
+		{
+		case 0: SET_MEMORY_STAT(STAT_PlayerMemory_0, Slot.GetTotal()); break;
+		case 1: SET_MEMORY_STAT(STAT_PlayerMemory_1, Slot.GetTotal()); break;
+		case 2: SET_MEMORY_STAT(STAT_PlayerMemory_2, Slot.GetTotal()); break;
+		case 3: SET_MEMORY_STAT(STAT_PlayerMemory_3, Slot.GetTotal()); break;
+		default: break;
+		}
+	}
+#endif
+}
+
+FName FPlayerMemoryReport::GetSlotStatName(int32 Slot)
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	switch (Slot)
+	{
+	case 0: return GET_STATFNAME(STAT_LLM_Player_0);
+	case 1: return GET_STATFNAME(STAT_LLM_Player_1);
+	case 2: return GET_STATFNAME(STAT_LLM_Player_2);
+	case 3: return GET_STATFNAME(STAT_LLM_Player_3);
+	default: return GET_STATFNAME(STAT_LLM_Player_Other);
+	}
+#else
+	return NAME_None;
+#endif
+}
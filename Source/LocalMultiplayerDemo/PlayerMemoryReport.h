@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+// Tag allocations made in this scope with a local player slot in the low level memory tracker (-llm)
+#define LLM_SCOPE_PLAYER_SLOT(Slot) LLM_SCOPED_TAG_WITH_STAT_NAME(FPlayerMemoryReport::GetSlotStatName(Slot), ELLMTracker::Default)
+
+// Per local player memory accounting. Run "LocalMultiplayer.MemReport" in the console for a breakdown.
+struct LOCALMULTIPLAYERDEMO_API FPlayerMemoryReport
+{
+	// Memory held by one local player's objects, in bytes
+	struct FSlot
+	{
+		int32 ControllerId;
+		SIZE_T Pawn;
+		SIZE_T Mesh;
+		SIZE_T AnimInstance;
+		SIZE_T SpringArm;
+		SIZE_T Camera;
+		SIZE_T HUD;
+		SIZE_T Widget;
+		SIZE_T CameraManager;
+		SIZE_T PlayerState;
+
+		FSlot() { FMemory::Memzero(*this); }
+
+		SIZE_T GetTotal() const { return Pawn + Mesh + AnimInstance + SpringArm + Camera + HUD + Widget + CameraManager + PlayerState; }
+	};
+
+	// Measure every local player in the world
+	static void Gather(class UWorld* World, TArray<FSlot>& OutSlots);
+
+	// Gather and write a human readable report
+	static void Print(class UWorld* World, FOutputDevice& Ar);
+
+	// What not creating cameras for non-player characters saves
+	static void PrintCameraSavings(class UWorld* World, FOutputDevice& Ar);
+
+	// Gather and push the totals into STATGROUP_LocalMultiplayerDemo
+	static void UpdateStats(class UWorld* World);
+
+	// LLM stat used for a slot
+	static FName GetSlotStatName(int32 Slot);
+
+};
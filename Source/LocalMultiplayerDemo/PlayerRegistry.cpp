@@ -0,0 +1,161 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PlayerRegistry.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/HUD.h"
+#include "Engine/LocalPlayer.h"
+
+UPlayerRegistry::UPlayerRegistry()
+{
+	Slots.SetNum(MaxSlots);
+}
+
+UPlayerRegistry* UPlayerRegistry::Get(const UObject* WorldContextObject)
+{
+	class UWorld* const world = WorldContextObject ? WorldContextObject->GetWorld() : NULL;
+	class ALocalMultiplayerDemoGameModeBase* GameMode = world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+
+	return GameMode ? GameMode->PlayerRegistry : NULL;
+}
+
+int32 UPlayerRegistry::GetSlotIndex(const AController* Controller)
+{
+	const class APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	const class ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : NULL;
+
+	return LocalPlayer ? LocalPlayer->GetControllerId() : INDEX_NONE;
+}
+
+#pragma region Updates
+void UPlayerRegistry::RegisterController(APlayerController* Controller)
+{
+	const int32 Slot = GetSlotIndex(Controller);
+
+	if (!IsValidSlot(Slot))
+		return;
+
+	FLocalPlayerSlot& Entry = Slots[Slot];
+	Entry.Controller = Controller;
+	Entry.Pawn = Controller->GetPawn();
+	Entry.PlayerState = Cast<ALocalMultiplayerDemoPlayerState>(Controller->PlayerState);
+	Entry.HUD = Controller->GetHUD();
+
+	OnSlotChanged.Broadcast(Slot);
+}
+
+void UPlayerRegistry::UnregisterController(AController* Controller)
+{
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (Slots[Slot].Controller != nullptr && Slots[Slot].Controller == Controller)
+		{
+			Slots[Slot] = FLocalPlayerSlot();
+			OnSlotChanged.Broadcast(Slot);
+		}
+	}
+}
+
+void UPlayerRegistry::NotifyPossessed(APawn* Pawn, AController* Controller)
+{
+	const int32 Slot = GetSlotIndex(Controller);
+
+	if (!IsValidSlot(Slot))
+		return;
+
+	// Possession can happen before PostLogin has registered the controller, so refresh the whole slot.
+	// The controller's own pawn pointer isn't updated until after PossessedBy, so take the pawn we were given.
+	FLocalPlayerSlot& Entry = Slots[Slot];
+	Entry.Controller = Cast<APlayerController>(Controller);
+	Entry.Pawn = Pawn;
+	Entry.PlayerState = Cast<ALocalMultiplayerDemoPlayerState>(Controller->PlayerState);
+	Entry.HUD = Entry.Controller->GetHUD();
+
+	OnSlotChanged.Broadcast(Slot);
+}
+
+void UPlayerRegistry::NotifyUnPossessed(APawn* Pawn, AController* Controller)
+{
+	const int32 Slot = GetSlotIndex(Controller);
+
+	if (IsValidSlot(Slot) && Slots[Slot].Pawn == Pawn)
+	{
+		Slots[Slot].Pawn = NULL;
+		OnSlotChanged.Broadcast(Slot);
+	}
+}
+#pragma endregion
+
+#pragma region Lookups
+APlayerController* UPlayerRegistry::GetController(int32 Slot) const
+{
+	return IsValidSlot(Slot) && IsValid(Slots[Slot].Controller) ? Slots[Slot].Controller : NULL;
+}
+
+APawn* UPlayerRegistry::GetPawn(int32 Slot) const
+{
+	return IsValidSlot(Slot) && IsValid(Slots[Slot].Pawn) ? Slots[Slot].Pawn : NULL;
+}
+
+ALocalMultiplayerDemoPlayerState* UPlayerRegistry::GetPlayerState(int32 Slot) const
+{
+	return IsValidSlot(Slot) && IsValid(Slots[Slot].PlayerState) ? Slots[Slot].PlayerState : NULL;
+}
+
+AHUD* UPlayerRegistry::GetHUD(int32 Slot) const
+{
+	// HUDs can be destroyed from under us (SetupTwoPlayers does), IsValid catches those
+	return IsValidSlot(Slot) && IsValid(Slots[Slot].HUD) ? Slots[Slot].HUD : NULL;
+}
+
+int32 UPlayerRegistry::GetPrimarySlot() const
+{
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (GetController(Slot) != nullptr)
+			return Slot;
+	}
+
+	return INDEX_NONE;
+}
+
+int32 UPlayerRegistry::FindFreeSlot() const
+{
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (GetController(Slot) == nullptr)
+			return Slot;
+	}
+
+	return INDEX_NONE;
+}
+
+int32 UPlayerRegistry::GetNumPlayers() const
+{
+	int32 NumPlayers = 0;
+
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (GetController(Slot) != nullptr)
+			++NumPlayers;
+	}
+
+	return NumPlayers;
+}
+
+int32 UPlayerRegistry::FindSlotForPawn(const APawn* Pawn) const
+{
+	if (Pawn == nullptr)
+		return INDEX_NONE;
+
+	for (int32 Slot = 0; Slot < MaxSlots; ++Slot)
+	{
+		if (Slots[Slot].Pawn == Pawn)
+			return Slot;
+	}
+
+	return INDEX_NONE;
+}
+#pragma endregion
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "PlayerRegistry.generated.h"
+
+// Everything we track for one local player
+USTRUCT()
+struct FLocalPlayerSlot
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	class APlayerController* Controller;
+
+	UPROPERTY()
+	class APawn* Pawn;
+
+	UPROPERTY()
+	class ALocalMultiplayerDemoPlayerState* PlayerState;
+
+	UPROPERTY()
+	class AHUD* HUD;
+
+	FLocalPlayerSlot()
+	{
+		Controller = NULL;
+		Pawn = NULL;
+		PlayerState = NULL;
+		HUD = NULL;
+	}
+
+};
+
+// Slot index that changed
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPlayerSlotChanged, int32);
+
+// Tracks the controller, pawn, player state and HUD of each local player slot, so they can be found
+// without world scans or hard-coded controller indices. Owned by the game mode, so it lives as long as the world.
+// Kept up to date from PostLogin/Logout in the game mode and PossessedBy/UnPossessed in the characters.
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API UPlayerRegistry : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UPlayerRegistry();
+
+	// Most local players we support
+	static const int32 MaxSlots = 4;
+
+	// Registry of the world this object is in, NULL where there is no game mode (e.g. network clients)
+	static UPlayerRegistry* Get(const UObject* WorldContextObject);
+
+	// Slot a controller belongs in (its local player's controller id), or INDEX_NONE if it isn't a local player
+	static int32 GetSlotIndex(const class AController* Controller);
+
+	// Broadcast whenever anything in a slot changes
+	FOnPlayerSlotChanged OnSlotChanged;
+
+public:
+
+	// Re-read a controller's pawn, player state and HUD into its slot
+	void RegisterController(class APlayerController* Controller);
+	void UnregisterController(class AController* Controller);
+
+	// Called by pawns from PossessedBy/UnPossessed
+	void NotifyPossessed(class APawn* Pawn, class AController* Controller);
+	void NotifyUnPossessed(class APawn* Pawn, class AController* Controller);
+
+public:
+
+	class APlayerController* GetController(int32 Slot) const;
+	class APawn* GetPawn(int32 Slot) const;
+	class ALocalMultiplayerDemoPlayerState* GetPlayerState(int32 Slot) const;
+	class AHUD* GetHUD(int32 Slot) const;
+
+	// Lowest slot with a controller, the player that owns shared UI. INDEX_NONE if there are no players.
+	int32 GetPrimarySlot() const;
+
+	// Lowest slot without a controller, INDEX_NONE if all are taken
+	int32 FindFreeSlot() const;
+
+	// Number of slots with a controller
+	int32 GetNumPlayers() const;
+
+	// Slot whose controller possesses this pawn, INDEX_NONE if none
+	int32 FindSlotForPawn(const class APawn* Pawn) const;
+
+	FORCEINLINE bool IsValidSlot(int32 Slot) const { return Slot >= 0 && Slot < MaxSlots; }
+
+private:
+
+	UPROPERTY()
+	TArray<FLocalPlayerSlot> Slots;
+
+};
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicatedRunInput.generated.h"
+
+// Run animation input quantised to a signed byte per axis, so other clients can animate a character for two bytes.
+// Sent unreliably at most once a frame, only when the quantised value changes, and then on SendCount frames in a row
+// so a dropped packet doesn't leave the server with a stale value (e.g. a release to zero).
+USTRUCT()
+struct FReplicatedRunInput
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	int8 Horizontal;
+
+	UPROPERTY()
+	int8 Vertical;
+
+	FReplicatedRunInput() : Horizontal(0), Vertical(0) {}
+
+	FReplicatedRunInput(float InHorizontal, float InVertical) : Horizontal(Quantize(InHorizontal)), Vertical(Quantize(InVertical)) {}
+
+	FORCEINLINE float GetHorizontal() const { return Horizontal / 127.f; }
+	FORCEINLINE float GetVertical() const { return Vertical / 127.f; }
+
+	FORCEINLINE bool operator==(const FReplicatedRunInput& Other) const { return Horizontal == Other.Horizontal && Vertical == Other.Vertical; }
+	FORCEINLINE bool operator!=(const FReplicatedRunInput& Other) const { return !(*this == Other); }
+
+	// Frames each new value is sent on
+	static const uint8 SendCount = 3;
+
+	// Axis input is -1..1
+	static int8 Quantize(float Value) { return (int8)FMath::RoundToInt(FMath::Clamp(Value, -1.f, 1.f) * 127.f); }
+
+};
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RespawnBakeCommandlet.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "RespawnBakeData.h"
+#include "RespawnPoint.h"
+#include "P2_Character.h"
+#include "AI/Navigation/NavigationSystem.h"
+#include "AI/Navigation/NavigationPath.h"
+#include "Engine/LevelBounds.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "AssetRegistryModule.h"
+#include "EngineUtils.h"
+
+URespawnBakeCommandlet::URespawnBakeCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 URespawnBakeCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	// Map to bake, defaults to the game's default map
+	FString MapPath;
+
+	if (ParamVals.Contains(TEXT("Map")))
+		MapPath = ParamVals[TEXT("Map")];
+	else
+		GConfig->GetString(TEXT("/Script/EngineSettings.GameMapsSettings"), TEXT("GameDefaultMap"), MapPath, GEngineIni);
+
+	const float CellSize = ParamVals.Contains(TEXT("CellSize")) ? FCString::Atof(*ParamVals[TEXT("CellSize")]) : 200.f;
+
+	UPackage* MapPackage = LoadPackage(NULL, *MapPath, LOAD_None);
+	class UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : NULL;
+
+	if (World == nullptr)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("RespawnBake: couldn't load map '%s'"), *MapPath);
+		return 1;
+	}
+
+	// Bring the world up far enough for traces and navigation queries
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+
+	if (!World->bIsWorldInitialized)
+	{
+		UWorld::InitializationValues IVS;
+		IVS.RequiresHitProxies(false);
+		IVS.ShouldSimulatePhysics(false);
+		IVS.EnableTraceCollision(true);
+		IVS.CreateNavigation(true);
+		IVS.CreatePhysicsScene(true);
+		World->InitWorld(IVS);
+	}
+
+	World->UpdateWorldComponents(true, false);
+
+	UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(World);
+
+	if (NavSys != nullptr)
+		NavSys->Build();
+	else
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("RespawnBake: %s has no navigation, path distances will all be unreachable"), *MapPath);
+
+	// Bake the respawn points placed in the map (an arena sub-level), in respawn order
+	TArray<class ARespawnPoint*> PlacedPoints;
+
+	for (TActorIterator<ARespawnPoint> It(World); It; ++It)
+		PlacedPoints.Add(*It);
+
+	PlacedPoints.Sort([](const ARespawnPoint& A, const ARespawnPoint& B) { return A.RespawnIndex < B.RespawnIndex; });
+
+	TArray<FVector> RespawnPositions;
+
+	for (const class ARespawnPoint* Point : PlacedPoints)
+		RespawnPositions.Add(Point->GetActorLocation());
+
+	// Without any, respawn points are generated by the game mode at runtime, so bake from its default settings
+	if (RespawnPositions.Num() == 0)
+		GetDefault<ALocalMultiplayerDemoGameModeBase>()->RespawnSetup.GetRespawnPositions(RespawnPositions);
+
+	// Cover the level geometry plus the respawn points themselves
+	FBox Bounds = ALevelBounds::CalculateLevelBounds(World->PersistentLevel);
+
+	for (const FVector& Position : RespawnPositions)
+		Bounds += Position;
+
+	const FVector Size = Bounds.GetSize();
+	const int32 CellsX = FMath::Clamp(FMath::CeilToInt(Size.X / CellSize), 1, 256);
+	const int32 CellsY = FMath::Clamp(FMath::CeilToInt(Size.Y / CellSize), 1, 256);
+
+	const FString MapName = FPackageName::GetShortName(MapPath);
+	const FString PackageName = ALocalMultiplayerDemoGameModeBase::GetRespawnBakePackageName(MapName);
+	UPackage* Package = CreatePackage(NULL, *PackageName);
+	Package->FullyLoad();
+
+	const FName AssetName(*FPackageName::GetShortName(PackageName));
+	URespawnBakeData* BakeData = FindObject<URespawnBakeData>(Package, *AssetName.ToString());
+
+	if (BakeData == nullptr)
+	{
+		BakeData = NewObject<URespawnBakeData>(Package, AssetName, RF_Public | RF_Standalone);
+		FAssetRegistryModule::AssetCreated(BakeData);
+	}
+
+	BakeData->Initialize(FVector(Bounds.Min.X, Bounds.Min.Y, Bounds.Min.Z), CellSize, CellsX, CellsY, RespawnPositions);
+
+	const double StartTime = FPlatformTime::Seconds();
+	BakeTables(World, BakeData, GetDefault<AP2_Character>()->BaseEyeHeight);
+
+	UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("RespawnBake: %d points x %d areas (%dx%d, %.0fcm) in %.2fs, %d bytes"),
+		BakeData->NumRespawnPoints, BakeData->GetNumCells(), CellsX, CellsY, CellSize, FPlatformTime::Seconds() - StartTime,
+		BakeData->VisibilityBits.Num() * sizeof(uint32) + BakeData->PathDistances.Num() * sizeof(uint16));
+
+	BakeData->MarkPackageDirty();
+
+	const FString Filename = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	const bool bSaved = UPackage::SavePackage(Package, BakeData, RF_Public | RF_Standalone, *Filename);
+
+	World->CleanupWorld();
+	World->RemoveFromRoot();
+
+	if (!bSaved)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("RespawnBake: failed to save %s"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("RespawnBake: saved %s"), *Filename);
+	return 0;
+#else
+	UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("RespawnBake must be run from the editor"));
+	return 1;
+#endif
+}
+
+void URespawnBakeCommandlet::BakeTables(UWorld* World, URespawnBakeData* BakeData, float EyeHeight)
+{
+	UNavigationSystem* NavSys = UNavigationSystem::GetCurrent<UNavigationSystem>(World);
+	const FVector EyeOffset(0.f, 0.f, EyeHeight);
+	const FVector ProjectExtent(BakeData->CellSize * 0.5f, BakeData->CellSize * 0.5f, 1000.f);
+
+	FCollisionQueryParams TraceParams(FName(TEXT("RespawnBake")), false);
+
+	// Snap each area center onto the navmesh once. Areas with no floor are left unseen and unreachable.
+	TArray<FVector> CellPoints;
+	TBitArray<> CellValid(false, BakeData->GetNumCells());
+	CellPoints.SetNumUninitialized(BakeData->GetNumCells());
+
+	for (int32 Cell = 0; Cell < BakeData->GetNumCells(); ++Cell)
+	{
+		const FVector Center = BakeData->GetCellCenter(Cell) + FVector(0.f, 0.f, ProjectExtent.Z * 0.5f);
+		FNavLocation NavLocation;
+
+		if (NavSys && NavSys->ProjectPointToNavigation(Center, NavLocation, ProjectExtent))
+		{
+			CellPoints[Cell] = NavLocation.Location;
+			CellValid[Cell] = true;
+		}
+		else
+		{
+			CellPoints[Cell] = Center;
+		}
+	}
+
+	for (int32 Point = 0; Point < BakeData->NumRespawnPoints; ++Point)
+	{
+		FVector PointLocation = BakeData->RespawnPositions[Point];
+		FNavLocation NavLocation;
+
+		if (NavSys && NavSys->ProjectPointToNavigation(PointLocation, NavLocation, ProjectExtent))
+			PointLocation = NavLocation.Location;
+
+		for (int32 Cell = 0; Cell < BakeData->GetNumCells(); ++Cell)
+		{
+			if (!CellValid[Cell])
+				continue;
+
+			// Eye to eye line of sight
+			if (!World->LineTraceTestByChannel(CellPoints[Cell] + EyeOffset, PointLocation + EyeOffset, ECC_Visibility, TraceParams))
+				BakeData->SetPointVisibleFromCell(Point, Cell);
+
+			UNavigationPath* Path = UNavigationSystem::FindPathToLocationSynchronously(World, PointLocation, CellPoints[Cell]);
+
+			if (Path && Path->IsValid() && !Path->IsPartial())
+				BakeData->SetPathDistance(Point, Cell, Path->GetPathLength());
+		}
+	}
+}
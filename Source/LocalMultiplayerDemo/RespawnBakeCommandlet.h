@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "RespawnBakeCommandlet.generated.h"
+
+// Bakes respawn point visibility and navmesh path distances for a map into a URespawnBakeData asset.
+// Bake each arena sub-level on its own, the game mode loads the bake named after the arena being played.
+// Usage: UE4Editor-Cmd LocalMultiplayerDemo.uproject -run=RespawnBake [-Map=/Game/Path/To/Map] [-CellSize=200]
+UCLASS()
+class URespawnBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	URespawnBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+
+	// Fill the visibility and path tables for every respawn point
+	void BakeTables(class UWorld* World, class URespawnBakeData* BakeData, float EyeHeight);
+
+};
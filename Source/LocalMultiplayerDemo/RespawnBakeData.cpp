@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RespawnBakeData.h"
+#include "LocalMultiplayerDemo.h"
+
+const float URespawnBakeData::PathDistanceScale = 10.f;
+const uint16 URespawnBakeData::UnreachableDistance = MAX_uint16;
+
+URespawnBakeData::URespawnBakeData()
+{
+	GridOrigin = FVector::ZeroVector;
+	CellSize = 200.f;
+	CellsX = 0;
+	CellsY = 0;
+	NumRespawnPoints = 0;
+}
+
+void URespawnBakeData::Initialize(const FVector& InOrigin, float InCellSize, int32 InCellsX, int32 InCellsY, const TArray<FVector>& InRespawnPositions)
+{
+	GridOrigin = InOrigin;
+	CellSize = FMath::Max(InCellSize, 1.f);
+	CellsX = FMath::Max(InCellsX, 1);
+	CellsY = FMath::Max(InCellsY, 1);
+	NumRespawnPoints = InRespawnPositions.Num();
+	RespawnPositions = InRespawnPositions;
+
+	VisibilityBits.Reset();
+	VisibilityBits.AddZeroed(NumRespawnPoints * GetWordsPerPoint());
+
+	PathDistances.Reset();
+	PathDistances.Init(UnreachableDistance, NumRespawnPoints * GetNumCells());
+}
+
+int32 URespawnBakeData::GetCellIndex(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt((Location.X - GridOrigin.X) / CellSize);
+	const int32 Y = FMath::FloorToInt((Location.Y - GridOrigin.Y) / CellSize);
+
+	if (X < 0 || Y < 0 || X >= CellsX || Y >= CellsY)
+		return INDEX_NONE;
+
+	return Y * CellsX + X;
+}
+
+FVector URespawnBakeData::GetCellCenter(int32 CellIndex) const
+{
+	const int32 X = CellIndex % CellsX;
+	const int32 Y = CellIndex / CellsX;
+
+	return GridOrigin + FVector((X + 0.5f) * CellSize, (Y + 0.5f) * CellSize, 0.f);
+}
+
+bool URespawnBakeData::IsPointVisibleFromCell(int32 PointIndex, int32 CellIndex) const
+{
+	const int32 Word = PointIndex * GetWordsPerPoint() + (CellIndex >> 5);
+
+	if (!VisibilityBits.IsValidIndex(Word))
+		return false;
+
+	return (VisibilityBits[Word] & (1u << (CellIndex & 31))) != 0;
+}
+
+void URespawnBakeData::SetPointVisibleFromCell(int32 PointIndex, int32 CellIndex)
+{
+	const int32 Word = PointIndex * GetWordsPerPoint() + (CellIndex >> 5);
+
+	if (VisibilityBits.IsValidIndex(Word))
+		VisibilityBits[Word] |= (1u << (CellIndex & 31));
+}
+
+float URespawnBakeData::GetPathDistance(int32 PointIndex, int32 CellIndex) const
+{
+	const int32 Index = PointIndex * GetNumCells() + CellIndex;
+
+	if (!PathDistances.IsValidIndex(Index) || PathDistances[Index] == UnreachableDistance)
+		return -1.f;
+
+	return PathDistances[Index] * PathDistanceScale;
+}
+
+void URespawnBakeData::SetPathDistance(int32 PointIndex, int32 CellIndex, float Distance)
+{
+	const int32 Index = PointIndex * GetNumCells() + CellIndex;
+
+	if (PathDistances.IsValidIndex(Index))
+	{
+		// Clamp below the unreachable marker so very long paths still read back as reachable
+		const int32 Quantized = FMath::RoundToInt(Distance / PathDistanceScale);
+		PathDistances[Index] = (uint16)FMath::Clamp(Quantized, 0, (int32)UnreachableDistance - 1);
+	}
+}
+
+bool URespawnBakeData::MatchesRespawnPositions(const TArray<FVector>& Positions) const
+{
+	if (Positions.Num() != RespawnPositions.Num())
+		return false;
+
+	for (int32 i = 0; i < Positions.Num(); ++i)
+	{
+		if (!Positions[i].Equals(RespawnPositions[i], 1.f))
+			return false;
+	}
+
+	return true;
+}
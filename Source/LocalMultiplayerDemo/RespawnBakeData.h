@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "RespawnBakeData.generated.h"
+
+// Precomputed respawn point safety data for one map, written by URespawnBakeCommandlet.
+// The arena is split into a uniform grid of areas. For every respawn point we store which areas
+// can see it and the navmesh path distance to each area, so runtime selection is a table lookup.
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API URespawnBakeData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	URespawnBakeData();
+
+	// Path distances are stored in units of this many cm
+	static const float PathDistanceScale;
+
+	// Stored path distance for areas that can't be reached from a point
+	static const uint16 UnreachableDistance;
+
+public:
+
+	// World position of the grid's minimum corner
+	UPROPERTY(VisibleAnywhere, Category = "Grid")
+	FVector GridOrigin;
+
+	// Edge length of one area, in cm
+	UPROPERTY(VisibleAnywhere, Category = "Grid")
+	float CellSize;
+
+	UPROPERTY(VisibleAnywhere, Category = "Grid")
+	int32 CellsX;
+
+	UPROPERTY(VisibleAnywhere, Category = "Grid")
+	int32 CellsY;
+
+	// Number of respawn points baked (rows of both tables)
+	UPROPERTY(VisibleAnywhere, Category = "Respawn Points")
+	int32 NumRespawnPoints;
+
+	// Respawn positions the table was baked from, used to detect stale data
+	UPROPERTY(VisibleAnywhere, Category = "Respawn Points")
+	TArray<FVector> RespawnPositions;
+
+	// One bit per (point, area): set if the area has line of sight to the point. Rows are padded to whole words.
+	UPROPERTY()
+	TArray<uint32> VisibilityBits;
+
+	// Path distance per (point, area) in PathDistanceScale units
+	UPROPERTY()
+	TArray<uint16> PathDistances;
+
+public:
+
+	// Sets up empty tables for the given grid
+	void Initialize(const FVector& InOrigin, float InCellSize, int32 InCellsX, int32 InCellsY, const TArray<FVector>& InRespawnPositions);
+
+	// Area index containing a world location, or INDEX_NONE if it is outside the grid
+	int32 GetCellIndex(const FVector& Location) const;
+
+	// Center of an area at the grid's origin height
+	FVector GetCellCenter(int32 CellIndex) const;
+
+	FORCEINLINE int32 GetNumCells() const { return CellsX * CellsY; }
+
+	// True if someone standing in the area can see the respawn point
+	bool IsPointVisibleFromCell(int32 PointIndex, int32 CellIndex) const;
+	void SetPointVisibleFromCell(int32 PointIndex, int32 CellIndex);
+
+	// Navmesh path distance in cm, or -1 if unreachable
+	float GetPathDistance(int32 PointIndex, int32 CellIndex) const;
+	void SetPathDistance(int32 PointIndex, int32 CellIndex, float Distance);
+
+	// True if the table was baked from these respawn positions
+	bool MatchesRespawnPositions(const TArray<FVector>& Positions) const;
+
+private:
+
+	FORCEINLINE int32 GetWordsPerPoint() const { return (GetNumCells() + 31) / 32; }
+
+};
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RespawnPoint.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "Components/ArrowComponent.h"
+
+// Sets default values
+ARespawnPoint::ARespawnPoint()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+#if WITH_EDITORONLY_DATA
+	ArrowComponent = CreateEditorOnlyDefaultSubobject<UArrowComponent>(TEXT("Arrow"));
+
+	if (ArrowComponent != nullptr)
+		ArrowComponent->SetupAttachment(RootComponent);
+#endif
+
+	// Lives exactly as long as its level
+	bCanBeInCluster = true;
+
+	// Default Values for Variables
+	RespawnIndex = 0;
+}
+
+// Only the server's game mode hands out respawn points
+void ARespawnPoint::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetWorld()->GetAuthGameMode()))
+		GameMode->RegisterRespawnPoint(this);
+}
+
+void ARespawnPoint::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetWorld()->GetAuthGameMode()))
+		GameMode->UnregisterRespawnPoint(this);
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "RespawnPoint.generated.h"
+
+// A place players respawn. Placed in an arena sub-level, it registers with the game mode when its level is streamed
+// in and shown, and unregisters when the level is streamed out, so respawning only ever uses the arena being played.
+UCLASS()
+class LOCALMULTIPLAYERDEMO_API ARespawnPoint : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	// Sets default values for this actor's properties
+	ARespawnPoint();
+
+protected:
+
+	// Called when the level is shown or the point is spawned
+	virtual void BeginPlay() override;
+
+	// Called when the level is hidden or the point is destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	// Position in the respawn order. Respawn bakes are indexed by it, so keep it the same as the bake's.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Respawn", meta = (ClampMin = "0"))
+	int32 RespawnIndex;
+
+#if WITH_EDITORONLY_DATA
+	// Shows which way a respawned player faces
+	UPROPERTY()
+	class UArrowComponent* ArrowComponent;
+#endif
+
+};
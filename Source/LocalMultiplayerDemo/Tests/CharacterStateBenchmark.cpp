@@ -0,0 +1,288 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "CharacterStateManager.h"
+#include "P2_Character.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+#include "RenderCore.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Benchmark of the character state manager's one pass against every character ticking itself, at 4, 64 and 512
+// characters on the game's map. Run it headless like the game flow tests:
+// UE4Editor <path>/LocalMultiplayerDemo.uproject -game -nullrhi -nosound -unattended -ExecCmds="Automation RunTests LocalMultiplayerDemo.Perf.CharacterState" -TestExit="Automation Test Queue Empty"
+// The benchmark characters stand still with movement and animation off, so the two runs at each count only differ
+// by the state update and the character ticks it replaces. The frame budget governor is held at full quality.
+
+static const TCHAR* CharacterStateTestMap = TEXT("/Game/StarterContent/Maps/Minimal_Default");
+
+// Characters spawned for each run, on top of the players
+static const int32 BenchmarkCounts[] = { 4, 64, 512 };
+
+// Frames to let a switch between the two paths take effect, then frames averaged
+static const int32 SettleFrames = 10;
+static const int32 MeasureFrames = 240;
+
+// Give up waiting for the two player setup after this long
+static const double SetupTimeoutSeconds = 30.0;
+
+// Grid the benchmark characters stand on, in cm, wide enough that capsules don't touch
+static const float BenchmarkSpacing = 120.f;
+
+namespace CharacterStateTests
+{
+	static ALocalMultiplayerDemoGameModeBase* GetGameMode()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World() != nullptr)
+				return Cast<ALocalMultiplayerDemoGameModeBase>(Context.World()->GetAuthGameMode());
+		}
+
+		return NULL;
+	}
+
+	// Game thread time of the last frame, as "stat unit" shows it
+	static float GetGameThreadMs()
+	{
+		return GGameThreadTime > 0 ? FPlatformTime::ToMilliseconds(GGameThreadTime) : (float)(FApp::GetDeltaTime() * 1000.0);
+	}
+
+	// Set a console variable from code, returning what it was
+	static FString SetConsoleVariable(const TCHAR* Name, const TCHAR* Value)
+	{
+		IConsoleVariable* Variable = IConsoleManager::Get().FindConsoleVariable(Name);
+
+		if (Variable == nullptr)
+			return FString();
+
+		const FString Previous = Variable->GetString();
+		Variable->Set(Value, ECVF_SetByCode);
+		return Previous;
+	}
+}
+
+#pragma region Latent Commands
+// Spawns each count of characters in turn and averages the game thread over MeasureFrames with each character
+// ticking itself, then with the state manager's pass, and reports both
+class FCharacterStateBenchmarkCommand : public IAutomationLatentCommand
+{
+public:
+
+	FCharacterStateBenchmarkCommand(FAutomationTestBase* InTest)
+		: Test(InTest), StartTime(FPlatformTime::Seconds()), Phase(EPhase::WaitForSetup), CountIndex(0), bBatched(false), FramesLeft(0), TotalMs(0.0), PerCharacterMs(0.f) {}
+
+	virtual bool Update() override
+	{
+		class ALocalMultiplayerDemoGameModeBase* GameMode = CharacterStateTests::GetGameMode();
+
+		if (Phase != EPhase::WaitForSetup && GameMode == nullptr)
+		{
+			Test->AddError(TEXT("The game mode went away during the benchmark"));
+			return true;
+		}
+
+		switch (Phase)
+		{
+			case EPhase::WaitForSetup:
+			{
+				if (GameMode == nullptr || !GameMode->IsSetupComplete())
+				{
+					if (FPlatformTime::Seconds() - StartTime < SetupTimeoutSeconds)
+						return false;
+
+					Test->AddError(FString::Printf(TEXT("Two player setup didn't finish within %.0f seconds"), SetupTimeoutSeconds));
+					return true;
+				}
+
+				PreviousBatched = CharacterStateTests::SetConsoleVariable(TEXT("LocalMultiplayer.BatchCharacterState"), TEXT("1"));
+				PreviousForceLevel = CharacterStateTests::SetConsoleVariable(TEXT("LocalMultiplayer.Governor.ForceLevel"), TEXT("0"));
+				Phase = EPhase::Spawn;
+				return false;
+			}
+
+			case EPhase::Spawn:
+			{
+				SpawnCharacters(GameMode, BenchmarkCounts[CountIndex]);
+				StartRun(false);
+				return false;
+			}
+
+			case EPhase::Settle:
+			{
+				if (--FramesLeft > 0)
+					return false;
+
+				CheckCharacterTicks(GameMode);
+
+				TotalMs = 0.0;
+				FramesLeft = MeasureFrames;
+				Phase = EPhase::Measure;
+				return false;
+			}
+
+			case EPhase::Measure:
+			{
+				TotalMs += CharacterStateTests::GetGameThreadMs();
+
+				if (--FramesLeft > 0)
+					return false;
+
+				const float AverageMs = (float)(TotalMs / MeasureFrames);
+
+				if (!bBatched)
+				{
+					PerCharacterMs = AverageMs;
+					StartRun(true);
+					return false;
+				}
+
+				Report(GameMode, AverageMs);
+
+				if (++CountIndex < (int32)ARRAY_COUNT(BenchmarkCounts))
+				{
+					Phase = EPhase::Spawn;
+					return false;
+				}
+
+				Finish();
+				return true;
+			}
+		}
+
+		return true;
+	}
+
+private:
+
+	enum class EPhase : uint8
+	{
+		WaitForSetup,
+		Spawn,
+		Settle,
+		Measure
+	};
+
+	// Top up the benchmark characters to Count, in rows beside player one
+	void SpawnCharacters(ALocalMultiplayerDemoGameModeBase* GameMode, int32 Count)
+	{
+		class UWorld* const world = GameMode->GetWorld();
+		class APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(world, 0);
+		const FVector Origin = (PlayerPawn ? PlayerPawn->GetActorLocation() : FVector::ZeroVector) + FVector(0.f, 300.f, 0.f);
+		const int32 RowLength = FMath::CeilToInt(FMath::Sqrt((float)BenchmarkCounts[ARRAY_COUNT(BenchmarkCounts) - 1]));
+
+		FActorSpawnParameters spawnParams;
+		spawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		while (Characters.Num() < Count)
+		{
+			const int32 Index = Characters.Num();
+			const FVector SpawnPos = Origin + FVector((Index / RowLength) * BenchmarkSpacing, (Index % RowLength) * BenchmarkSpacing, 0.f);
+			class AP2_Character* Character = world->SpawnActor<AP2_Character>(AP2_Character::StaticClass(), SpawnPos, FRotator::ZeroRotator, spawnParams);
+
+			if (Character == nullptr)
+			{
+				Test->AddError(FString::Printf(TEXT("Couldn't spawn benchmark character %d"), Index));
+				break;
+			}
+
+			// Standing still, so movement and animation cost the same in both runs
+			Character->GetCharacterMovement()->SetComponentTickEnabled(false);
+			Character->GetMesh()->SetComponentTickEnabled(false);
+
+			Characters.Add(Character);
+		}
+	}
+
+	// Switch paths and wait for the switch to reach every character
+	void StartRun(bool bInBatched)
+	{
+		bBatched = bInBatched;
+		CharacterStateTests::SetConsoleVariable(TEXT("LocalMultiplayer.BatchCharacterState"), bBatched ? TEXT("1") : TEXT("0"));
+
+		FramesLeft = SettleFrames;
+		Phase = EPhase::Settle;
+	}
+
+	// Batched, characters don't tick at all unless fixed timestep mode steps them
+	void CheckCharacterTicks(const ALocalMultiplayerDemoGameModeBase* GameMode)
+	{
+		if (GameMode->bUseFixedTimestep)
+			return;
+
+		int32 NumTicking = 0;
+
+		for (const TWeakObjectPtr<AP2_Character>& Character : Characters)
+		{
+			if (Character.IsValid() && Character->IsActorTickEnabled())
+				NumTicking++;
+		}
+
+		const int32 Expected = bBatched ? 0 : Characters.Num();
+		Test->TestEqual(*FString::Printf(TEXT("Characters ticking themselves (%s)"), bBatched ? TEXT("one pass") : TEXT("per-character")), NumTicking, Expected);
+		Test->TestTrue(TEXT("Every benchmark character has a state slot"), GameMode->CharacterState->GetNumCharacters() >= Characters.Num());
+	}
+
+	void Report(const ALocalMultiplayerDemoGameModeBase* GameMode, float BatchedMs)
+	{
+		const int32 Count = BenchmarkCounts[CountIndex];
+
+		Test->AddInfo(FString::Printf(TEXT("%d characters: per-character ticks %.3f ms, one pass %.3f ms, game thread per frame"), Count, PerCharacterMs, BatchedMs));
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("Perf.CharacterState: %d characters (%d state slots), per-character ticks %.3f ms, one pass %.3f ms, %.3f ms saved"),
+			Count, GameMode->CharacterState->GetNumCharacters(), PerCharacterMs, BatchedMs, PerCharacterMs - BatchedMs);
+	}
+
+	// Leave the map and settings as the benchmark found them
+	void Finish()
+	{
+		for (const TWeakObjectPtr<AP2_Character>& Character : Characters)
+		{
+			if (Character.IsValid())
+				Character->Destroy();
+		}
+
+		Characters.Reset();
+
+		CharacterStateTests::SetConsoleVariable(TEXT("LocalMultiplayer.BatchCharacterState"), *PreviousBatched);
+		CharacterStateTests::SetConsoleVariable(TEXT("LocalMultiplayer.Governor.ForceLevel"), *PreviousForceLevel);
+	}
+
+	FAutomationTestBase* Test;
+	double StartTime;
+	EPhase Phase;
+
+	// Benchmark Variables
+	TArray<TWeakObjectPtr<AP2_Character>> Characters;
+	int32 CountIndex;
+	bool bBatched;
+	int32 FramesLeft;
+	double TotalMs;
+	float PerCharacterMs;
+
+	// Console variables to put back
+	FString PreviousBatched;
+	FString PreviousForceLevel;
+
+};
+#pragma endregion
+
+#pragma region Tests
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCharacterStateBenchmarkTest, "LocalMultiplayerDemo.Perf.CharacterState", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FCharacterStateBenchmarkTest::RunTest(const FString& Parameters)
+{
+	AutomationOpenMap(CharacterStateTestMap);
+	ADD_LATENT_AUTOMATION_COMMAND(FCharacterStateBenchmarkCommand(this));
+
+	return true;
+}
+#pragma endregion
+
+#endif
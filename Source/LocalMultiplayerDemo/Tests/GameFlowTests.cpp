@@ -0,0 +1,514 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "LocalMultiplayerDemoHUD.h"
+#include "LocalMultiplayerDemoPlayerState.h"
+#include "PlayerRegistry.h"
+#include "RespawnPoint.h"
+#include "P1_Character.h"
+#include "P2_Character.h"
+#include "Blueprint/UserWidget.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+#include "UObject/UObjectIterator.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Game flow tests. They open the game's map and drive the real game mode setup and P2 respawn, so run them headless:
+// UE4Editor <path>/LocalMultiplayerDemo.uproject -game -nullrhi -nosound -unattended -ExecCmds="Automation RunTests LocalMultiplayerDemo.GameFlow" -TestExit="Automation Test Queue Empty"
+// Timing thresholds are console variables, so a slow build machine can raise them with -ExecCmds or DefaultEngine.ini.
+
+static float GTestMaxJoinMs = 2000.f;
+static FAutoConsoleVariableRef CVarTestMaxJoinMs(
+	TEXT("LocalMultiplayer.Test.MaxJoinMs"),
+	GTestMaxJoinMs,
+	TEXT("Most milliseconds from the game mode's BeginPlay to both players possessed with the UI up before the join test fails"));
+
+static int32 GTestMaxJoinFrames = 60;
+static FAutoConsoleVariableRef CVarTestMaxJoinFrames(
+	TEXT("LocalMultiplayer.Test.MaxJoinFrames"),
+	GTestMaxJoinFrames,
+	TEXT("Most frames from the game mode's BeginPlay to both players possessed with the UI up before the join test fails"));
+
+static float GTestRespawnSlackMs = 250.f;
+static FAutoConsoleVariableRef CVarTestRespawnSlackMs(
+	TEXT("LocalMultiplayer.Test.RespawnSlackMs"),
+	GTestRespawnSlackMs,
+	TEXT("Milliseconds past RespawnDelay a respawn may take before the respawn test fails"));
+
+// Give up on a step after this long, so a broken setup fails instead of hanging the run
+static const double StepTimeoutSeconds = 30.0;
+
+// The game map, which is the two player level
+static const TCHAR* GameFlowTestMap = TEXT("/Game/StarterContent/Maps/Minimal_Default");
+
+namespace GameFlowTests
+{
+	// The game world the map was opened into
+	static UWorld* GetGameWorld()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World() != nullptr)
+				return Context.World();
+		}
+
+		return NULL;
+	}
+
+	static ALocalMultiplayerDemoGameModeBase* GetGameMode()
+	{
+		class UWorld* const world = GetGameWorld();
+
+		return world ? Cast<ALocalMultiplayerDemoGameModeBase>(world->GetAuthGameMode()) : NULL;
+	}
+
+	// Player two, once the game mode has set it up
+	static AP2_Character* GetPlayerTwo(const ALocalMultiplayerDemoGameModeBase* GameMode)
+	{
+		for (int32 Slot = 0; Slot < UPlayerRegistry::MaxSlots; ++Slot)
+		{
+			if (class AP2_Character* PlayerTwo = Cast<AP2_Character>(GameMode->PlayerRegistry->GetPawn(Slot)))
+				return PlayerTwo;
+		}
+
+		return NULL;
+	}
+}
+
+// Shared between a test's latent commands
+struct FGameFlowTestState
+{
+	// Join Variables
+	double SetupCompleteTime;
+	uint64 SetupCompleteFrame;
+
+	// Respawn Variables
+	TWeakObjectPtr<AP2_Character> PlayerTwo;
+	double DeathTime;
+	uint64 DeathFrame;
+	double RespawnTime;
+	uint64 RespawnFrame;
+	int32 RespawnIndex;
+	float RespawnPointDistance;
+	int32 NumRespawnPoints;
+	FDelegateHandle RespawnHandle;
+
+	// Round Reset Variables, what there was before the reset to compare with after
+	TArray<TWeakObjectPtr<APlayerController>> Controllers;
+	TArray<TWeakObjectPtr<APawn>> Pawns;
+	TWeakObjectPtr<UUserWidget> PlayerUI;
+
+	FGameFlowTestState()
+	{
+		SetupCompleteTime = 0.0;
+		SetupCompleteFrame = 0;
+		DeathTime = 0.0;
+		DeathFrame = 0;
+		RespawnTime = 0.0;
+		RespawnFrame = 0;
+		RespawnIndex = INDEX_NONE;
+		RespawnPointDistance = -1.f;
+		NumRespawnPoints = 0;
+	}
+
+};
+
+#pragma region Latent Commands
+// Wait for the game mode to finish setting up both players and the UI, then check what it set up
+class FWaitForTwoPlayerSetupCommand : public IAutomationLatentCommand
+{
+public:
+
+	FWaitForTwoPlayerSetupCommand(FAutomationTestBase* InTest, TSharedRef<FGameFlowTestState> InState)
+		: Test(InTest), State(InState), StartTime(FPlatformTime::Seconds()) {}
+
+	virtual bool Update() override
+	{
+		class ALocalMultiplayerDemoGameModeBase* GameMode = GameFlowTests::GetGameMode();
+
+		if (GameMode == nullptr || !GameMode->IsSetupComplete())
+		{
+			if (FPlatformTime::Seconds() - StartTime < StepTimeoutSeconds)
+				return false;
+
+			Test->AddError(FString::Printf(TEXT("Two player setup didn't finish within %.0f seconds"), StepTimeoutSeconds));
+			return true;
+		}
+
+		State->SetupCompleteTime = FPlatformTime::Seconds();
+		State->SetupCompleteFrame = GFrameCounter;
+
+		// Every local player possesses its own character, player one first
+		class UPlayerRegistry* Registry = GameMode->PlayerRegistry;
+		Test->TestEqual(TEXT("Local players"), Registry->GetNumPlayers(), 2);
+
+		const int32 PrimarySlot = Registry->GetPrimarySlot();
+		int32 NumP1 = 0;
+		int32 NumP2 = 0;
+
+		for (int32 Slot = 0; Slot < UPlayerRegistry::MaxSlots; ++Slot)
+		{
+			class APlayerController* Controller = Registry->GetController(Slot);
+
+			if (Controller == nullptr)
+				continue;
+
+			class APawn* Pawn = Controller->GetPawn();
+			Test->TestNotNull(*FString::Printf(TEXT("Slot %d possessed pawn"), Slot), Pawn);
+			Test->TestTrue(*FString::Printf(TEXT("Slot %d registry pawn matches controller"), Slot), Pawn == Registry->GetPawn(Slot));
+			Test->TestNotNull(*FString::Printf(TEXT("Slot %d player state"), Slot), Registry->GetPlayerState(Slot));
+
+			if (Cast<AP1_Character>(Pawn))
+				NumP1++;
+			else if (Cast<AP2_Character>(Pawn))
+				NumP2++;
+		}
+
+		Test->TestEqual(TEXT("Player one characters possessed"), NumP1, 1);
+		Test->TestEqual(TEXT("Player two characters possessed"), NumP2, 1);
+		Test->TestTrue(TEXT("Player one is the primary slot"), Cast<AP1_Character>(Registry->GetPawn(PrimarySlot)) != nullptr);
+
+		// One player UI widget, owned by the primary player's HUD
+		if (!ALocalMultiplayerDemoHUD::UseNativeHUD())
+		{
+			class ALocalMultiplayerDemoHUD* PrimaryHud = Cast<ALocalMultiplayerDemoHUD>(Registry->GetHUD(PrimarySlot));
+			Test->TestNotNull(TEXT("Primary HUD"), PrimaryHud);
+
+			int32 NumWidgets = 0;
+			class UWorld* const world = GameMode->GetWorld();
+
+			for (TObjectIterator<UUserWidget> It; It; ++It)
+			{
+				if (It->GetWorld() == world && PrimaryHud && PrimaryHud->PlayerWidgetClass && It->IsA(PrimaryHud->PlayerWidgetClass) && !It->IsPendingKill())
+					NumWidgets++;
+			}
+
+			Test->TestEqual(TEXT("Player UI widgets"), NumWidgets, 1);
+			Test->TestTrue(TEXT("Player UI is in the viewport"), PrimaryHud && PrimaryHud->PlayerUI && PrimaryHud->PlayerUI->IsInViewport());
+		}
+
+		return true;
+	}
+
+private:
+
+	FAutomationTestBase* Test;
+	TSharedRef<FGameFlowTestState> State;
+	double StartTime;
+
+};
+
+// Report and check how long the setup took
+class FCheckJoinTimingCommand : public IAutomationLatentCommand
+{
+public:
+
+	FCheckJoinTimingCommand(FAutomationTestBase* InTest, TSharedRef<FGameFlowTestState> InState) : Test(InTest), State(InState) {}
+
+	virtual bool Update() override
+	{
+		const class ALocalMultiplayerDemoGameModeBase* GameMode = GameFlowTests::GetGameMode();
+
+		if (GameMode == nullptr || State->SetupCompleteFrame == 0)
+			return true;
+
+		const double JoinMs = (State->SetupCompleteTime - GameMode->GetBeginPlayTime()) * 1000.0;
+		const int32 JoinFrames = (int32)(State->SetupCompleteFrame - GameMode->GetBeginPlayFrame());
+
+		Test->AddInfo(FString::Printf(TEXT("BeginPlay to two players possessed: %d frames, %.1f ms"), JoinFrames, JoinMs));
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("GameFlow.Join: BeginPlay to two players possessed in %d frames, %.1f ms"), JoinFrames, JoinMs);
+
+		if (JoinMs > GTestMaxJoinMs)
+			Test->AddError(FString::Printf(TEXT("Join took %.1f ms, over LocalMultiplayer.Test.MaxJoinMs=%.0f"), JoinMs, GTestMaxJoinMs));
+
+		if (JoinFrames > GTestMaxJoinFrames)
+			Test->AddError(FString::Printf(TEXT("Join took %d frames, over LocalMultiplayer.Test.MaxJoinFrames=%d"), JoinFrames, GTestMaxJoinFrames));
+
+		return true;
+	}
+
+private:
+
+	FAutomationTestBase* Test;
+	TSharedRef<FGameFlowTestState> State;
+
+};
+
+// Kill player two the way a kill volume does, and watch for it to respawn
+class FKillPlayerTwoCommand : public IAutomationLatentCommand
+{
+public:
+
+	FKillPlayerTwoCommand(FAutomationTestBase* InTest, TSharedRef<FGameFlowTestState> InState) : Test(InTest), State(InState) {}
+
+	virtual bool Update() override
+	{
+		class ALocalMultiplayerDemoGameModeBase* GameMode = GameFlowTests::GetGameMode();
+		class AP2_Character* PlayerTwo = GameMode ? GameFlowTests::GetPlayerTwo(GameMode) : NULL;
+
+		if (PlayerTwo == nullptr)
+		{
+			Test->AddError(TEXT("No player two to kill"));
+			return true;
+		}
+
+		TSharedRef<FGameFlowTestState> CapturedState = State;
+
+		// Where it came back, checked against the respawn points at that moment
+		State->RespawnHandle = GameMode->OnPlayerRespawned.AddLambda([CapturedState, GameMode](ACharacter* Character, int32 RespawnIndex)
+		{
+			if (Character != CapturedState->PlayerTwo.Get())
+				return;
+
+			TArray<ARespawnPoint*> Points;
+			GameMode->GetRespawnPoints(Points);
+
+			CapturedState->RespawnTime = FPlatformTime::Seconds();
+			CapturedState->RespawnFrame = GFrameCounter;
+			CapturedState->RespawnIndex = RespawnIndex;
+			CapturedState->NumRespawnPoints = Points.Num();
+
+			if (Points.IsValidIndex(RespawnIndex) && Points[RespawnIndex] != nullptr)
+				CapturedState->RespawnPointDistance = FVector::Dist(Character->GetActorLocation(), Points[RespawnIndex]->GetActorLocation());
+		});
+
+		State->PlayerTwo = PlayerTwo;
+		State->DeathTime = FPlatformTime::Seconds();
+		State->DeathFrame = GFrameCounter;
+
+		PlayerTwo->Kill();
+		return true;
+	}
+
+private:
+
+	FAutomationTestBase* Test;
+	TSharedRef<FGameFlowTestState> State;
+
+};
+
+// Wait for player two to respawn, then check where and how long it took
+class FWaitForRespawnCommand : public IAutomationLatentCommand
+{
+public:
+
+	FWaitForRespawnCommand(FAutomationTestBase* InTest, TSharedRef<FGameFlowTestState> InState)
+		: Test(InTest), State(InState), StartTime(FPlatformTime::Seconds()) {}
+
+	virtual bool Update() override
+	{
+		class ALocalMultiplayerDemoGameModeBase* GameMode = GameFlowTests::GetGameMode();
+		class AP2_Character* PlayerTwo = State->PlayerTwo.Get();
+
+		if (GameMode == nullptr || PlayerTwo == nullptr)
+		{
+			Test->AddError(TEXT("Player two or the game mode went away before respawning"));
+			return true;
+		}
+
+		if (State->RespawnFrame == 0)
+		{
+			if (FPlatformTime::Seconds() - StartTime < GameMode->RespawnDelay + StepTimeoutSeconds)
+				return false;
+
+			Test->AddError(TEXT("Player two never respawned"));
+			GameMode->OnPlayerRespawned.Remove(State->RespawnHandle);
+			return true;
+		}
+
+		GameMode->OnPlayerRespawned.Remove(State->RespawnHandle);
+
+		// Alive, possessed, and standing on the respawn point it was given
+		Test->TestFalse(TEXT("Player two is alive"), PlayerTwo->isDead);
+		Test->TestNotNull(TEXT("Player two is still possessed"), PlayerTwo->GetController());
+		Test->TestTrue(TEXT("Respawn points to choose from"), State->NumRespawnPoints > 0);
+		Test->TestTrue(*FString::Printf(TEXT("Respawn index %d is one of the %d respawn points"), State->RespawnIndex, State->NumRespawnPoints), State->RespawnIndex >= 0 && State->RespawnIndex < State->NumRespawnPoints);
+		Test->TestTrue(*FString::Printf(TEXT("Player two respawned at its respawn point (%.1f cm away)"), State->RespawnPointDistance), State->RespawnPointDistance >= 0.f && State->RespawnPointDistance < 1.f);
+
+		const double RespawnMs = (State->RespawnTime - State->DeathTime) * 1000.0;
+		const int32 RespawnFrames = (int32)(State->RespawnFrame - State->DeathFrame);
+		const double MaxRespawnMs = GameMode->RespawnDelay * 1000.0 + GTestRespawnSlackMs;
+
+		Test->AddInfo(FString::Printf(TEXT("Death to respawn: %d frames, %.1f ms (RespawnDelay %.1f s)"), RespawnFrames, RespawnMs, GameMode->RespawnDelay));
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("GameFlow.Respawn: death to respawn in %d frames, %.1f ms"), RespawnFrames, RespawnMs);
+
+		if (RespawnMs > MaxRespawnMs)
+			Test->AddError(FString::Printf(TEXT("Respawn took %.1f ms, over RespawnDelay plus LocalMultiplayer.Test.RespawnSlackMs (%.0f ms)"), RespawnMs, MaxRespawnMs));
+
+		return true;
+	}
+
+private:
+
+	FAutomationTestBase* Test;
+	TSharedRef<FGameFlowTestState> State;
+	double StartTime;
+
+};
+
+// Play a little of a round (score, and player two dead and waiting to respawn), then reset it and check that
+// everything was reset in place within the frame
+class FResetRoundCommand : public IAutomationLatentCommand
+{
+public:
+
+	FResetRoundCommand(FAutomationTestBase* InTest, TSharedRef<FGameFlowTestState> InState)
+		: Test(InTest), State(InState), StartTime(FPlatformTime::Seconds()) {}
+
+	virtual bool Update() override
+	{
+		class ALocalMultiplayerDemoGameModeBase* GameMode = GameFlowTests::GetGameMode();
+		class AP2_Character* PlayerTwo = GameMode ? GameFlowTests::GetPlayerTwo(GameMode) : NULL;
+
+		if (PlayerTwo == nullptr)
+		{
+			Test->AddError(TEXT("No player two to reset"));
+			return true;
+		}
+
+		class UPlayerRegistry* Registry = GameMode->PlayerRegistry;
+
+		// First update: remember who is who, score and die
+		if (!State->PlayerTwo.IsValid())
+		{
+			State->PlayerTwo = PlayerTwo;
+
+			for (int32 Slot = 0; Slot < UPlayerRegistry::MaxSlots; ++Slot)
+			{
+				State->Controllers.Add(Registry->GetController(Slot));
+				State->Pawns.Add(Registry->GetPawn(Slot));
+
+				if (class AP1_Character* PlayerOne = Cast<AP1_Character>(Registry->GetPawn(Slot)))
+					PlayerOne->AddScore(3);
+			}
+
+			if (class ALocalMultiplayerDemoHUD* PrimaryHud = Cast<ALocalMultiplayerDemoHUD>(Registry->GetHUD(Registry->GetPrimarySlot())))
+				State->PlayerUI = PrimaryHud->PlayerUI;
+
+			PlayerTwo->AddScore(2);
+			PlayerTwo->Kill();
+		}
+
+		// Wait for player two to be disabled, which is when a reset has the most to undo
+		if (PlayerTwo->GetActorEnableCollision())
+		{
+			if (FPlatformTime::Seconds() - StartTime < StepTimeoutSeconds)
+				return false;
+
+			Test->AddError(TEXT("Player two was never disabled"));
+			return true;
+		}
+
+		GameMode->ResetRound();
+
+		Test->AddInfo(FString::Printf(TEXT("Round reset: %.2f ms (budget %.2f ms)"), GameMode->GetLastRoundResetTime(), GameMode->RoundResetBudget));
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("GameFlow.ResetRound: reset in %.2f ms"), GameMode->GetLastRoundResetTime());
+
+		if (GameMode->GetLastRoundResetTime() > GameMode->RoundResetBudget)
+			Test->AddError(FString::Printf(TEXT("Round reset took %.2f ms, over RoundResetBudget=%.2f"), GameMode->GetLastRoundResetTime(), GameMode->RoundResetBudget));
+
+		// The same controllers possessing the same pawns, and the same widget
+		TArray<ARespawnPoint*> Points;
+		GameMode->GetRespawnPoints(Points);
+
+		for (int32 Slot = 0; Slot < UPlayerRegistry::MaxSlots; ++Slot)
+		{
+			class APlayerController* Controller = Registry->GetController(Slot);
+			class APawn* Pawn = Registry->GetPawn(Slot);
+
+			Test->TestTrue(*FString::Printf(TEXT("Slot %d kept its controller"), Slot), Controller == State->Controllers[Slot].Get());
+			Test->TestTrue(*FString::Printf(TEXT("Slot %d kept its pawn"), Slot), Pawn == State->Pawns[Slot].Get());
+
+			if (Controller == nullptr || Pawn == nullptr)
+				continue;
+
+			Test->TestTrue(*FString::Printf(TEXT("Slot %d still possesses its pawn"), Slot), Controller->GetPawn() == Pawn);
+
+			float NearestPoint = MAX_flt;
+
+			for (const class ARespawnPoint* Point : Points)
+				NearestPoint = FMath::Min(NearestPoint, FVector::Dist(Pawn->GetActorLocation(), Point->GetActorLocation()));
+
+			// Teleporting may nudge a pawn out of whatever it overlaps
+			Test->TestTrue(*FString::Printf(TEXT("Slot %d is at a respawn point (%.1f cm away)"), Slot, NearestPoint), NearestPoint < 50.f);
+		}
+
+		if (State->PlayerUI.IsValid())
+			Test->TestTrue(TEXT("Player UI kept and in the viewport"), State->PlayerUI->IsInViewport());
+
+		// Alive again with no score
+		Test->TestFalse(TEXT("Player two is alive"), PlayerTwo->isDead);
+		Test->TestTrue(TEXT("Player two has its collision back"), PlayerTwo->GetActorEnableCollision());
+		Test->TestEqual(TEXT("Player two score"), PlayerTwo->TotalScore, 0);
+
+		for (int32 Slot = 0; Slot < UPlayerRegistry::MaxSlots; ++Slot)
+		{
+			if (class AP1_Character* PlayerOne = Cast<AP1_Character>(Registry->GetPawn(Slot)))
+				Test->TestEqual(TEXT("Player one score"), PlayerOne->TotalScore, 0);
+
+			if (const class ALocalMultiplayerDemoPlayerState* PlayerState = Registry->GetPlayerState(Slot))
+			{
+				Test->TestEqual(*FString::Printf(TEXT("Slot %d player state P1 score"), Slot), PlayerState->TotalScore_P1, 0);
+				Test->TestEqual(*FString::Printf(TEXT("Slot %d player state P2 score"), Slot), PlayerState->TotalScore_P2, 0);
+			}
+		}
+
+		return true;
+	}
+
+private:
+
+	FAutomationTestBase* Test;
+	TSharedRef<FGameFlowTestState> State;
+	double StartTime;
+
+};
+#pragma endregion
+
+#pragma region Tests
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameFlowJoinTest, "LocalMultiplayerDemo.GameFlow.Join", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGameFlowJoinTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FGameFlowTestState> State = MakeShareable(new FGameFlowTestState());
+
+	AutomationOpenMap(GameFlowTestMap);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForTwoPlayerSetupCommand(this, State));
+	ADD_LATENT_AUTOMATION_COMMAND(FCheckJoinTimingCommand(this, State));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameFlowRespawnTest, "LocalMultiplayerDemo.GameFlow.Respawn", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGameFlowRespawnTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FGameFlowTestState> State = MakeShareable(new FGameFlowTestState());
+
+	AutomationOpenMap(GameFlowTestMap);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForTwoPlayerSetupCommand(this, State));
+	ADD_LATENT_AUTOMATION_COMMAND(FKillPlayerTwoCommand(this, State));
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForRespawnCommand(this, State));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGameFlowResetRoundTest, "LocalMultiplayerDemo.GameFlow.ResetRound", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGameFlowResetRoundTest::RunTest(const FString& Parameters)
+{
+	TSharedRef<FGameFlowTestState> State = MakeShareable(new FGameFlowTestState());
+
+	AutomationOpenMap(GameFlowTestMap);
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForTwoPlayerSetupCommand(this, State));
+	ADD_LATENT_AUTOMATION_COMMAND(FResetRoundCommand(this, State));
+
+	return true;
+}
+#pragma endregion
+
+#endif
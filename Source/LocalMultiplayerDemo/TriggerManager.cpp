@@ -0,0 +1,314 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TriggerManager.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoMovementComponent.h"
+#include "HitchDetector.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/ConstructorHelpers.h"
+
+DECLARE_CYCLE_STAT(TEXT("Trigger Update"), STAT_TriggerUpdate, STATGROUP_LocalMultiplayerDemo);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Trigger Cells Tested"), STAT_TriggerCellsTested, STATGROUP_LocalMultiplayerDemo);
+
+// Sets default values
+ATriggerManager::ATriggerManager()
+{
+	// Test after characters have moved this frame. Only reads capsules and sets scores and isDead, so it can run
+	// while physics simulates, see BeginPlay.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	PickupMeshes = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("PickupMeshes"));
+	PickupMeshes->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	PickupMeshes->bGenerateOverlapEvents = false;
+	PickupMeshes->CastShadow = false;
+	RootComponent = PickupMeshes;
+
+	// The dedicated server never draws pickups
+#if !UE_SERVER
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> PickupMesh(TEXT("/Engine/BasicShapes/Sphere"));
+	PickupMeshes->SetStaticMesh(PickupMesh.Object);
+#endif
+
+	// Clients only need to hear about pickups changing
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	NetUpdateFrequency = 10.f;
+
+	// Lives as long as the level, so a placed manager can join the level's GC cluster
+	bCanBeInCluster = true;
+
+	// Default Values for Variables
+	PickupGridSize = FIntPoint::ZeroValue;
+	PickupGridSpacing = 300.f;
+	PickupScore = 1;
+	PickupRadius = 40.f;
+	PickupRespawnDelay = 10.f;
+	CellSize = 200.f;
+	bPickupsChanged = false;
+}
+
+#pragma region Setup Logic
+// Called when the game starts or when spawned
+void ATriggerManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Only the server decides who collected what, clients just show it
+	SetActorTickEnabled(HasAuthority());
+	SetTickGroup(FLocalMultiplayerDemoModule::GetGameplayTickGroup(TG_PostPhysics));
+
+	if (!HasAuthority())
+	{
+		UpdatePickupMeshes();
+		return;
+	}
+
+	const FVector Origin = GetActorLocation();
+
+	for (const FVector& PickupLocation : PickupLocations)
+		AddPickup(GetActorTransform().TransformPosition(PickupLocation));
+
+	// Grid centred on the manager
+	const FVector GridCorner = Origin - FVector((float)(PickupGridSize.X - 1), (float)(PickupGridSize.Y - 1), 0.f) * PickupGridSpacing * 0.5f;
+
+	for (int32 X = 0; X < PickupGridSize.X; ++X)
+	{
+		for (int32 Y = 0; Y < PickupGridSize.Y; ++Y)
+			AddPickup(GridCorner + FVector((float)X, (float)Y, 0.f) * PickupGridSpacing);
+	}
+
+	for (int32 KillVolume = 0; KillVolume < KillVolumes.Num(); ++KillVolume)
+		AddKillVolumeToHash(KillVolume);
+}
+
+void ATriggerManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ATriggerManager, Pickups);
+	DOREPLIFETIME(ATriggerManager, PickupAvailable);
+}
+
+int32 ATriggerManager::AddPickup(const FVector& Location)
+{
+	const int32 Pickup = Pickups.Add(Location);
+	PickupAvailable.Add(1);
+	PickupRespawnTimes.Add(0.f);
+
+	AddPickupToHash(Pickup);
+	bPickupsChanged = true;
+
+	return Pickup;
+}
+
+int32 ATriggerManager::AddKillVolume(const FBox& Bounds)
+{
+	const int32 KillVolume = KillVolumes.Add(Bounds);
+	AddKillVolumeToHash(KillVolume);
+
+	return KillVolume;
+}
+#pragma endregion
+
+#pragma region Spatial Hash
+FIntPoint ATriggerManager::GetCellCoord(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+// A pickup goes in the cell holding its centre. Lookups widen their search by the pickup radius to match.
+void ATriggerManager::AddPickupToHash(int32 Pickup)
+{
+	Cells.FindOrAdd(GetCellCoord(Pickups[Pickup])).Pickups.Add(Pickup);
+}
+
+// A kill volume goes in every cell it covers
+void ATriggerManager::AddKillVolumeToHash(int32 KillVolume)
+{
+	const FBox& Bounds = KillVolumes[KillVolume];
+	const FIntPoint Min = GetCellCoord(Bounds.Min);
+	const FIntPoint Max = GetCellCoord(Bounds.Max);
+
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+			Cells.FindOrAdd(FIntPoint(X, Y)).KillVolumes.Add(KillVolume);
+	}
+}
+#pragma endregion
+
+#pragma region Trigger Logic
+// Called every frame
+void ATriggerManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_HITCH_CYCLE_COUNTER(STAT_TriggerUpdate, EHitchSection::TriggerUpdate);
+
+	class UWorld* const world = GetWorld();
+	const float Now = world->GetTimeSeconds();
+
+	RespawnPickups(Now);
+
+	for (FConstPawnIterator Iterator = world->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		class ACharacter* Character = Cast<ACharacter>(Iterator->Get());
+
+		// Dead characters have their collision turned off
+		if (Character != nullptr && Character->GetActorEnableCollision())
+			TestCharacter(Character, Now);
+	}
+
+	// Send and draw pickup changes straight away rather than at the next net update
+	if (bPickupsChanged)
+	{
+		bPickupsChanged = false;
+		UpdatePickupMeshes();
+		ForceNetUpdate();
+	}
+}
+
+void ATriggerManager::TestCharacter(ACharacter* Character, float Now)
+{
+	const FVector Location = Character->GetActorLocation();
+	const float Radius = Character->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	const float HalfHeight = Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
+
+	// Every cell a pickup touching the capsule could be stored in
+	const FVector Reach(Radius + PickupRadius, Radius + PickupRadius, 0.f);
+	const FIntPoint Min = GetCellCoord(Location - Reach);
+	const FIntPoint Max = GetCellCoord(Location + Reach);
+	const float PickupDistanceSq = FMath::Square(Radius + PickupRadius);
+	const FVector KillExtent(Radius, Radius, HalfHeight);
+	bool bKilled = false;
+	bool bInteracted = false;
+
+	for (int32 X = Min.X; X <= Max.X; ++X)
+	{
+		for (int32 Y = Min.Y; Y <= Max.Y; ++Y)
+		{
+			const FTriggerCell* Cell = Cells.Find(FIntPoint(X, Y));
+			INC_DWORD_STAT(STAT_TriggerCellsTested);
+
+			if (Cell == nullptr)
+				continue;
+
+			for (int32 Pickup : Cell->Pickups)
+			{
+				const FVector Offset = Pickups[Pickup] - Location;
+
+				if (PickupAvailable[Pickup] && Offset.SizeSquared2D() <= PickupDistanceSq && FMath::Abs(Offset.Z) <= HalfHeight + PickupRadius)
+				{
+					CollectPickup(Pickup, Character, Now);
+					bInteracted = true;
+				}
+			}
+
+			for (int32 KillVolume : Cell->KillVolumes)
+			{
+				if (!bKilled && KillVolumes[KillVolume].ExpandBy(KillExtent).IsInside(Location))
+					bKilled = true;
+			}
+		}
+	}
+
+	if (bKilled)
+	{
+		OnCharacterKilled.Broadcast(Character);
+		bInteracted = true;
+	}
+
+	// Without overlap events, this is how a bot in lightweight movement finds out something happened to it
+	if (bInteracted)
+	{
+		if (class ULocalMultiplayerDemoMovementComponent* MoveComp = Cast<ULocalMultiplayerDemoMovementComponent>(Character->GetCharacterMovement()))
+			MoveComp->NotifyInteraction();
+	}
+}
+
+void ATriggerManager::CollectPickup(int32 Pickup, ACharacter* Collector, float Now)
+{
+	PickupAvailable[Pickup] = 0;
+	PickupRespawnTimes[Pickup] = Now + PickupRespawnDelay;
+	RespawningPickups.Add(Pickup);
+	bPickupsChanged = true;
+
+	OnPickupCollected.Broadcast(Collector, PickupScore);
+}
+
+void ATriggerManager::RespawnPickups(float Now)
+{
+	for (int32 Index = RespawningPickups.Num() - 1; Index >= 0; --Index)
+	{
+		const int32 Pickup = RespawningPickups[Index];
+
+		if (Now >= PickupRespawnTimes[Pickup])
+		{
+			PickupAvailable[Pickup] = 1;
+			RespawningPickups.RemoveAtSwap(Index);
+			bPickupsChanged = true;
+		}
+	}
+}
+
+void ATriggerManager::ResetPickups()
+{
+	for (const int32 Pickup : RespawningPickups)
+		PickupAvailable[Pickup] = 1;
+
+	if (RespawningPickups.Num() > 0)
+	{
+		RespawningPickups.Reset();
+		bPickupsChanged = true;
+	}
+}
+#pragma endregion
+
+#pragma region Visuals
+void ATriggerManager::OnRep_Pickups()
+{
+	UpdatePickupMeshes();
+}
+
+// Collected pickups are scaled to nothing rather than removed, so instance indices never change.
+// Only instances whose availability changed are touched, with one render state update for the lot.
+void ATriggerManager::UpdatePickupMeshes()
+{
+	if (PickupMeshes == nullptr || IsRunningDedicatedServer())
+		return;
+
+	const FVector PickupScale(PickupRadius / 50.f);
+	bool bChanged = false;
+
+	// Arrays replicate separately, so wait for both before drawing
+	if (PickupAvailable.Num() != Pickups.Num())
+		return;
+
+	while (PickupMeshes->GetInstanceCount() < Pickups.Num())
+	{
+		const int32 Pickup = PickupMeshes->GetInstanceCount();
+		PickupMeshes->AddInstanceWorldSpace(FTransform(FRotator::ZeroRotator, Pickups[Pickup], PickupScale));
+		ShownPickupAvailable.Add(1);
+	}
+
+	for (int32 Pickup = 0; Pickup < Pickups.Num(); ++Pickup)
+	{
+		if (ShownPickupAvailable[Pickup] == PickupAvailable[Pickup])
+			continue;
+
+		ShownPickupAvailable[Pickup] = PickupAvailable[Pickup];
+
+		const FVector Scale = PickupAvailable[Pickup] ? PickupScale : FVector::ZeroVector;
+		PickupMeshes->UpdateInstanceTransform(Pickup, FTransform(FRotator::ZeroRotator, Pickups[Pickup], Scale), true, false);
+		bChanged = true;
+	}
+
+	if (bChanged)
+		PickupMeshes->MarkRenderStateDirty();
+}
+#pragma endregion
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TriggerManager.generated.h"
+
+// Character that picked the pickup up, and the score it was worth
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnPickupCollected, class ACharacter*, int32);
+
+// Character that entered a kill volume
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCharacterKilled, class ACharacter*);
+
+// Every score pickup and kill volume in the arena. Once a frame, after movement, each character is tested against
+// only the triggers in the uniform spatial hash cells it touches, so the cost follows the number of characters
+// rather than the number of triggers, and no trigger needs physics overlap events.
+// Pickups are a fixed pool drawn with one instanced mesh. A collected pickup is hidden and comes back in place.
+UCLASS(config = Game)
+class LOCALMULTIPLAYERDEMO_API ATriggerManager : public AActor
+{
+	GENERATED_BODY()
+
+private:
+
+	// One cell of the spatial hash
+	struct FTriggerCell
+	{
+		TArray<int32, TInlineAllocator<4>> Pickups;
+		TArray<int32, TInlineAllocator<1>> KillVolumes;
+	};
+
+	TMap<FIntPoint, FTriggerCell> Cells;
+
+	// World time each pickup comes back, only used on the server
+	TArray<float> PickupRespawnTimes;
+
+	// Pickups waiting to come back, so respawning doesn't scan the whole pool
+	TArray<int32> RespawningPickups;
+
+	// Availability the instanced mesh is currently showing
+	TArray<uint8> ShownPickupAvailable;
+
+	// A pickup was added, collected or came back since the last update
+	bool bPickupsChanged;
+
+	// Spatial Hash Methods
+	FIntPoint GetCellCoord(const FVector& Location) const;
+	void AddPickupToHash(int32 Pickup);
+	void AddKillVolumeToHash(int32 KillVolume);
+
+	// Trigger Methods
+	void TestCharacter(class ACharacter* Character, float Now);
+	void CollectPickup(int32 Pickup, class ACharacter* Collector, float Now);
+	void RespawnPickups(float Now);
+
+	// Bring the instanced mesh in line with Pickups and PickupAvailable
+	void UpdatePickupMeshes();
+
+public:
+
+	// Sets default values for this actor's properties
+	ATriggerManager();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called every frame
+	virtual void Tick(float DeltaTime) override;
+
+	// Properties replicated to clients
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Add a pickup or kill volume at runtime, on the server. Returns its index.
+	int32 AddPickup(const FVector& Location);
+	int32 AddKillVolume(const FBox& Bounds);
+
+	// Bring every collected pickup back now, for a new round. Drawn and sent on the next tick.
+	void ResetPickups();
+
+	// Fired on the server when a character collects a pickup or enters a kill volume
+	FOnPickupCollected OnPickupCollected;
+	FOnCharacterKilled OnCharacterKilled;
+
+	// Pickup positions relative to the manager
+	UPROPERTY(EditAnywhere, Category = "Pickups", meta = (MakeEditWidget = true))
+	TArray<FVector> PickupLocations;
+
+	// Also lay out a grid of pickups this many wide and deep, centred on the manager
+	UPROPERTY(Config, EditAnywhere, Category = "Pickups")
+	FIntPoint PickupGridSize;
+
+	// Distance between grid pickups, in cm
+	UPROPERTY(Config, EditAnywhere, Category = "Pickups", meta = (ClampMin = "1"))
+	float PickupGridSpacing;
+
+	// Score each pickup is worth
+	UPROPERTY(Config, EditAnywhere, Category = "Pickups")
+	int32 PickupScore;
+
+	// Pickups are collected when a character's capsule comes this close to their centre
+	UPROPERTY(Config, EditAnywhere, Category = "Pickups", meta = (ClampMin = "1"))
+	float PickupRadius;
+
+	// Seconds before a collected pickup comes back
+	UPROPERTY(Config, EditAnywhere, Category = "Pickups", meta = (ClampMin = "0"))
+	float PickupRespawnDelay;
+
+	// World space boxes that kill any character touching them
+	UPROPERTY(EditAnywhere, Category = "Kill Volumes")
+	TArray<FBox> KillVolumes;
+
+	// Size of a spatial hash cell, in cm. About twice a character's width keeps each test to a few cells.
+	UPROPERTY(Config, EditAnywhere, Category = "Spatial Hash", meta = (ClampMin = "10"))
+	float CellSize;
+
+	// All pickups, one instance each
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Pickups")
+	class UInstancedStaticMeshComponent* PickupMeshes;
+
+protected:
+
+	// World space position of every pickup, matching the mesh instance indices
+	UPROPERTY(ReplicatedUsing = OnRep_Pickups)
+	TArray<FVector_NetQuantize> Pickups;
+
+	// 1 while a pickup can be collected, 0 while it is waiting to come back
+	UPROPERTY(ReplicatedUsing = OnRep_Pickups)
+	TArray<uint8> PickupAvailable;
+
+	UFUNCTION()
+	void OnRep_Pickups();
+
+};
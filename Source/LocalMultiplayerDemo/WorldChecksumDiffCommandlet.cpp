@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WorldChecksumDiffCommandlet.h"
+#include "LocalMultiplayerDemo.h"
+#include "WorldStateChecksum.h"
+
+UWorldChecksumDiffCommandlet::UWorldChecksumDiffCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UWorldChecksumDiffCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamVals;
+	ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+	if (Tokens.Num() != 2)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("WorldChecksumDiff: expected two checksum logs, e.g. -run=WorldChecksumDiff A.wcs B.wcs"));
+		return 1;
+	}
+
+	TArray<FWorldChecksumFrame> FramesA;
+	TArray<FWorldChecksumFrame> FramesB;
+
+	for (int32 Index = 0; Index < 2; ++Index)
+	{
+		if (!UWorldStateChecksum::LoadLog(Tokens[Index], Index == 0 ? FramesA : FramesB))
+		{
+			UE_LOG(LogLocalMultiplayerDemo, Error, TEXT("WorldChecksumDiff: '%s' isn't a world checksum log"), *Tokens[Index]);
+			return 1;
+		}
+	}
+
+	const int32 NumFrames = FMath::Min(FramesA.Num(), FramesB.Num());
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const FWorldChecksumFrame& A = FramesA[Frame];
+		const FWorldChecksumFrame& B = FramesB[Frame];
+
+		if (A == B)
+			continue;
+
+		// Several parts can differ in the same frame, name them all
+		TArray<FString> Parts;
+
+		if (A.Transforms != B.Transforms)
+			Parts.Add(TEXT("transforms"));
+
+		if (A.State != B.State)
+			Parts.Add(TEXT("state"));
+
+		if (A.Random != B.Random)
+			Parts.Add(TEXT("random"));
+
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("WorldChecksumDiff: runs diverge at frame %d of %d (%s)"), Frame, NumFrames, *FString::Join(Parts, TEXT(", ")));
+		return 1;
+	}
+
+	if (FramesA.Num() != FramesB.Num())
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("WorldChecksumDiff: runs match for all %d frames they share, but one is %d frames and the other %d"),
+			NumFrames, FramesA.Num(), FramesB.Num());
+		return 1;
+	}
+
+	UE_LOG(LogLocalMultiplayerDemo, Display, TEXT("WorldChecksumDiff: runs match for all %d frames"), NumFrames);
+	return 0;
+}
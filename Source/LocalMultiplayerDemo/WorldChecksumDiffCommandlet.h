@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WorldChecksumDiffCommandlet.generated.h"
+
+// Compares two world checksum logs (see UWorldStateChecksum) frame by frame and reports the first frame where the runs
+// diverge, and whether the transforms, the gameplay state or the random stream went first. Returns 0 when they match.
+// Usage: UE4Editor-Cmd LocalMultiplayerDemo.uproject -run=WorldChecksumDiff Path/To/A.wcs Path/To/B.wcs
+UCLASS()
+class UWorldChecksumDiffCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UWorldChecksumDiffCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+};
@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WorldStateChecksum.h"
+#include "LocalMultiplayerDemo.h"
+#include "LocalMultiplayerDemoGameModeBase.h"
+#include "P1_Character.h"
+#include "P2_Character.h"
+#include "HitchDetector.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("World Checksum"), STAT_WorldChecksum, STATGROUP_LocalMultiplayerDemo);
+
+// First four bytes of a log, "WCS1"
+static const uint32 WorldChecksumMagic = 0x31534357;
+
+UWorldStateChecksum::UWorldStateChecksum()
+{
+	bEnabled = false;
+	LocationPrecision = 0.01f;
+
+	// Default Values for Variables
+	Writer = NULL;
+	NumFrames = 0;
+}
+
+#pragma region Recording
+void UWorldStateChecksum::Start()
+{
+	if (GetWorld() == nullptr || IsRecording())
+		return;
+
+	if (!bEnabled && !FParse::Param(FCommandLine::Get(), TEXT("WorldChecksum")))
+		return;
+
+	// Down to the millisecond, the match simulator starts several matches a second
+	Filename = FPaths::ProfilingDir() / FString::Printf(TEXT("WorldChecksum-%s-%s.wcs"),
+		*UGameplayStatics::GetCurrentLevelName(this, true), *FDateTime::Now().ToString(TEXT("%Y.%m.%d-%H.%M.%S.%s")));
+
+	Writer = IFileManager::Get().CreateFileWriter(*Filename);
+
+	if (Writer == nullptr)
+	{
+		UE_LOG(LogLocalMultiplayerDemo, Warning, TEXT("World checksum: couldn't write %s"), *Filename);
+		return;
+	}
+
+	uint32 Magic = WorldChecksumMagic;
+	*Writer << Magic;
+	NumFrames = 0;
+
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("World checksum: writing %s"), *Filename);
+}
+
+void UWorldStateChecksum::Tick()
+{
+	if (!IsRecording())
+		return;
+
+	SCOPE_HITCH_CYCLE_COUNTER(STAT_WorldChecksum, EHitchSection::WorldChecksum);
+
+	FWorldChecksumFrame ChecksumFrame;
+	HashFrame(ChecksumFrame);
+	ChecksumFrame.Frame = NumFrames++;
+
+	// The file writer buffers, so this is a copy into memory most frames
+	*Writer << ChecksumFrame;
+}
+
+void UWorldStateChecksum::Stop()
+{
+	if (!IsRecording())
+		return;
+
+	Writer->Close();
+	delete Writer;
+	Writer = NULL;
+
+	UE_LOG(LogLocalMultiplayerDemo, Log, TEXT("World checksum: %u frames in %s"), NumFrames, *Filename);
+}
+
+void UWorldStateChecksum::BeginDestroy()
+{
+	Stop();
+
+	Super::BeginDestroy();
+}
+
+// Characters are hashed in the world's pawn order, which is spawn order, so runs that spawn differently diverge too
+void UWorldStateChecksum::HashFrame(FWorldChecksumFrame& OutFrame) const
+{
+	const float LocationScale = 1.f / FMath::Max(LocationPrecision, KINDA_SMALL_NUMBER);
+	uint32 Transforms = 0;
+	uint32 State = 0;
+
+	for (FConstPawnIterator Iterator = GetWorld()->GetPawnIterator(); Iterator; ++Iterator)
+	{
+		const class ACharacter* Character = Cast<ACharacter>(Iterator->Get());
+
+		if (Character == nullptr)
+			continue;
+
+		const FVector Location = Character->GetActorLocation();
+		const int32 TransformData[4] =
+		{
+			FMath::RoundToInt(Location.X * LocationScale),
+			FMath::RoundToInt(Location.Y * LocationScale),
+			FMath::RoundToInt(Location.Z * LocationScale),
+			(int32)FRotator::CompressAxisToShort(Character->GetActorRotation().Yaw)
+		};
+
+		Transforms = FCrc::MemCrc32(TransformData, sizeof(TransformData), Transforms);
+
+		// Dead, score, stance, last respawn point
+		int32 StateData[4] = { 0, 0, 0, INDEX_NONE };
+
+		if (const class AP1_Character* PlayerOne = Cast<AP1_Character>(Character))
+		{
+			StateData[1] = PlayerOne->TotalScore;
+			StateData[2] = (int32)PlayerOne->Stance;
+		}
+		else if (const class AP2_Character* PlayerTwo = Cast<AP2_Character>(Character))
+		{
+			StateData[0] = PlayerTwo->isDead ? 1 : 0;
+			StateData[1] = PlayerTwo->TotalScore;
+			StateData[2] = (int32)PlayerTwo->Stance;
+			StateData[3] = PlayerTwo->GetLastRespawnIndex();
+		}
+
+		State = FCrc::MemCrc32(StateData, sizeof(StateData), State);
+	}
+
+	const class ALocalMultiplayerDemoGameModeBase* GameMode = Cast<ALocalMultiplayerDemoGameModeBase>(GetOuter());
+	const int32 RandomState = GameMode ? GameMode->GameplayRandom.GetCurrentSeed() : 0;
+
+	OutFrame.Transforms = Transforms;
+	OutFrame.State = State;
+	OutFrame.Random = FCrc::MemCrc32(&RandomState, sizeof(RandomState));
+}
+#pragma endregion
+
+#pragma region Reading
+bool UWorldStateChecksum::LoadLog(const FString& InFilename, TArray<FWorldChecksumFrame>& OutFrames)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*InFilename));
+
+	if (!Reader.IsValid())
+		return false;
+
+	uint32 Magic = 0;
+	*Reader << Magic;
+
+	if (Magic != WorldChecksumMagic)
+		return false;
+
+	// A run that was killed part way can leave half a frame at the end, which is dropped
+	const int64 FrameBytes = sizeof(uint32) * 4;
+	const int32 NumLogFrames = (int32)((Reader->TotalSize() - Reader->Tell()) / FrameBytes);
+
+	OutFrames.SetNumUninitialized(NumLogFrames);
+
+	for (FWorldChecksumFrame& ChecksumFrame : OutFrames)
+		*Reader << ChecksumFrame;
+
+	return !Reader->IsError();
+}
+#pragma endregion
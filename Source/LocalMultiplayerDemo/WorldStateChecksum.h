@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "WorldStateChecksum.generated.h"
+
+// One frame of a checksum log, 16 bytes. Each part is hashed separately so a divergence says what went first.
+struct FWorldChecksumFrame
+{
+	// Frames since the checksum started
+	uint32 Frame;
+
+	// Every character's location and yaw
+	uint32 Transforms;
+
+	// Every character's isDead, TotalScore, stance and last respawn point
+	uint32 State;
+
+	// The game mode's GameplayRandom
+	uint32 Random;
+
+	FORCEINLINE bool operator==(const FWorldChecksumFrame& Other) const
+	{
+		return Transforms == Other.Transforms && State == Other.State && Random == Other.Random;
+	}
+
+	FORCEINLINE bool operator!=(const FWorldChecksumFrame& Other) const { return !(*this == Other); }
+
+	friend FArchive& operator<<(FArchive& Ar, FWorldChecksumFrame& ChecksumFrame)
+	{
+		return Ar << ChecksumFrame.Frame << ChecksumFrame.Transforms << ChecksumFrame.State << ChecksumFrame.Random;
+	}
+
+};
+
+// Hashes a canonical snapshot of gameplay state at the end of every frame's gameplay and appends it to a compact log
+// in the profiling dir, so two runs of the same seed can be compared with "-run=WorldChecksumDiff A.wcs B.wcs" to
+// find the first frame where they stopped matching, e.g. before and after a movement or respawn change.
+// Locations are rounded to LocationPrecision first, so builds that only differ in the last bits of a float still match.
+// Off by default: set bEnabled under [/Script/LocalMultiplayerDemo.WorldStateChecksum] or run with -WorldChecksum.
+// A few hundred nanoseconds a frame for a handful of characters, see "World Checksum" in stat LocalMultiplayerDemo.
+UCLASS(config = Game)
+class LOCALMULTIPLAYERDEMO_API UWorldStateChecksum : public UObject
+{
+	GENERATED_BODY()
+
+public:
+
+	UWorldStateChecksum();
+
+	// Record a checksum log every run
+	UPROPERTY(Config)
+	bool bEnabled;
+
+	// Locations are hashed in steps of this many cm
+	UPROPERTY(Config)
+	float LocationPrecision;
+
+public:
+
+	// Open the log if enabled, called by the game mode at BeginPlay
+	void Start();
+
+	// Hash this frame and append it, called by the game mode after the rest of the frame's gameplay
+	void Tick();
+
+	// Close the log, called by the game mode at EndPlay
+	void Stop();
+
+	// True while a log is being written
+	FORCEINLINE bool IsRecording() const { return Writer != nullptr; }
+
+	// Read a log written by Start/Tick. False if it isn't one.
+	static bool LoadLog(const FString& Filename, TArray<FWorldChecksumFrame>& OutFrames);
+
+	virtual void BeginDestroy() override;
+
+private:
+
+	// Hash the world's gameplay state as it is now
+	void HashFrame(FWorldChecksumFrame& OutFrame) const;
+
+	// Log file, owned
+	FArchive* Writer;
+	FString Filename;
+
+	uint32 NumFrames;
+
+};
@@ -1,14 +1,14 @@
-// Fill out your copyright notice in the Description page of Project Settings.
-
-using UnrealBuildTool;
-using System.Collections.Generic;
-
-public class LocalMultiplayerDemoEditorTarget : TargetRules
-{
-	public LocalMultiplayerDemoEditorTarget(TargetInfo Target) : base(Target)
-	{
-		Type = TargetType.Editor;
-
-		ExtraModuleNames.AddRange( new string[] { "LocalMultiplayerDemo" } );
-	}
-}
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class LocalMultiplayerDemoEditorTarget : TargetRules
+{
+	public LocalMultiplayerDemoEditorTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Editor;
+
+		ExtraModuleNames.AddRange( new string[] { "LocalMultiplayerDemo" } );
+	}
+}
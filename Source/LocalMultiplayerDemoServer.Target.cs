@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class LocalMultiplayerDemoServerTarget : TargetRules
+{
+	public LocalMultiplayerDemoServerTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+
+		// Character meshes, AnimBPs and the player UI are compiled out with UE_SERVER
+		ExtraModuleNames.AddRange( new string[] { "LocalMultiplayerDemo" } );
+	}
+}